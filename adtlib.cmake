@@ -1,13 +1,16 @@
 set(ADT_PRECOMPILED_HEADERS
     Arena.hh
+    ArenaConcurrent.hh
     ArenaList.hh
     ArgvParser.hh
     Array.hh
     assert.hh
     atomic.hh
     bin.hh
+    Bitset.hh
     BufferAllocator.hh
     defer.hh
+    DequeWS.hh
     Directory.hh
     enum.hh
     Exception.hh
@@ -22,31 +25,39 @@ set(ADT_PRECOMPILED_HEADERS
     List.hh
     Logger.hh
     Map.hh
+    MapConcurrent.hh
+    MapSwiss.hh
     math.hh
     # MiMalloc.hh
     Opt.hh
     Pair.hh
     Pipeline.hh
     PoolAllocator.hh
+    PoolAllocatorConcurrent.hh
     Pool.hh
+    PoolDynamic.hh
     PoolSOA.hh
     print.hh
     QueueArray.hh
     Queue.hh
+    QueueMPMC.hh
     RBTree.hh
     RefCount.hh
     ReverseIt.hh
     rng.hh
     Set.hh
+    SlabAllocator.hh
     simd.hh
     SList.hh
     SOA.hh
     sort.hh
     Span2D.hh
     Span.hh
+    StatsAllocator.hh
     String.hh
     Thread.hh
     ThreadPool.hh
+    ThreadPoolWS.hh
     time.hh
     types.hh
     utf8.hh
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "IArena.hh"
+#include "enum.hh"
 
 #if __has_include(<sys/mman.h>)
     #define ADT_ARENA_MMAP
     #include <sys/mman.h>
+
+    #if __has_include(<sys/syscall.h>)
+        #include <sys/syscall.h>
+    #endif
 #elif defined _WIN32
     #define ADT_ARENA_WIN32
 #else
@@ -16,10 +21,31 @@ namespace adt
 
 struct ArenaScope;
 
+/* Reservation modes, only mmap platforms use them, ignored on win32. */
+enum class ARENA_FLAGS : u8
+{
+    NONE = 0,
+    HUGE_PAGES = 1, /* Transparent huge pages: 2M aligned reservation, madvise(MADV_HUGEPAGE), commits in 2M steps. */
+    HUGETLB = 1 << 1, /* MAP_HUGETLB, needs preallocated huge pages for the whole reservation. Falls back to HUGE_PAGES. */
+    POPULATE = 1 << 2, /* Prefault every commit (MADV_POPULATE_WRITE or page touching), no first touch faults later. */
+    NUMA_LOCAL = 1 << 3, /* Prefer the NUMA node of the creating thread (linux mbind(MPOL_PREFERRED)). */
+    NORESERVE = 1 << 4, /* Map read/write with MAP_NORESERVE and let pages fault in lazily: no mprotect() on commit, decommit is madvise() only. */
+};
+ADT_ENUM_BITWISE_OPERATORS(ARENA_FLAGS);
+
+/* How far growIfNeeded() commits past the needed position. */
+enum class ARENA_GROWTH : u8
+{
+    DOUBLE, /* Double the commited size (default). */
+    FIXED, /* Commit in fixed steps. */
+    CAPPED_DOUBLE, /* Double, but never more than a step at once. */
+};
+
 /* Reserve/commit style linear allocator. */
 struct Arena : IArena
 {
     static constexpr u64 INVALID_PTR = ~0llu;
+    static constexpr isize HUGE_PAGE_SIZE = SIZE_1M * 2;
 
     /* */
 
@@ -28,10 +54,19 @@ struct Arena : IArena
     isize m_reserved {};
     isize m_commited {};
     void* m_pLastAlloc {};
+    ARENA_FLAGS m_eFlags {}; /* HUGETLB is replaced with HUGE_PAGES if the fallback was taken. */
+    ARENA_GROWTH m_eGrowth {};
+    isize m_growStep {}; /* FIXED step or CAPPED_DOUBLE cap, multiple of commitGranularity(). */
+
+    /* High-water trimming on reset(): pages above the highest position reached during the last m_trimNResets resets are decommited. */
+    isize m_trimNResets {}; /* 0: disabled. */
+    isize m_highWater {}; /* Highest position since the last reset(). */
+    isize m_trimWindowMax {}; /* Highest m_highWater in the current window of resets. */
+    isize m_trimNInWindow {};
 
     /* */
 
-    Arena(isize reserveSize, isize commitSize = getPageSize()) noexcept(false); /* AllocException */
+    Arena(isize reserveSize, isize commitSize = getPageSize(), ARENA_FLAGS eFlags = ARENA_FLAGS::NONE) noexcept(false); /* AllocException */
     Arena() noexcept = default;
 
     /* */
@@ -44,6 +79,10 @@ struct Arena : IArena
     [[nodiscard]] virtual constexpr bool doesFree() const noexcept override { return false; }
     [[nodiscard]] virtual constexpr bool doesRealloc() const noexcept override { return true; }
 
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override; /* AllocException */
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override; /* AllocException */
+    [[nodiscard]] virtual void* reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override; /* AllocException */
+
     virtual void freeAll() noexcept override;
     [[nodiscard]] virtual IScope restoreAfterScope() noexcept override;
     virtual usize memoryUsed() const noexcept override { return m_pos; }
@@ -58,11 +97,20 @@ struct Arena : IArena
     void resetToPage(isize nthPage);
     isize memoryReserved() const noexcept { return m_reserved; }
     isize memoryCommited() const noexcept { return m_commited; }
+    isize commitGranularity() const noexcept;
+
+    void setGrowth(ARENA_GROWTH eGrowth, isize step = 0) noexcept; /* step is required for FIXED and CAPPED_DOUBLE. */
+    void setTrim(isize nResets) noexcept;
 
 protected:
     void growIfNeeded(isize newPos);
+    void growCommited(isize newPos); /* Slow part of growIfNeeded(), kept apart so the bump path inlines. */
     void commit(void* p, isize size);
     void decommit(void* p, isize size);
+    void* reserve(isize size);
+    void bindToThisNumaNode() noexcept;
+    void resetTrimming() noexcept;
+    void trimAfterReset() noexcept;
 };
 
 /* Capture current state to restore it later with restore(). */
@@ -102,6 +150,28 @@ struct IArena::Scope<Arena> final : ArenaScope
     using ArenaScope::ArenaScope;
 };
 
+/* Final Arena: calls through ArenaNV* are resolved statically and the bump path inlines.
+ * The typed helpers come from AllocatorHelperCRTP<ArenaNV> instead of going back through IAllocator.
+ * Pass ArenaNV* (not IAllocator*) to containers to get it, it still works as a regular IArena everywhere else. */
+struct ArenaNV final : Arena, AllocatorHelperCRTP<ArenaNV>
+{
+    using Arena::Arena;
+
+    using AllocatorHelperCRTP<ArenaNV>::alloc;
+    using AllocatorHelperCRTP<ArenaNV>::mallocV;
+    using AllocatorHelperCRTP<ArenaNV>::zallocV;
+    using AllocatorHelperCRTP<ArenaNV>::reallocV;
+    using AllocatorHelperCRTP<ArenaNV>::freeV;
+    using AllocatorHelperCRTP<ArenaNV>::relocate;
+    using AllocatorHelperCRTP<ArenaNV>::dealloc;
+};
+
+template<>
+struct IArena::Scope<ArenaNV> final : ArenaScope
+{
+    using ArenaScope::ArenaScope;
+};
+
 inline
 ArenaScope::ArenaScope(const ArenaState& state) noexcept
     : m_state{state}
@@ -142,36 +212,128 @@ ArenaScope::~ArenaScope() noexcept
 }
 
 inline
-Arena::Arena(isize reserveSize, isize commitSize)
-    : IArena{INIT}
+Arena::Arena(isize reserveSize, isize commitSize, ARENA_FLAGS eFlags)
+    : IArena{INIT}, m_eFlags {eFlags}
 {
-    [[maybe_unused]] int err = 0;
+    const isize realReserved = alignUpPO2(reserveSize, commitGranularity());
 
-    const isize realReserved = alignUpPO2(reserveSize, getPageSize());
-
-#ifdef ADT_ARENA_MMAP
-    void* pRes = mmap(nullptr, realReserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (pRes == MAP_FAILED) throw AllocException{"mmap() failed"};
-#elif defined ADT_ARENA_WIN32
-    void* pRes = VirtualAlloc(nullptr, realReserved, MEM_RESERVE, PAGE_READWRITE);
-    ADT_ALLOC_EXCEPTION_FMT(pRes, "VirtualAlloc() failed to reserve: {}", realReserved);
-#else
-#endif
-
-    m_pData = pRes;
+    m_pData = reserve(realReserved);
     m_reserved = realReserved;
     m_pLastAlloc = (void*)INVALID_PTR;
 
+    if (bool(m_eFlags & ARENA_FLAGS::NUMA_LOCAL)) bindToThisNumaNode();
+
     ADT_ASAN_POISON(m_pData, realReserved);
 
     if (commitSize > 0)
     {
-        const isize realCommit = alignUpPO2(commitSize, getPageSize());
+        const isize realCommit = utils::min((isize)alignUpPO2(commitSize, commitGranularity()), m_reserved);
         commit(m_pData, realCommit);
         m_commited = realCommit;
     }
 }
 
+inline isize
+Arena::commitGranularity() const noexcept
+{
+#ifdef ADT_ARENA_MMAP
+    if (bool(m_eFlags & (ARENA_FLAGS::HUGE_PAGES | ARENA_FLAGS::HUGETLB))) return HUGE_PAGE_SIZE;
+#endif
+    return getPageSize();
+}
+
+inline void
+Arena::setGrowth(ARENA_GROWTH eGrowth, isize step) noexcept
+{
+    ADT_ASSERT(eGrowth == ARENA_GROWTH::DOUBLE || step > 0, "eGrowth: {}, step: {}", int(eGrowth), step);
+
+    m_eGrowth = eGrowth;
+    m_growStep = alignUpPO2(step, commitGranularity());
+}
+
+inline void
+Arena::setTrim(isize nResets) noexcept
+{
+    ADT_ASSERT(nResets >= 0, "nResets: {}", nResets);
+
+    m_trimNResets = nResets;
+    resetTrimming();
+}
+
+inline void*
+Arena::reserve(isize size)
+{
+#ifdef ADT_ARENA_MMAP
+
+    int prot = PROT_NONE;
+    int noReserve = 0;
+    if (bool(m_eFlags & ARENA_FLAGS::NORESERVE))
+    {
+        prot = PROT_READ | PROT_WRITE;
+        noReserve = MAP_NORESERVE;
+    }
+
+    #ifdef MAP_HUGETLB
+    if (bool(m_eFlags & ARENA_FLAGS::HUGETLB))
+    {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | noReserve;
+        #ifdef MAP_HUGE_SHIFT
+        flags |= 21 << MAP_HUGE_SHIFT; /* 2M pages, not the system default size. */
+        #endif
+        void* pRes = mmap(nullptr, size, prot, flags, -1, 0);
+        if (pRes != MAP_FAILED) return pRes;
+    }
+    #endif
+
+    if (bool(m_eFlags & ARENA_FLAGS::HUGETLB))
+        m_eFlags = (m_eFlags & ~ARENA_FLAGS::HUGETLB) | ARENA_FLAGS::HUGE_PAGES;
+
+    if (!bool(m_eFlags & ARENA_FLAGS::HUGE_PAGES))
+    {
+        void* pRes = mmap(nullptr, size, prot, MAP_PRIVATE | MAP_ANONYMOUS | noReserve, -1, 0);
+        if (pRes == MAP_FAILED) throw AllocException{"mmap() failed"};
+        return pRes;
+    }
+
+    /* Transparent huge pages only back 2M aligned ranges: overreserve and cut off the ends. */
+    u8* pRes = (u8*)mmap(nullptr, size + HUGE_PAGE_SIZE, prot, MAP_PRIVATE | MAP_ANONYMOUS | noReserve, -1, 0);
+    if (pRes == MAP_FAILED) throw AllocException{"mmap() failed"};
+
+    u8* pAligned = (u8*)alignUpPO2((usize)pRes, HUGE_PAGE_SIZE);
+    if (pAligned > pRes) munmap(pRes, pAligned - pRes);
+    if (pRes + HUGE_PAGE_SIZE > pAligned) munmap(pAligned + size, pRes + HUGE_PAGE_SIZE - pAligned);
+
+    #ifdef MADV_HUGEPAGE
+    madvise(pAligned, size, MADV_HUGEPAGE); /* Failure means no THP support, the arena still works. */
+    #endif
+
+    return pAligned;
+
+#elif defined ADT_ARENA_WIN32
+
+    void* pRes = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_READWRITE);
+    ADT_ALLOC_EXCEPTION_FMT(pRes, "VirtualAlloc() failed to reserve: {}", size);
+    return pRes;
+
+#else
+#endif
+}
+
+inline void
+Arena::bindToThisNumaNode() noexcept
+{
+#if defined ADT_ARENA_MMAP && defined SYS_getcpu && defined SYS_mbind
+    constexpr int MPOL_PREFERRED = 1; /* <linux/mempolicy.h>, without linking libnuma. */
+
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, nullptr, &node, nullptr) != 0 || node >= 64) return;
+
+    const unsigned long nodeMask = 1ul << node;
+    /* Fails on single node systems without NUMA support, default first touch policy is fine there. */
+    [[maybe_unused]] long err = syscall(SYS_mbind, m_pData, m_reserved, MPOL_PREFERRED, &nodeMask, 64, 0);
+#endif
+}
+
 inline void*
 Arena::malloc(usize nBytes)
 {
@@ -188,7 +350,7 @@ Arena::malloc(usize nBytes)
 inline void*
 Arena::zalloc(usize nBytes)
 {
-    void* pMem = malloc(nBytes);
+    void* pMem = Arena::malloc(nBytes);
     ::memset(pMem, 0, nBytes);
     return pMem;
 }
@@ -196,7 +358,7 @@ Arena::zalloc(usize nBytes)
 inline void*
 Arena::realloc(void* p, usize oldNBytes, usize newNBytes)
 {
-    if (!p) return malloc(newNBytes);
+    if (!p) return Arena::malloc(newNBytes);
 
     /* bump case */
     if (p == m_pLastAlloc)
@@ -209,7 +371,7 @@ Arena::realloc(void* p, usize oldNBytes, usize newNBytes)
 
     if (newNBytes <= oldNBytes) return p;
 
-    void* pMem = malloc(newNBytes);
+    void* pMem = Arena::malloc(newNBytes);
     if (p) ::memcpy(pMem, p, oldNBytes);
     return pMem;
 }
@@ -220,6 +382,37 @@ Arena::free(void*, usize) noexcept
     /* noop */
 }
 
+inline void*
+Arena::mallocAligned(usize nBytes, usize alignment)
+{
+    ADT_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "alignment: {}", alignment);
+
+    u8* pRet = (u8*)alignUpPO2(usize((u8*)m_pData + m_pos), utils::max(alignment, ALLOC_ALIGNMENT));
+    growIfNeeded((pRet - (u8*)m_pData) + alignUp8(nBytes));
+    m_pLastAlloc = pRet;
+
+    return pRet;
+}
+
+inline void*
+Arena::zallocAligned(usize nBytes, usize alignment)
+{
+    void* pMem = Arena::mallocAligned(nBytes, alignment);
+    ::memset(pMem, 0, nBytes);
+    return pMem;
+}
+
+inline void*
+Arena::reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    /* Last allocation grows in place and shrinking never moves, the start is aligned already in both cases. */
+    if (p && (p == m_pLastAlloc || newNBytes <= oldNBytes)) return Arena::realloc(p, oldNBytes, newNBytes);
+
+    void* pMem = Arena::mallocAligned(newNBytes, alignment);
+    if (p) ::memcpy(pMem, p, oldNBytes);
+    return pMem;
+}
+
 inline void
 Arena::freeAll() noexcept
 {
@@ -267,6 +460,8 @@ Arena::reset() noexcept
 
     m_pos = 0;
     m_pLastAlloc = (void*)INVALID_PTR;
+
+    if (m_trimNResets > 0) trimAfterReset();
 }
 
 inline void
@@ -281,12 +476,13 @@ Arena::resetDecommit()
     m_pos = 0;
     m_commited = 0;
     m_pLastAlloc = (void*)INVALID_PTR;
+    resetTrimming();
 }
 
 inline void
 Arena::resetToPage(isize nthPage)
 {
-    const isize commitSize = getPageSize() * nthPage;
+    const isize commitSize = alignUpPO2(getPageSize() * nthPage, commitGranularity());
     ADT_ALLOC_EXCEPTION_FMT(commitSize <= m_reserved, "commitSize: {}, m_reserved: {}", commitSize, m_reserved);
 
     runDeleters();
@@ -301,18 +497,15 @@ Arena::resetToPage(isize nthPage)
     m_pos = 0;
     m_commited = commitSize;
     m_pLastAlloc = (void*)INVALID_PTR;
+    resetTrimming();
 }
 
 inline void
 Arena::growIfNeeded(isize newPos)
 {
-    if (newPos > m_commited)
-    {
-        const isize newCommited = utils::max((isize)alignUpPO2(newPos, getPageSize()), m_commited * 2);
-        ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(newCommited <= m_reserved, "out of reserved memory, newPos: {}, m_reserved: {}", newCommited, m_reserved);
-        commit((u8*)m_pData + m_commited, newCommited - m_commited);
-        m_commited = newCommited;
-    }
+    if (newPos > m_commited) [[unlikely]] growCommited(newPos);
+
+    if (newPos > m_highWater) m_highWater = newPos;
 
 #if ADT_ASAN
     if (newPos > m_pos)
@@ -324,22 +517,102 @@ Arena::growIfNeeded(isize newPos)
     m_pos = newPos;
 }
 
+ADT_NO_INLINE inline void
+Arena::growCommited(isize newPos)
+{
+    ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(newPos <= m_reserved, "out of reserved memory, newPos: {}, m_reserved: {}", newPos, m_reserved);
+
+    isize grown = m_commited * 2;
+    if (m_eGrowth == ARENA_GROWTH::FIXED) grown = m_commited + m_growStep;
+    else if (m_eGrowth == ARENA_GROWTH::CAPPED_DOUBLE) grown = m_commited + utils::min(m_commited, m_growStep);
+
+    const isize newCommited = utils::min(
+        utils::max((isize)alignUpPO2(newPos, commitGranularity()), grown), m_reserved
+    );
+    commit((u8*)m_pData + m_commited, newCommited - m_commited);
+    m_commited = newCommited;
+}
+
+inline void
+Arena::resetTrimming() noexcept
+{
+    m_highWater = 0;
+    m_trimWindowMax = 0;
+    m_trimNInWindow = 0;
+}
+
+/* Tumbling window: after m_trimNResets resets nothing above the window maximum was touched, give it back. */
+inline void
+Arena::trimAfterReset() noexcept
+{
+    m_trimWindowMax = utils::max(m_trimWindowMax, m_highWater);
+    m_highWater = 0;
+
+    if (++m_trimNInWindow < m_trimNResets) return;
+
+    const isize keep = utils::max((isize)alignUpPO2(m_trimWindowMax, commitGranularity()), commitGranularity());
+    if (m_commited > keep)
+    {
+        /* reset() is noexcept: a failed trim is logged, not thrown. The range may be left protected,
+         * so it counts as not commited either way and the next growIfNeeded() commits it again. */
+        try
+        {
+            decommit((u8*)m_pData + keep, m_commited - keep);
+        }
+        catch (const AllocException& ex)
+        {
+            LogError{"trim failed: {}", ex.what()};
+        }
+        m_commited = keep;
+    }
+
+    m_trimWindowMax = 0;
+    m_trimNInWindow = 0;
+}
+
 inline void
 Arena::commit(void* p, isize size)
 {
 #ifdef ADT_ARENA_MMAP
-    [[maybe_unused]] int err = mprotect(p, size, PROT_READ | PROT_WRITE);
-    ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(err != - 1, "mprotect: r: {} ({}), size: {}", err, strerror(errno), size);
+    if (!bool(m_eFlags & ARENA_FLAGS::NORESERVE))
+    {
+        [[maybe_unused]] int err = mprotect(p, size, PROT_READ | PROT_WRITE);
+        ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(err != - 1, "mprotect: r: {} ({}), size: {}", err, strerror(errno), size);
+    }
 #elif defined ADT_ARENA_WIN32
     ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(VirtualAlloc(p, size, MEM_COMMIT, PAGE_READWRITE), "p: {}, size: {}", p, size);
 #else
 #endif
+
+    if (bool(m_eFlags & ARENA_FLAGS::POPULATE))
+    {
+#if defined ADT_ARENA_MMAP && defined MADV_POPULATE_WRITE
+        if (madvise(p, size, MADV_POPULATE_WRITE) == 0) return;
+#endif
+        /* Older kernels: fault pages in one by one (fresh anonymous memory is zeroed, writing 0 changes nothing). */
+        ADT_ASAN_UNPOISON(p, size);
+        const isize pageSize = getPageSize();
+        for (isize off = 0; off < size; off += pageSize)
+            ((volatile u8*)p)[off] = 0;
+        ADT_ASAN_POISON(p, size);
+    }
 }
 
 inline void
 Arena::decommit(void* p, isize size)
 {
 #ifdef ADT_ARENA_MMAP
+        if (bool(m_eFlags & ARENA_FLAGS::NORESERVE))
+        {
+    #ifdef MADV_FREE
+            /* Pages stay mapped until memory pressure, reuse before that costs no fault. Not on hugetlb mappings. */
+            if (madvise(p, size, MADV_FREE) == 0) return;
+    #endif
+            [[maybe_unused]] int err = madvise(p, size, MADV_DONTNEED);
+            ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(err != - 1, "madvise: {} ({})", err, strerror(errno));
+            return;
+        }
+
         [[maybe_unused]] int err = mprotect(p, size, PROT_NONE);
         ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(err != - 1, "mprotect: {} ({})", err, strerror(errno));
         err = madvise(p, size, MADV_DONTNEED);
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "Arena.hh"
+#include "Thread.hh"
+#include "atomic.hh"
+
+namespace adt
+{
+
+/* Reserve/commit linear allocator shared between threads.
+ * malloc() is one fetch-add on the position, pages are committed ahead (doubling) under a mutex that only
+ * the thread crossing the commited mark takes. realloc() grows in place if nothing was allocated after the block.
+ * Scopes, reset() and IArena::Ptr belong to one owning thread and require no concurrent allocations. */
+struct ArenaConcurrent : IArena
+{
+
+    /* */
+
+    u8* m_pData {};
+    isize m_reserved {};
+    Mutex m_mtxCommit {};
+    char m_aPad0[CACHELINE_SIZE] {};
+    atomic::Num<isize> m_atomPos {}; /* Contended, separate from the read-mostly m_atomCommited. */
+    char m_aPad1[CACHELINE_SIZE] {};
+    atomic::Num<isize> m_atomCommited {};
+
+    /* */
+
+    ArenaConcurrent() noexcept = default;
+    ArenaConcurrent(isize reserveSize, isize commitSize = getPageSize()) noexcept(false); /* AllocException */
+
+    /* */
+
+    [[nodiscard]] virtual void* malloc(usize nBytes) noexcept(false) override; /* AllocException */
+    [[nodiscard]] virtual void* zalloc(usize nBytes) noexcept(false) override; /* AllocException */
+    [[nodiscard]] virtual void* realloc(void* p, usize oldNBytes, usize newNBytes) noexcept(false) override; /* AllocException */
+    virtual void free(void* ptr, usize nBytes) noexcept override;
+
+    [[nodiscard]] virtual constexpr bool doesFree() const noexcept override { return false; }
+    [[nodiscard]] virtual constexpr bool doesRealloc() const noexcept override { return true; }
+
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override; /* AllocException */
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override; /* AllocException */
+    [[nodiscard]] virtual void* reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override; /* AllocException */
+
+    virtual void freeAll() noexcept override;
+    [[nodiscard]] virtual IScope restoreAfterScope() noexcept override;
+    virtual usize memoryUsed() const noexcept override { return m_atomPos.load(atomic::ORDER::RELAXED); }
+
+    /* */
+
+    void reset() noexcept;
+    isize memoryReserved() const noexcept { return m_reserved; }
+    isize memoryCommited() const noexcept { return m_atomCommited.load(atomic::ORDER::RELAXED); }
+
+protected:
+    void commitUpTo(isize newPos);
+};
+
+struct ArenaConcurrentScope : IArena::IScopeDestructor
+{
+    ArenaConcurrent* m_pArena {};
+    isize m_pos {};
+    SList<ArenaConcurrent::DeleterNode>* m_pLPrevDeleters {};
+    SList<ArenaConcurrent::DeleterNode> m_lDeleters {};
+
+    /* */
+
+    explicit ArenaConcurrentScope(ArenaConcurrent* pArena) noexcept;
+
+    virtual ~ArenaConcurrentScope() noexcept override;
+};
+
+template<>
+struct IArena::Scope<ArenaConcurrent> final : ArenaConcurrentScope
+{
+    using ArenaConcurrentScope::ArenaConcurrentScope;
+};
+
+inline
+ArenaConcurrentScope::ArenaConcurrentScope(ArenaConcurrent* pArena) noexcept
+    : m_pArena {pArena},
+      m_pos {pArena->m_atomPos.load(atomic::ORDER::RELAXED)},
+      m_pLPrevDeleters {pArena->m_pLCurrentDeleters}
+{
+    pArena->m_pLCurrentDeleters = &m_lDeleters;
+}
+
+inline
+ArenaConcurrentScope::~ArenaConcurrentScope() noexcept
+{
+    m_pArena->runDeleters();
+    m_pArena->m_atomPos.store(m_pos, atomic::ORDER::RELAXED);
+    m_pArena->m_pLCurrentDeleters = m_pLPrevDeleters;
+}
+
+inline
+ArenaConcurrent::ArenaConcurrent(isize reserveSize, isize commitSize)
+    : IArena {INIT},
+      m_mtxCommit {Mutex::TYPE::PLAIN}
+{
+    const isize realReserved = alignUpPO2(reserveSize, getPageSize());
+
+#ifdef ADT_ARENA_MMAP
+    void* pRes = mmap(nullptr, realReserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pRes == MAP_FAILED) throw AllocException{"mmap() failed"};
+#elif defined ADT_ARENA_WIN32
+    void* pRes = VirtualAlloc(nullptr, realReserved, MEM_RESERVE, PAGE_READWRITE);
+    ADT_ALLOC_EXCEPTION_FMT(pRes, "VirtualAlloc() failed to reserve: {}", realReserved);
+#else
+#endif
+
+    m_pData = (u8*)pRes;
+    m_reserved = realReserved;
+
+    if (commitSize > 0) commitUpTo(utils::min(commitSize, m_reserved));
+}
+
+inline void*
+ArenaConcurrent::malloc(usize nBytes)
+{
+    const isize realSize = alignUp8(nBytes);
+    const isize pos = m_atomPos.fetchAdd(realSize, atomic::ORDER::RELAXED);
+
+    /* Past the reserve: give the bytes back before throwing, or every later allocation fails too.
+     * Everyone who added while this was pending is past the reserve as well (fails even if it would fit alone)
+     * and rolls back the same way. */
+    if (pos + realSize > m_reserved) [[unlikely]]
+    {
+        m_atomPos.fetchSub(realSize, atomic::ORDER::RELAXED);
+        throw AllocException("out of reserved memory");
+    }
+
+    /* Acquire: pairs with the release in commitUpTo(). */
+    if (pos + realSize > m_atomCommited.load(atomic::ORDER::ACQUIRE)) [[unlikely]]
+        commitUpTo(pos + realSize);
+
+    return m_pData + pos;
+}
+
+inline void*
+ArenaConcurrent::zalloc(usize nBytes)
+{
+    void* pMem = malloc(nBytes);
+    ::memset(pMem, 0, nBytes);
+    return pMem;
+}
+
+inline void*
+ArenaConcurrent::realloc(void* p, usize oldNBytes, usize newNBytes)
+{
+    if (!p) return malloc(newNBytes);
+    if (newNBytes <= oldNBytes) return p;
+
+    /* Last block: move the end forward if nobody allocated after it. */
+    const isize off = (u8*)p - m_pData;
+    isize oldEnd = off + alignUp8(oldNBytes);
+    const isize newEnd = off + alignUp8(newNBytes);
+    if (newEnd <= m_reserved && m_atomPos.compareExchange(&oldEnd, newEnd, atomic::ORDER::RELAXED, atomic::ORDER::RELAXED))
+    {
+        if (newEnd > m_atomCommited.load(atomic::ORDER::ACQUIRE)) [[unlikely]]
+            commitUpTo(newEnd);
+
+        return p;
+    }
+
+    void* pMem = malloc(newNBytes);
+    ::memcpy(pMem, p, oldNBytes);
+    return pMem;
+}
+
+inline void
+ArenaConcurrent::free(void*, usize) noexcept
+{
+    /* noop */
+}
+
+inline void*
+ArenaConcurrent::mallocAligned(usize nBytes, usize alignment)
+{
+    ADT_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "alignment: {}", alignment);
+    if (alignment <= ALLOC_ALIGNMENT) return malloc(nBytes);
+
+    /* Padding depends on the position, so it can't be a blind fetch-add. */
+    isize pos = m_atomPos.load(atomic::ORDER::RELAXED);
+    isize alignedPos, newPos;
+    do
+    {
+        alignedPos = (u8*)alignUpPO2(usize(m_pData + pos), alignment) - m_pData;
+        newPos = alignedPos + alignUp8(nBytes);
+        ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(newPos <= m_reserved, "out of reserved memory, newPos: {}, m_reserved: {}", newPos, m_reserved);
+    }
+    while (!m_atomPos.compareExchangeWeak(&pos, newPos, atomic::ORDER::RELAXED, atomic::ORDER::RELAXED));
+
+    if (newPos > m_atomCommited.load(atomic::ORDER::ACQUIRE)) [[unlikely]]
+        commitUpTo(newPos);
+
+    return m_pData + alignedPos;
+}
+
+inline void*
+ArenaConcurrent::zallocAligned(usize nBytes, usize alignment)
+{
+    void* pMem = mallocAligned(nBytes, alignment);
+    ::memset(pMem, 0, nBytes);
+    return pMem;
+}
+
+inline void*
+ArenaConcurrent::reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    /* In place growth keeps the start, so it stays aligned. */
+    if (!p) return mallocAligned(newNBytes, alignment);
+    if (newNBytes <= oldNBytes) return p;
+
+    const isize off = (u8*)p - m_pData;
+    isize oldEnd = off + alignUp8(oldNBytes);
+    const isize newEnd = off + alignUp8(newNBytes);
+    if (newEnd <= m_reserved && m_atomPos.compareExchange(&oldEnd, newEnd, atomic::ORDER::RELAXED, atomic::ORDER::RELAXED))
+    {
+        if (newEnd > m_atomCommited.load(atomic::ORDER::ACQUIRE)) [[unlikely]]
+            commitUpTo(newEnd);
+
+        return p;
+    }
+
+    void* pMem = mallocAligned(newNBytes, alignment);
+    ::memcpy(pMem, p, oldNBytes);
+    return pMem;
+}
+
+inline void
+ArenaConcurrent::freeAll() noexcept
+{
+    runDeleters();
+
+#ifdef ADT_ARENA_MMAP
+    [[maybe_unused]] int err = munmap(m_pData, m_reserved);
+    ADT_ASSERT(err != - 1, "munmap: {} ({})", err, strerror(errno));
+#elif defined ADT_ARENA_WIN32
+    VirtualFree(m_pData, 0, MEM_RELEASE);
+#else
+#endif
+
+    m_mtxCommit.destroy();
+    *this = {};
+}
+
+inline IArena::IScope
+ArenaConcurrent::restoreAfterScope() noexcept
+{
+    return alloc<ArenaConcurrentScope>(this);
+}
+
+inline void
+ArenaConcurrent::reset() noexcept
+{
+    runDeleters();
+    m_atomPos.store(0, atomic::ORDER::RELAXED);
+}
+
+inline void
+ArenaConcurrent::commitUpTo(isize newPos)
+{
+    ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(newPos <= m_reserved, "out of reserved memory, newPos: {}, m_reserved: {}", newPos, m_reserved);
+
+    LockScope lock {&m_mtxCommit};
+
+    /* Someone else could have committed past newPos while we waited. */
+    const isize commited = m_atomCommited.load(atomic::ORDER::RELAXED);
+    if (newPos <= commited) return;
+
+    const isize newCommited = utils::min(
+        utils::max((isize)alignUpPO2(newPos, getPageSize()), commited * 2), m_reserved
+    );
+
+#ifdef ADT_ARENA_MMAP
+    [[maybe_unused]] int err = mprotect(m_pData + commited, newCommited - commited, PROT_READ | PROT_WRITE);
+    ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(err != - 1, "mprotect: r: {} ({}), size: {}", err, strerror(errno), newCommited - commited);
+#elif defined ADT_ARENA_WIN32
+    ADT_ALLOC_EXCEPTION_UNLIKELY_FMT(
+        VirtualAlloc(m_pData + commited, newCommited - commited, MEM_COMMIT, PAGE_READWRITE),
+        "size: {}", newCommited - commited
+    );
+#else
+#endif
+
+    m_atomCommited.store(newCommited, atomic::ORDER::RELEASE);
+}
+
+} /* namespace adt */
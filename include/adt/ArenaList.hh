@@ -58,6 +58,10 @@ struct ArenaList final : public IArena
     [[nodiscard]] virtual constexpr bool doesFree() const noexcept override { return false; }
     [[nodiscard]] virtual constexpr bool doesRealloc() const noexcept override { return true; }
 
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override;
+
     virtual void freeAll() noexcept override;
     [[nodiscard]] virtual IScope restoreAfterScope() noexcept override;
     virtual usize memoryUsed() const noexcept override;
@@ -279,6 +283,57 @@ ArenaList::free(void*, usize) noexcept
     /* noop */
 }
 
+inline void*
+ArenaList::mallocAligned(usize nBytes, usize alignment)
+{
+    ADT_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "alignment: {}", alignment);
+    if (alignment <= ALLOC_ALIGNMENT) return malloc(nBytes);
+
+    const usize realSize = alignUp8(nBytes);
+    /* Worst case padding, blocks are only ALLOC_ALIGNMENT aligned. */
+    auto* pBlock = findFittingBlock(realSize + alignment - ALLOC_ALIGNMENT);
+    if (!pBlock) pBlock = prependBlock(utils::max(m_defaultCapacity, usize((realSize + alignment)*1.33)));
+
+    u8* pRet = (u8*)alignUpPO2(usize(pBlock->pMem() + pBlock->nBytesOccupied), alignment);
+    pBlock->nBytesOccupied = (pRet - pBlock->pMem()) + realSize;
+    pBlock->pLastAlloc = pRet;
+
+    return pRet;
+}
+
+inline void*
+ArenaList::zallocAligned(usize nBytes, usize alignment)
+{
+    auto* p = mallocAligned(nBytes, alignment);
+    memset(p, 0, alignUp8(nBytes));
+    return p;
+}
+
+inline void*
+ArenaList::reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    if (!ptr) return mallocAligned(newNBytes, alignment);
+    if (newNBytes <= oldNBytes) return ptr;
+
+    auto* pBlock = findBlockFromPtr(static_cast<u8*>(ptr));
+    if (!pBlock) throw AllocException("pointer doesn't belong to this arena");
+
+    if (ptr == pBlock->pLastAlloc) /* bump case */
+    {
+        const usize reallocPos = (pBlock->pLastAlloc - pBlock->pMem()) + alignUp8(newNBytes);
+        if (reallocPos <= pBlock->cap)
+        {
+            pBlock->nBytesOccupied = reallocPos;
+            return ptr;
+        }
+    }
+
+    auto* pRet = mallocAligned(newNBytes, alignment);
+    memcpy(pRet, ptr, oldNBytes);
+
+    return pRet;
+}
+
 inline void
 ArenaList::freeAll() noexcept
 {
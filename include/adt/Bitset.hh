@@ -0,0 +1,142 @@
+#pragma once
+
+#include "utils.hh"
+
+#include <bit>
+
+namespace adt
+{
+
+/* Word at a time helpers over u64 bit arrays, shared by Bitset and growable bitmaps (PoolDynamic). */
+namespace bitset
+{
+
+inline bool
+test(const u64* pWords, isize i) noexcept
+{
+    return pWords[i >> 6] & (1llu << (i & 63));
+}
+
+inline void
+set(u64* pWords, isize i) noexcept
+{
+    pWords[i >> 6] |= 1llu << (i & 63);
+}
+
+inline void
+unset(u64* pWords, isize i) noexcept
+{
+    pWords[i >> 6] &= ~(1llu << (i & 63));
+}
+
+/* First set bit at or after i, -1 if none. */
+inline isize
+next(const u64* pWords, isize nWords, isize i) noexcept
+{
+    isize wordI = i >> 6;
+    if (i < 0 || wordI >= nWords) return -1;
+
+    u64 word = pWords[wordI] & (~0llu << (i & 63));
+    while (word == 0)
+    {
+        if (++wordI >= nWords) return -1;
+        word = pWords[wordI];
+    }
+
+    return (wordI << 6) + std::countr_zero(word);
+}
+
+/* Last set bit at or before i, -1 if none. */
+inline isize
+prev(const u64* pWords, isize i) noexcept
+{
+    if (i < 0) return -1;
+
+    isize wordI = i >> 6;
+    u64 word = pWords[wordI] & (~0llu >> (63 - (i & 63)));
+    while (word == 0)
+    {
+        if (--wordI < 0) return -1;
+        word = pWords[wordI];
+    }
+
+    return (wordI << 6) + 63 - std::countl_zero(word);
+}
+
+/* Calls cl(firstI, count) for every run of consecutive set bits, runs may cross word boundaries. */
+template<typename CL>
+inline void
+forEachRun(const u64* pWords, isize nWords, CL cl)
+{
+    isize runStart = -1; /* Run that reached the end of the previous word. */
+
+    for (isize wordI = 0; wordI < nWords; ++wordI)
+    {
+        u64 word = pWords[wordI];
+        const isize base = wordI << 6;
+
+        if (runStart != -1)
+        {
+            if (word == ~0llu) continue;
+
+            const isize len = std::countr_one(word);
+            cl(runStart, base + len - runStart);
+            runStart = -1;
+            word &= ~0llu << len;
+        }
+
+        while (word != 0)
+        {
+            const isize start = std::countr_zero(word);
+            const isize len = std::countr_one(word >> start);
+            if (start + len == 64)
+            {
+                runStart = base + start;
+                break;
+            }
+
+            cl(base + start, len);
+            word &= ~0llu << (start + len);
+        }
+    }
+
+    if (runStart != -1) cl(runStart, (nWords << 6) - runStart);
+}
+
+} /* namespace bitset */
+
+/* Fixed size bit array. */
+template<isize N>
+struct Bitset
+{
+    static constexpr isize N_WORDS = (N + 63) / 64;
+
+    /* */
+
+    u64 m_aWords[N_WORDS] {};
+
+    /* */
+
+    bool operator[](isize i) const noexcept { ADT_ASSERT(i >= 0 && i < N, "i: {}, N: {}", i, N); return bitset::test(m_aWords, i); }
+
+    void set(isize i) noexcept { ADT_ASSERT(i >= 0 && i < N, "i: {}, N: {}", i, N); bitset::set(m_aWords, i); }
+    void unset(isize i) noexcept { ADT_ASSERT(i >= 0 && i < N, "i: {}, N: {}", i, N); bitset::unset(m_aWords, i); }
+
+    isize next(isize i) const noexcept { return bitset::next(m_aWords, N_WORDS, i); }
+    isize prev(isize i) const noexcept { return bitset::prev(m_aWords, utils::min(i, N - 1)); }
+
+    template<typename CL>
+    void forEachRun(CL cl) const { bitset::forEachRun(m_aWords, N_WORDS, cl); }
+
+    isize
+    count() const noexcept
+    {
+        isize n = 0;
+        for (u64 w : m_aWords) n += std::popcount(w);
+        return n;
+    }
+
+    constexpr isize size() const noexcept { return N; }
+};
+
+} /* namespace adt */
@@ -45,6 +45,10 @@ struct BufferAllocator : public IArena
     [[nodiscard]] virtual bool doesFree() const noexcept override final { return false; }
     [[nodiscard]] virtual bool doesRealloc() const noexcept override final { return true; }
 
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+
     virtual void freeAll() noexcept override final; /* same as reset */
     [[nodiscard]] virtual IScope restoreAfterScope() noexcept override;
     virtual usize memoryUsed() const noexcept override;
@@ -174,6 +178,46 @@ BufferAllocator::realloc(void* p, usize oldNBytes, usize newNBytes)
     return ret;
 }
 
+inline void*
+BufferAllocator::mallocAligned(usize nBytes, usize alignment)
+{
+    ADT_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "alignment: {}", alignment);
+
+    u8* pRet = (u8*)alignUpPO2(usize(m_pMemBuffer + m_size), utils::max(alignment, ALLOC_ALIGNMENT));
+    const usize newSize = (pRet - m_pMemBuffer) + alignUp8(nBytes);
+
+    if (newSize > m_cap)
+    {
+        errno = ENOBUFS;
+        throw AllocException("BufferAllocator::mallocAligned(): out of memory");
+    }
+
+    m_size = newSize;
+    m_pLastAlloc = pRet;
+
+    return pRet;
+}
+
+inline void*
+BufferAllocator::zallocAligned(usize nBytes, usize alignment)
+{
+    auto* p = mallocAligned(nBytes, alignment);
+    memset(p, 0, nBytes);
+    return p;
+}
+
+inline void*
+BufferAllocator::reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    /* Last allocation grows in place and shrinking never moves, the start is aligned already in both cases. */
+    if (p && (p == m_pLastAlloc || newNBytes <= oldNBytes)) return realloc(p, oldNBytes, newNBytes);
+
+    auto* ret = mallocAligned(newNBytes, alignment);
+    if (p) memcpy(ret, p, oldNBytes);
+
+    return ret;
+}
+
 inline void
 BufferAllocator::freeAll() noexcept
 {
@@ -0,0 +1,140 @@
+#pragma once
+
+/* Bounded Chase-Lev work-stealing deque.
+ * https://fzn.fr/readings/ppopp13.pdf (Correct and Efficient Work-Stealing for Weak Memory Models) */
+
+#include "Gpa.hh"
+#include "Opt.hh"
+#include "atomic.hh"
+
+#include <type_traits>
+
+namespace adt
+{
+
+/* Owner thread pushes/pops from the bottom (LIFO), other threads steal from the top (FIFO).
+ * Doesn't grow: pushBack() returns false when full. */
+template<typename T>
+struct DequeWS
+{
+    static_assert(std::is_trivially_copyable_v<T>, "stealers copy racy slots, lost races are discarded");
+
+    using CacheLinePad = char[CACHELINE_SIZE];
+
+    /* */
+
+    atomic::Long m_atomTop {};
+    CacheLinePad m_pad0 {};
+    atomic::Long m_atomBottom {};
+    CacheLinePad m_pad1 {};
+    T* m_pData {};
+    isize m_cap {};
+
+    /* */
+
+    DequeWS() = default;
+    DequeWS(isize prealloc);
+
+    /* */
+
+    bool pushBack(const T& x) noexcept; /* Owner only. */
+    [[nodiscard]] Opt<T> popBack() noexcept; /* Owner only. */
+    [[nodiscard]] Opt<T> steal() noexcept; /* Any thread. */
+
+    isize size() const noexcept; /* Approximate. */
+    bool empty() const noexcept { return size() <= 0; }
+    isize cap() const noexcept { return m_cap; }
+
+    void destroy() noexcept;
+};
+
+template<typename T>
+inline
+DequeWS<T>::DequeWS(isize prealloc)
+    : m_cap{nextPowerOf2(prealloc)}
+{
+    ADT_ASSERT(isPowerOf2(m_cap), "nextPowerOf2: {}", m_cap);
+    m_pData = Gpa::inst()->zallocV<T>(m_cap);
+}
+
+template<typename T>
+inline bool
+DequeWS<T>::pushBack(const T& x) noexcept
+{
+    const isize b = m_atomBottom.load(atomic::ORDER::RELAXED);
+    const isize t = m_atomTop.load(atomic::ORDER::ACQUIRE);
+
+    if (b - t >= m_cap) return false;
+
+    ::memcpy(static_cast<void*>(&m_pData[b & (m_cap - 1)]), &x, sizeof(T));
+    m_atomBottom.store(b + 1, atomic::ORDER::RELEASE);
+
+    return true;
+}
+
+template<typename T>
+inline Opt<T>
+DequeWS<T>::popBack() noexcept
+{
+    const isize b = m_atomBottom.load(atomic::ORDER::RELAXED) - 1;
+    m_atomBottom.store(b, atomic::ORDER::RELAXED);
+    atomic::fence(atomic::ORDER::SEQ_CST);
+    isize t = m_atomTop.load(atomic::ORDER::RELAXED);
+
+    if (t > b)
+    {
+        m_atomBottom.store(b + 1, atomic::ORDER::RELAXED);
+        return {};
+    }
+
+    T ret;
+    ::memcpy(static_cast<void*>(&ret), &m_pData[b & (m_cap - 1)], sizeof(T));
+
+    if (t == b)
+    {
+        /* Last element, race against stealers. */
+        const bool bWon = m_atomTop.compareExchange(&t, t + 1, atomic::ORDER::SEQ_CST, atomic::ORDER::RELAXED);
+        m_atomBottom.store(b + 1, atomic::ORDER::RELAXED);
+        if (!bWon) return {};
+    }
+
+    return ret;
+}
+
+template<typename T>
+inline Opt<T>
+DequeWS<T>::steal() noexcept
+{
+    isize t = m_atomTop.load(atomic::ORDER::ACQUIRE);
+    atomic::fence(atomic::ORDER::SEQ_CST);
+    const isize b = m_atomBottom.load(atomic::ORDER::ACQUIRE);
+
+    if (t >= b) return {};
+
+    T ret;
+    ::memcpy(static_cast<void*>(&ret), &m_pData[t & (m_cap - 1)], sizeof(T));
+
+    if (!m_atomTop.compareExchange(&t, t + 1, atomic::ORDER::SEQ_CST, atomic::ORDER::RELAXED))
+        return {};
+
+    return ret;
+}
+
+template<typename T>
+inline isize
+DequeWS<T>::size() const noexcept
+{
+    const isize b = m_atomBottom.load(atomic::ORDER::RELAXED);
+    const isize t = m_atomTop.load(atomic::ORDER::RELAXED);
+    return b - t;
+}
+
+template<typename T>
+inline void
+DequeWS<T>::destroy() noexcept
+{
+    Gpa::inst()->freeV(m_pData, m_cap);
+    *this = {};
+}
+
+} /* namespace adt */
@@ -24,6 +24,11 @@ struct Gpa final : IAllocator
 
     [[nodiscard]] virtual constexpr bool doesFree() const noexcept override final { return true; }
     [[nodiscard]] virtual constexpr bool doesRealloc() const noexcept override final { return true; }
+
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+    virtual void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept override final;
     /* virtual end */
 
     static void free(void* ptr) noexcept;
@@ -49,6 +54,18 @@ struct GpaNV final : AllocatorHelperCRTP<GpaNV>
     static void free(void* ptr) noexcept
     { Gpa::inst()->free(ptr); }
 
+    [[nodiscard]] static void* mallocAligned(usize nBytes, usize alignment) noexcept(false)
+    { return Gpa::inst()->mallocAligned(nBytes, alignment); }
+
+    [[nodiscard]] static void* zallocAligned(usize nBytes, usize alignment) noexcept(false)
+    { return Gpa::inst()->zallocAligned(nBytes, alignment); }
+
+    [[nodiscard]] static void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false)
+    { return Gpa::inst()->reallocAligned(ptr, oldNBytes, newNBytes, alignment); }
+
+    static void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept
+    { Gpa::inst()->freeAligned(ptr, nBytes, alignment); }
+
     [[nodiscard]] static constexpr bool doesIndividualFree() noexcept { return true; }
 };
 
@@ -111,6 +128,83 @@ Gpa::free(void* p, usize) noexcept
 #endif
 }
 
+/* Alignments up to ALLOC_ALIGNMENT take the plain path on every platform, _aligned_free() must not see those. */
+inline void*
+Gpa::mallocAligned(usize nBytes, usize alignment)
+{
+    ADT_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "alignment: {}", alignment);
+    if (alignment <= ALLOC_ALIGNMENT) return malloc(nBytes);
+
+#ifdef ADT_USE_MIMALLOC
+    auto* r = ::mi_malloc_aligned(nBytes, alignment);
+#elif defined _WIN32
+    auto* r = ::_aligned_malloc(nBytes, alignment);
+#else
+    auto* r = ::aligned_alloc(alignment, alignUpPO2(nBytes, alignment)); /* Size has to be a multiple of alignment. */
+#endif
+
+    if (!r) [[unlikely]] throw AllocException("Gpa::mallocAligned()");
+
+    return r;
+}
+
+inline void*
+Gpa::zallocAligned(usize nBytes, usize alignment)
+{
+#ifdef ADT_USE_MIMALLOC
+    if (alignment <= ALLOC_ALIGNMENT) return zalloc(nBytes);
+
+    auto* r = ::mi_zalloc_aligned(nBytes, alignment);
+    if (!r) [[unlikely]] throw AllocException("Gpa::zallocAligned()");
+#else
+    auto* r = mallocAligned(nBytes, alignment);
+    ::memset(r, 0, nBytes);
+#endif
+
+    return r;
+}
+
+inline void*
+Gpa::reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    if (alignment <= ALLOC_ALIGNMENT) return realloc(p, oldNBytes, newNBytes);
+
+#ifdef ADT_USE_MIMALLOC
+    auto* r = ::mi_realloc_aligned(p, newNBytes, alignment);
+#elif defined _WIN32
+    auto* r = ::_aligned_realloc(p, newNBytes, alignment);
+#else
+    /* No aligned realloc in libc: ::realloc() may move to a misaligned block and a failure after that would lose p.
+     * Allocate first, so p stays valid if this throws. */
+    auto* r = ::aligned_alloc(alignment, alignUpPO2(newNBytes, alignment));
+    if (r)
+    {
+        if (p) ::memcpy(r, p, oldNBytes < newNBytes ? oldNBytes : newNBytes);
+        ::free(p);
+    }
+#endif
+
+    if (!r) [[unlikely]] throw AllocException("Gpa::reallocAligned()");
+
+    return r;
+}
+
+inline void
+Gpa::freeAligned(void* p, usize, usize alignment) noexcept
+{
+#if defined _WIN32 && !defined ADT_USE_MIMALLOC
+    if (alignment > ALLOC_ALIGNMENT)
+    {
+        ::_aligned_free(p);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+
+    free(p);
+}
+
 inline void
 Gpa::free(void* p) noexcept
 {
@@ -2,6 +2,7 @@
 
 #include "print-inl.hh"
 
+#include <cstring>
 #include <source_location>
 #include <utility>
 #include <new> /* IWYU pragma: keep */
@@ -38,6 +39,8 @@ inline constexpr usize alignUp(usize x, usize to) { return ((x + to - 1) / to) *
 inline constexpr usize sizeClass8(usize x) { return (x + 7) >> 3; }
 
 constexpr isize SIZE_MIN = 2;
+
+constexpr usize ALLOC_ALIGNMENT = 8; /* Every allocator returns at least this aligned memory. */
 constexpr isize SIZE_1K = 1024;
 constexpr isize SIZE_1M = SIZE_1K * SIZE_1K;
 constexpr isize SIZE_1G = SIZE_1M * SIZE_1K;
@@ -62,6 +65,8 @@ getPageSize() noexcept
 #define ADT_WARN_LEAK [[deprecated("warning: memory leak")]]
 #define ADT_WARN_USE_AFTER_FREE [[deprecated("warning: use after free")]]
 
+/* Typed helpers pick the *Aligned() path for types aligned stricter than ALLOC_ALIGNMENT,
+ * memory from them must go back through freeV()/dealloc() (or freeAligned()). */
 template<typename BASE>
 struct AllocatorHelperCRTP
 {
@@ -78,21 +83,43 @@ struct AllocatorHelperCRTP
     [[nodiscard]] constexpr T*
     mallocV(usize mCount) noexcept(false) /* AllocException */
     {
-        return static_cast<T*>(static_cast<BASE*>(this)->malloc(mCount * sizeof(T)));
+        if constexpr (alignof(T) > ALLOC_ALIGNMENT)
+            return static_cast<T*>(static_cast<BASE*>(this)->mallocAligned(mCount * sizeof(T), alignof(T)));
+        else return static_cast<T*>(static_cast<BASE*>(this)->malloc(mCount * sizeof(T)));
     }
 
     template<typename T>
     [[nodiscard]] constexpr T*
     zallocV(usize mCount) noexcept(false) /* AllocException */
     {
-        return static_cast<T*>(static_cast<BASE*>(this)->zalloc(mCount * sizeof(T)));
+        if constexpr (alignof(T) > ALLOC_ALIGNMENT)
+            return static_cast<T*>(static_cast<BASE*>(this)->zallocAligned(mCount * sizeof(T), alignof(T)));
+        else return static_cast<T*>(static_cast<BASE*>(this)->zalloc(mCount * sizeof(T)));
     }
 
     template<typename T>
     [[nodiscard]] constexpr T*
     reallocV(T* ptr, usize oldCount, usize newCount) noexcept(false) /* AllocException */
     {
-        return static_cast<T*>(static_cast<BASE*>(this)->realloc(ptr, oldCount * sizeof(T), newCount * sizeof(T)));
+        if constexpr (alignof(T) > ALLOC_ALIGNMENT)
+        {
+            return static_cast<T*>(static_cast<BASE*>(this)->reallocAligned(
+                ptr, oldCount * sizeof(T), newCount * sizeof(T), alignof(T)
+            ));
+        }
+        else
+        {
+            return static_cast<T*>(static_cast<BASE*>(this)->realloc(ptr, oldCount * sizeof(T), newCount * sizeof(T)));
+        }
+    }
+
+    template<typename T>
+    constexpr void
+    freeV(T* p, usize count) noexcept /* Doesn't run destructors. */
+    {
+        if constexpr (alignof(T) > ALLOC_ALIGNMENT)
+            static_cast<BASE*>(this)->freeAligned(p, count * sizeof(T), alignof(T));
+        else static_cast<BASE*>(this)->free(p, count * sizeof(T));
     }
 
     template<typename T>
@@ -114,7 +141,7 @@ struct AllocatorHelperCRTP
                 p[i].~T();
             }
 
-            static_cast<BASE*>(this)->free(p, oldCount * sizeof(T));
+            freeV(p, oldCount);
             return pNew;
         }
     }
@@ -127,7 +154,7 @@ struct AllocatorHelperCRTP
             for (usize i = 0; i < size; ++i)
                 p[i].~T();
 
-        static_cast<BASE*>(this)->free(p, size * sizeof(T));
+        freeV(p, size);
     }
 
     template<typename T>
@@ -137,7 +164,7 @@ struct AllocatorHelperCRTP
         if constexpr (!std::is_trivially_destructible_v<T>)
             p->~T();
 
-        static_cast<BASE*>(this)->free(p, sizeof(T));
+        freeV(p, 1);
     }
 };
 
@@ -154,6 +181,13 @@ struct IAllocator : AllocatorHelperCRTP<IAllocator>
 
     [[nodiscard]] virtual constexpr bool doesFree() const noexcept = 0;
     [[nodiscard]] virtual constexpr bool doesRealloc() const noexcept = 0;
+
+    /* Power of 2 alignment. Default implementations overallocate and keep the original pointer right before the
+     * returned one, memory from them must be released with freeAligned(). Allocators with native support override all four. */
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false); /* AllocException */
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false); /* AllocException */
+    [[nodiscard]] virtual void* reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false); /* AllocException */
+    virtual void freeAligned(void* p, usize nBytes, usize alignment) noexcept;
 };
 
 /* NOTE: allocator can throw on malloc/zalloc/realloc */
@@ -183,6 +217,55 @@ struct AllocException : public std::bad_alloc
     virtual const char* what() const noexcept override { return m_sfMsg.data(); }
 };
 
+inline void*
+IAllocator::mallocAligned(usize nBytes, usize alignment)
+{
+    if (alignment <= ALLOC_ALIGNMENT) return malloc(nBytes);
+
+    /* At least ALLOC_ALIGNMENT bytes of padding are always there for the original pointer. */
+    u8* pRaw = static_cast<u8*>(malloc(nBytes + alignment));
+    u8* pRet = (u8*)alignUpPO2(usize(pRaw) + 1, alignment);
+    reinterpret_cast<void**>(pRet)[-1] = pRaw;
+
+    return pRet;
+}
+
+inline void*
+IAllocator::zallocAligned(usize nBytes, usize alignment)
+{
+    void* p = mallocAligned(nBytes, alignment);
+    ::memset(p, 0, nBytes);
+    return p;
+}
+
+inline void*
+IAllocator::reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    if (alignment <= ALLOC_ALIGNMENT) return realloc(p, oldNBytes, newNBytes);
+
+    void* pNew = mallocAligned(newNBytes, alignment);
+    if (p)
+    {
+        ::memcpy(pNew, p, oldNBytes < newNBytes ? oldNBytes : newNBytes);
+        freeAligned(p, oldNBytes, alignment);
+    }
+
+    return pNew;
+}
+
+inline void
+IAllocator::freeAligned(void* p, usize nBytes, usize alignment) noexcept
+{
+    if (alignment <= ALLOC_ALIGNMENT)
+    {
+        free(p, nBytes);
+        return;
+    }
+
+    if (!p) return;
+    free(reinterpret_cast<void**>(p)[-1], nBytes + alignment);
+}
+
 #define ADT_ALLOC_EXCEPTION(CND)                                                                                       \
     if (!static_cast<bool>(CND))                                                                                       \
         throw adt::AllocException(#CND);
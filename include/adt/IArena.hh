@@ -37,6 +37,8 @@ struct IArena : IAllocator
     [[nodiscard]] virtual IScope restoreAfterScope() noexcept = 0;
     usize virtual memoryUsed() const noexcept = 0;
 
+    virtual void freeAligned(void*, usize, usize) noexcept override { /* noop */ }
+
     /* */
 
     using PfnDeleter = void(*)(void**);
@@ -191,8 +191,8 @@ struct Logger : ILogger
     char* m_pDrainBuff {};
     Mutex m_mtxRing {};
     CndVar m_cndRing {};
-    Thread m_thrd {};
     bool m_bDead {};
+    Thread m_thrd {}; /* Last, loop() starts before the constructor returns. */
 
     /* */
 
@@ -1,6 +1,8 @@
-/* Hashmap with linear probing.
+/* Hashmap with linear probing and backward shift deletion (no tombstones).
  * For custom hash function add template<> hash::func(const KeyType& x), (or specify in the template argument)
- * and bool operator==(const KeyType& other) */
+ * and bool operator==(const KeyType& other)
+ * Buckets of string-like keys cache the hash (see MapStoreHash): probes compare it before the keys
+ * and rehash/remove don't call FN_HASH. */
 
 #pragma once
 
@@ -20,7 +22,6 @@ enum class MAP_BUCKET_FLAGS : u8
 {
     NONE = 0,
     OCCUPIED = 1,
-    DELETED = 2,
 };
 
 template<typename K, typename V>
@@ -30,11 +31,25 @@ struct KeyVal
     ADT_NO_UNIQUE_ADDRESS V val {}; /* ADT_NO_UNIQUE_ADDRESS for empty values */
 };
 
+/* Specialize to cache (or not) hashes of K in the buckets. Pays off when comparing keys is expensive. */
+template<typename K>
+struct MapStoreHash
+{
+    static constexpr bool value = ConvertsToStringView<K>;
+};
+
+struct MapNoHash {};
+
 template<typename K, typename V>
 struct MapBucket
 {
+    static constexpr bool STORE_HASH = MapStoreHash<K>::value;
+
+    /* */
+
     K key {};
     ADT_NO_UNIQUE_ADDRESS V val {}; /* ADT_NO_UNIQUE_ADDRESS for empty values */
+    ADT_NO_UNIQUE_ADDRESS std::conditional_t<STORE_HASH, usize, MapNoHash> hash {};
     MAP_BUCKET_FLAGS eFlags {};
     /* keep this order for iterators */
 };
@@ -98,6 +113,17 @@ struct MapResult
 template<typename K, typename V, usize (*FN_HASH)(const K&) = hash::func<K>>
 struct Map
 {
+    static constexpr isize SEARCH_BATCH_SIZE = 16; /* Power of 2. */
+
+    /* StringView must hash the same way as K. */
+    static constexpr bool HETEROGENEOUS = [] {
+        if constexpr (std::is_base_of_v<StringView, K> && !std::is_same_v<K, StringView>)
+            return FN_HASH == static_cast<usize (*)(const K&)>(hash::func<K>);
+        else return false;
+    }();
+
+    /* */
+
     Vec<MapBucket<K, V>> m_vBuckets {};
     isize m_nOccupied {};
     f32 m_maxLoadFactor {};
@@ -105,8 +131,10 @@ struct Map
     /* */
 
     Map() = default;
-    Map(IAllocator* pAllocator, isize prealloc = SIZE_MIN, f32 loadFactor = MAP_DEFAULT_LOAD_FACTOR);
-    Map(IAllocator* pAllocator, std::initializer_list<Pair<K, V>> lPairs);
+    template<IsAllocator ALLOC>
+    Map(ALLOC* pAllocator, isize prealloc = SIZE_MIN, f32 loadFactor = MAP_DEFAULT_LOAD_FACTOR);
+    template<IsAllocator ALLOC>
+    Map(ALLOC* pAllocator, std::initializer_list<Pair<K, V>> lPairs);
 
     /* */
 
@@ -125,31 +153,40 @@ struct Map
 
     [[nodiscard]] f32 loadFactor() const;
 
-    MapResult<K, V> insert(IAllocator* p, const K& key, const V& val);
-    MapResult<K, V> insert(IAllocator* p, const K& key, V&& val);
+    template<IsAllocator ALLOC>
+    MapResult<K, V> insert(ALLOC* p, const K& key, const V& val);
+    template<IsAllocator ALLOC>
+    MapResult<K, V> insert(ALLOC* p, const K& key, V&& val);
 
-    template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
-    MapResult<K, V> emplace(IAllocator* p, const K& key, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+    MapResult<K, V> emplace(ALLOC* p, const K& key, ARGS&&... args);
 
-    template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
-    MapResult<K, V> emplaceHashed(IAllocator* p, const K& key, const usize keyHash, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+    MapResult<K, V> emplaceHashed(ALLOC* p, const K& key, const usize keyHash, ARGS&&... args);
 
     [[nodiscard]] MapResult<K, V> search(const K& key);
     [[nodiscard]] const MapResult<K, V> search(const K& key) const;
 
-    void remove(isize i);
+    /* Heterogeneous lookup: Map<String, V> can be searched with a StringView (or a const char*) without making a String. */
+    [[nodiscard]] MapResult<K, V> search(const StringView sv) const requires(HETEROGENEOUS);
+    [[nodiscard]] MapResult<K, V> searchHashed(const StringView sv, usize keyHash) const requires(HETEROGENEOUS);
+
+    void remove(isize i); /* Shifts following entries back, so pointers to other entries may change. */
 
     void remove(const K& key);
 
     bool tryRemove(const K& key);
 
-    MapResult<K, V> tryInsert(IAllocator* p, const K& key, const V& val);
-    MapResult<K, V> tryInsert(IAllocator* p, const K& key, V&& val);
+    template<IsAllocator ALLOC>
+    MapResult<K, V> tryInsert(ALLOC* p, const K& key, const V& val);
+    template<IsAllocator ALLOC>
+    MapResult<K, V> tryInsert(ALLOC* p, const K& key, V&& val);
 
-    template<typename ...ARGS>
-    MapResult<K, V> tryEmplace(IAllocator* p, const K& key, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS>
+    MapResult<K, V> tryEmplace(ALLOC* p, const K& key, ARGS&&... args);
 
-    void destroy(IAllocator* p) noexcept;
+    template<IsAllocator ALLOC>
+    void destroy(ALLOC* p) noexcept;
 
     [[nodiscard]] Map release() noexcept;
 
@@ -157,16 +194,31 @@ struct Map
 
     [[nodiscard]] isize size() const;
 
-    void rehash(IAllocator* p, isize size);
+    template<IsAllocator ALLOC>
+    void rehash(ALLOC* p, isize size);
 
     [[nodiscard]] MapResult<K, V> searchHashed(const K& key, usize keyHash) const;
 
+    /* Prefetches buckets SEARCH_BATCH_SIZE keys ahead of the probe, so cache misses overlap
+     * instead of going one after another. Returns number of found keys. */
+    template<typename RESULT_T = MapResult<K, V>> requires(std::is_constructible_v<RESULT_T, MapResult<K, V>>)
+    isize searchBatch(Span<const K> spKeys, Span<RESULT_T> spResults) const;
+
     void zeroOut();
 
     isize insertionIdx(usize hash, const K& key) const;
 
     /* */
 
+protected:
+    static bool bucketHashEq(const MapBucket<K, V>& bucket, usize hash);
+    static usize bucketHash(const MapBucket<K, V>& bucket);
+
+    template<typename KEY_T>
+    MapResult<K, V> searchHashedAs(const KEY_T& key, usize keyHash) const;
+
+    /* */
+
 public:
 
     template<typename P_MAP>
@@ -255,31 +307,33 @@ Map<K, V, FN_HASH>::loadFactor() const
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<IsAllocator ALLOC>
 inline MapResult<K, V>
-Map<K, V, FN_HASH>::insert(IAllocator* p, const K& key, const V& val)
+Map<K, V, FN_HASH>::insert(ALLOC* p, const K& key, const V& val)
 {
     return emplace(p, key, val);
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<IsAllocator ALLOC>
 inline MapResult<K, V>
-Map<K, V, FN_HASH>::insert(IAllocator* p, const K& key, V&& val)
+Map<K, V, FN_HASH>::insert(ALLOC* p, const K& key, V&& val)
 {
     return emplace(p, key, std::move(val));
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
-template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
 inline MapResult<K, V>
-Map<K, V, FN_HASH>::emplace(IAllocator* p, const K& key, ARGS&&... args)
+Map<K, V, FN_HASH>::emplace(ALLOC* p, const K& key, ARGS&&... args)
 {
     return emplaceHashed(p, key, FN_HASH(key), std::forward<ARGS>(args)...);
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
-template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
 inline MapResult<K, V>
-Map<K, V, FN_HASH>::emplaceHashed(IAllocator* p, const K& key, const usize keyHash, ARGS&&... args)
+Map<K, V, FN_HASH>::emplaceHashed(ALLOC* p, const K& key, const usize keyHash, ARGS&&... args)
 {
     if (m_vBuckets.cap() <= 0)
         *this = {p};
@@ -296,7 +350,7 @@ Map<K, V, FN_HASH>::emplaceHashed(IAllocator* p, const K& key, const usize keyHa
         bucket.eFlags = MAP_BUCKET_FLAGS::OCCUPIED;
     );
 
-    if (bucket.key == key)
+    if (bucket.eFlags == MAP_BUCKET_FLAGS::OCCUPIED) /* Empty buckets hold K {}, which might equal the key. */
     {
 #ifndef NDEBUG
         LogWarn("updating value for existing key('{}'): old: '{}', new: '{}'\n",
@@ -313,6 +367,7 @@ Map<K, V, FN_HASH>::emplaceHashed(IAllocator* p, const K& key, const usize keyHa
 
     utils::destruct(&bucket.key);
     new(&bucket.key) K(key);
+    if constexpr (MapBucket<K, V>::STORE_HASH) bucket.hash = keyHash;
 
     ++m_nOccupied;
 
@@ -341,7 +396,24 @@ template<typename K, typename V, usize (*FN_HASH)(const K&)>
 inline void
 Map<K, V, FN_HASH>::remove(isize i)
 {
-    auto& bucket = m_vBuckets[i];
+    ADT_ASSERT(m_vBuckets[i].eFlags == MAP_BUCKET_FLAGS::OCCUPIED, "i: {}", i);
+
+    const isize mask = m_vBuckets.cap() - 1;
+    isize hole = i;
+
+    /* Pull back every entry of the cluster that can be found from its home slot through the hole. */
+    for (isize j = (i + 1) & mask; m_vBuckets[j].eFlags == MAP_BUCKET_FLAGS::OCCUPIED; j = (j + 1) & mask)
+    {
+        const isize home = isize(bucketHash(m_vBuckets[j]) & usize(mask));
+        if (((j - home) & mask) < ((j - hole) & mask)) continue; /* Its home is between the hole and j. */
+
+        m_vBuckets[hole].key = std::move(m_vBuckets[j].key);
+        m_vBuckets[hole].val = std::move(m_vBuckets[j].val);
+        m_vBuckets[hole].hash = m_vBuckets[j].hash;
+        hole = j;
+    }
+
+    auto& bucket = m_vBuckets[hole];
 
     utils::destruct(&bucket.key);
     new(&bucket.key) K {};
@@ -349,7 +421,7 @@ Map<K, V, FN_HASH>::remove(isize i)
     utils::destruct(&bucket.val);
     new(&bucket.val) V {};
 
-    bucket.eFlags = MAP_BUCKET_FLAGS::DELETED;
+    bucket.eFlags = MAP_BUCKET_FLAGS::NONE;
 
     --m_nOccupied;
 }
@@ -380,23 +452,25 @@ Map<K, V, FN_HASH>::tryRemove(const K& key)
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<IsAllocator ALLOC>
 inline MapResult<K, V>
-Map<K, V, FN_HASH>::tryInsert(IAllocator* p, const K& key, const V& val)
+Map<K, V, FN_HASH>::tryInsert(ALLOC* p, const K& key, const V& val)
 {
     return tryEmplace(p, key, val);
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<IsAllocator ALLOC>
 inline MapResult<K, V>
-Map<K, V, FN_HASH>::tryInsert(IAllocator* p, const K& key, V&& val)
+Map<K, V, FN_HASH>::tryInsert(ALLOC* p, const K& key, V&& val)
 {
     return tryEmplace(p, key, std::move(val));
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
-template<typename ...ARGS>
+template<IsAllocator ALLOC, typename ...ARGS>
 inline MapResult<K, V>
-Map<K, V, FN_HASH>::tryEmplace(IAllocator* p, const K& key, ARGS&&... args)
+Map<K, V, FN_HASH>::tryEmplace(ALLOC* p, const K& key, ARGS&&... args)
 {
     const usize keyHash = FN_HASH(key);
     auto f = searchHashed(key, keyHash);
@@ -405,14 +479,15 @@ Map<K, V, FN_HASH>::tryEmplace(IAllocator* p, const K& key, ARGS&&... args)
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<IsAllocator ALLOC>
 inline void
-Map<K, V, FN_HASH>::destroy(IAllocator* p) noexcept
+Map<K, V, FN_HASH>::destroy(ALLOC* p) noexcept
 {
     if constexpr (!std::is_trivially_destructible_v<KeyVal<K, V>>)
         for (auto& e : *this)
             e.~KeyVal<K, V>();
 
-    p->free(m_vBuckets.m_pData, m_vBuckets.m_capacity);
+    p->freeV(m_vBuckets.m_pData, m_vBuckets.m_capacity);
     *this = {};
 }
 
@@ -436,23 +511,118 @@ inline isize Map<K, V, FN_HASH>::size() const
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<IsAllocator ALLOC>
 inline void
-Map<K, V, FN_HASH>::rehash(IAllocator* p, isize size)
+Map<K, V, FN_HASH>::rehash(ALLOC* p, isize size)
 {
-    ADT_ASSERT(isPowerOf2(size), "size: {}", size);
+    ADT_ASSERT(isPowerOf2(size) && size > m_nOccupied, "size: {}, nOccupied: {}", size, m_nOccupied);
 
-    Map mNew = Map(p, size);
+    Vec<MapBucket<K, V>> vNew {p, size};
+    vNew.setSize(p, size);
 
-    for (const auto& [key, val] : *this)
-        mNew.emplace(p, key, val);
+    const isize mask = size - 1;
+    for (auto& bucket : m_vBuckets)
+    {
+        if (bucket.eFlags != MAP_BUCKET_FLAGS::OCCUPIED) continue;
+
+        /* Keys are unique, first free bucket is the one. */
+        isize idx = isize(bucketHash(bucket) & usize(mask));
+        while (vNew[idx].eFlags == MAP_BUCKET_FLAGS::OCCUPIED)
+            idx = (idx + 1) & mask;
+
+        auto& rNew = vNew[idx];
+        new(&rNew.key) K(std::move(bucket.key));
+        new(&rNew.val) V(std::move(bucket.val));
+        rNew.hash = bucket.hash;
+        rNew.eFlags = MAP_BUCKET_FLAGS::OCCUPIED;
+    }
 
     m_vBuckets.destroy(p);
-    *this = mNew;
+    m_vBuckets = vNew;
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
 [[nodiscard]] inline MapResult<K, V>
 Map<K, V, FN_HASH>::searchHashed(const K& key, usize keyHash) const
+{
+    return searchHashedAs(key, keyHash);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename RESULT_T> requires(std::is_constructible_v<RESULT_T, MapResult<K, V>>)
+inline isize
+Map<K, V, FN_HASH>::searchBatch(Span<const K> spKeys, Span<RESULT_T> spResults) const
+{
+    ADT_ASSERT(spResults.size() >= spKeys.size(), "spResults: {}, spKeys: {}", spResults.size(), spKeys.size());
+
+    if (m_nOccupied <= 0)
+    {
+        for (isize i = 0; i < spKeys.size(); ++i) spResults[i] = RESULT_T (MapResult<K, V> {});
+        return 0;
+    }
+
+    /* Rolling window: key i + SEARCH_BATCH_SIZE is hashed and prefetched while key i is probed,
+     * so up to SEARCH_BATCH_SIZE bucket loads are in flight instead of one at a time. */
+    const usize mask = usize(m_vBuckets.cap() - 1);
+    usize aHashes[SEARCH_BATCH_SIZE];
+    isize nFound = 0;
+
+    auto clPrefetch = [&](isize i) {
+        const usize h = FN_HASH(spKeys[i]);
+        aHashes[i & (SEARCH_BATCH_SIZE - 1)] = h;
+        utils::prefetch(&m_vBuckets.m_pData[h & mask]);
+    };
+
+    const isize nAhead = utils::min(SEARCH_BATCH_SIZE, spKeys.size());
+    for (isize i = 0; i < nAhead; ++i) clPrefetch(i);
+
+    for (isize i = 0; i < spKeys.size(); ++i)
+    {
+        const usize h = aHashes[i & (SEARCH_BATCH_SIZE - 1)];
+        if (i + SEARCH_BATCH_SIZE < spKeys.size()) clPrefetch(i + SEARCH_BATCH_SIZE);
+
+        const MapResult<K, V> res = searchHashed(spKeys[i], h);
+        nFound += res.eStatus == MAP_RESULT_STATUS::FOUND;
+        spResults[i] = RESULT_T (res);
+    }
+
+    return nFound;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+[[nodiscard]] inline MapResult<K, V>
+Map<K, V, FN_HASH>::search(const StringView sv) const requires(HETEROGENEOUS)
+{
+    return searchHashedAs(sv, hash::func(sv));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+[[nodiscard]] inline MapResult<K, V>
+Map<K, V, FN_HASH>::searchHashed(const StringView sv, usize keyHash) const requires(HETEROGENEOUS)
+{
+    return searchHashedAs(sv, keyHash);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline bool
+Map<K, V, FN_HASH>::bucketHashEq([[maybe_unused]] const MapBucket<K, V>& bucket, [[maybe_unused]] usize hash)
+{
+    if constexpr (MapBucket<K, V>::STORE_HASH) return bucket.hash == hash;
+    else return true;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline usize
+Map<K, V, FN_HASH>::bucketHash(const MapBucket<K, V>& bucket)
+{
+    if constexpr (MapBucket<K, V>::STORE_HASH) return bucket.hash;
+    else return FN_HASH(bucket.key);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename KEY_T>
+inline MapResult<K, V>
+Map<K, V, FN_HASH>::searchHashedAs(const KEY_T& key, usize keyHash) const
 {
     MapResult<K, V> res {.eStatus = MAP_RESULT_STATUS::NOT_FOUND};
 
@@ -461,11 +631,9 @@ Map<K, V, FN_HASH>::searchHashed(const K& key, usize keyHash) const
     isize idx = isize(keyHash & usize(m_vBuckets.cap() - 1));
     res.hash = keyHash;
 
-    while (m_vBuckets[idx].eFlags != MAP_BUCKET_FLAGS::NONE) /* deleted or occupied */
+    while (m_vBuckets[idx].eFlags == MAP_BUCKET_FLAGS::OCCUPIED)
     {
-        if (m_vBuckets[idx].eFlags != MAP_BUCKET_FLAGS::DELETED &&
-            m_vBuckets[idx].key == key
-        )
+        if (bucketHashEq(m_vBuckets[idx], keyHash) && m_vBuckets[idx].key == key)
         {
             res.pData = const_cast<MapBucket<K, V>*>(&m_vBuckets[idx]);
             res.eStatus = MAP_RESULT_STATUS::FOUND;
@@ -494,7 +662,7 @@ Map<K, V, FN_HASH>::insertionIdx(usize hash, const K& key) const
 
     while (m_vBuckets[idx].eFlags == MAP_BUCKET_FLAGS::OCCUPIED)
     {
-        if (m_vBuckets[idx].key == key) break;
+        if (bucketHashEq(m_vBuckets[idx], hash) && m_vBuckets[idx].key == key) break;
 
 #if !defined NDEBUG && defined ADT_DBG_COLLISIONS
         LogWarn("collision at: {} (keys: '{}' and '{}'), nCollisions: {}\n", idx, key, m_vBuckets[idx].key, m_nCollisions++);
@@ -506,7 +674,8 @@ Map<K, V, FN_HASH>::insertionIdx(usize hash, const K& key) const
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
-Map<K, V, FN_HASH>::Map(IAllocator* pAllocator, isize prealloc, f32 loadFactor)
+template<IsAllocator ALLOC>
+Map<K, V, FN_HASH>::Map(ALLOC* pAllocator, isize prealloc, f32 loadFactor)
     : m_vBuckets {pAllocator, nextPowerOf2(isize(prealloc / loadFactor))},
       m_nOccupied {},
       m_maxLoadFactor {loadFactor}
@@ -516,7 +685,8 @@ Map<K, V, FN_HASH>::Map(IAllocator* pAllocator, isize prealloc, f32 loadFactor)
 }
 
 template<typename K, typename V, usize (*FN_HASH)(const K&)>
-Map<K, V, FN_HASH>::Map(IAllocator* pAllocator, std::initializer_list<Pair<K, V>> lPairs)
+template<IsAllocator ALLOC>
+Map<K, V, FN_HASH>::Map(ALLOC* pAllocator, std::initializer_list<Pair<K, V>> lPairs)
     : m_vBuckets {pAllocator, nextPowerOf2(isize(lPairs.size() / MAP_DEFAULT_LOAD_FACTOR))},
       m_nOccupied {},
       m_maxLoadFactor {MAP_DEFAULT_LOAD_FACTOR}
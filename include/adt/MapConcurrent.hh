@@ -0,0 +1,229 @@
+#pragma once
+
+#include "Map.hh"
+#include "Opt.hh"
+#include "ThreadPool.hh"
+
+#include <bit>
+
+namespace adt
+{
+
+/* Map split into power of two shards, each behind its own RWLock.
+ * Lookups take a shared lock on one shard, inserts and removals take an exclusive one.
+ * Values are returned by copy, so nothing points into a shard after its lock is released.
+ * Shards allocate from multiple threads: the allocator must be thread safe (Gpa, MiMalloc). */
+template<typename K, typename V, usize (*FN_HASH)(const K&) = hash::func<K>>
+struct MapConcurrent
+{
+    static constexpr isize DEFAULT_N_SHARDS = 16;
+
+    struct Shard
+    {
+        RWLock lock {};
+        Map<K, V, FN_HASH> map {};
+        char aPad[CACHELINE_SIZE] {}; /* Don't share cache lines between locks of neighbour shards. */
+    };
+
+    /* */
+
+    Span<Shard> m_spShards {};
+    u32 m_shardShift {}; /* 32 - log2(nShards). */
+
+    /* */
+
+    MapConcurrent() = default;
+    MapConcurrent(IAllocator* p, isize prealloc = SIZE_MIN, isize nShards = DEFAULT_N_SHARDS);
+
+    /* */
+
+    [[nodiscard]] isize nShards() const noexcept { return m_spShards.size(); }
+
+    [[nodiscard]] isize shardI(usize keyHash) const noexcept;
+
+    [[nodiscard]] Opt<V> search(const K& key) const;
+    [[nodiscard]] Opt<V> searchHashed(const K& key, usize keyHash) const;
+
+    [[nodiscard]] bool contains(const K& key) const;
+
+    MAP_RESULT_STATUS insert(IAllocator* p, const K& key, const V& val); /* Overwrites existing value. */
+
+    template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+    MAP_RESULT_STATUS tryEmplace(IAllocator* p, const K& key, ARGS&&... args); /* Keeps existing value. */
+
+    template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+    MAP_RESULT_STATUS tryEmplaceHashed(IAllocator* p, const K& key, usize keyHash, ARGS&&... args);
+
+    bool tryRemove(const K& key);
+
+    [[nodiscard]] isize size() const; /* Approximate with concurrent writers. */
+
+    /* Shard per task, clVisit(KeyVal<K, V>&) runs concurrently on different shards under exclusive locks. */
+    template<typename CL>
+    void forEach(IThreadPool* pTp, const CL& clVisit);
+
+    void destroy(IAllocator* p) noexcept;
+};
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline
+MapConcurrent<K, V, FN_HASH>::MapConcurrent(IAllocator* p, isize prealloc, isize nShards)
+{
+    ADT_ASSERT(nShards > 0 && isPowerOf2(nShards), "nShards: {}", nShards);
+
+    m_spShards = {p->mallocV<Shard>(nShards), nShards};
+    m_shardShift = 32 - std::countr_zero(u64(nShards));
+
+    const isize shardPrealloc = utils::max(prealloc / nShards, SIZE_MIN);
+    for (auto& shard : m_spShards)
+        new(&shard) Shard {.lock = RWLock {INIT}, .map = Map<K, V, FN_HASH> {p, shardPrealloc}};
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline isize
+MapConcurrent<K, V, FN_HASH>::shardI(usize keyHash) const noexcept
+{
+    /* Shards take the high bits of a fibonacci mix, Map buckets take the low bits of the hash. */
+    const u32 mixed = (u32(keyHash) ^ u32(keyHash >> 32)) * 0x9e3779b9u;
+    return isize(u64(mixed) >> m_shardShift);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline Opt<V>
+MapConcurrent<K, V, FN_HASH>::search(const K& key) const
+{
+    return searchHashed(key, FN_HASH(key));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline Opt<V>
+MapConcurrent<K, V, FN_HASH>::searchHashed(const K& key, usize keyHash) const
+{
+    Shard& shard = const_cast<Shard&>(m_spShards[shardI(keyHash)]);
+    LockSharedScope lock {&shard.lock};
+
+    if (auto found = shard.map.searchHashed(key, keyHash))
+        return found.value();
+
+    return {};
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline bool
+MapConcurrent<K, V, FN_HASH>::contains(const K& key) const
+{
+    const usize keyHash = FN_HASH(key);
+    Shard& shard = const_cast<Shard&>(m_spShards[shardI(keyHash)]);
+    LockSharedScope lock {&shard.lock};
+
+    return bool(shard.map.searchHashed(key, keyHash));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline MAP_RESULT_STATUS
+MapConcurrent<K, V, FN_HASH>::insert(IAllocator* p, const K& key, const V& val)
+{
+    const usize keyHash = FN_HASH(key);
+    Shard& shard = m_spShards[shardI(keyHash)];
+    LockScope lock {&shard.lock};
+
+    return shard.map.emplaceHashed(p, key, keyHash, val).eStatus;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+inline MAP_RESULT_STATUS
+MapConcurrent<K, V, FN_HASH>::tryEmplace(IAllocator* p, const K& key, ARGS&&... args)
+{
+    return tryEmplaceHashed(p, key, FN_HASH(key), std::forward<ARGS>(args)...);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+inline MAP_RESULT_STATUS
+MapConcurrent<K, V, FN_HASH>::tryEmplaceHashed(IAllocator* p, const K& key, usize keyHash, ARGS&&... args)
+{
+    Shard& shard = m_spShards[shardI(keyHash)];
+
+    {
+        /* Most calls find the key, don't block other readers for them. */
+        LockSharedScope lock {&shard.lock};
+        if (shard.map.searchHashed(key, keyHash)) return MAP_RESULT_STATUS::FOUND;
+    }
+
+    LockScope lock {&shard.lock};
+
+    if (shard.map.searchHashed(key, keyHash)) return MAP_RESULT_STATUS::FOUND;
+    return shard.map.emplaceHashed(p, key, keyHash, std::forward<ARGS>(args)...).eStatus;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline bool
+MapConcurrent<K, V, FN_HASH>::tryRemove(const K& key)
+{
+    const usize keyHash = FN_HASH(key);
+    Shard& shard = m_spShards[shardI(keyHash)];
+    LockScope lock {&shard.lock};
+
+    auto found = shard.map.searchHashed(key, keyHash);
+    if (!found) return false;
+
+    shard.map.remove(shard.map.idx(found));
+    return true;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline isize
+MapConcurrent<K, V, FN_HASH>::size() const
+{
+    isize n = 0;
+    for (auto& shard : m_spShards)
+    {
+        LockSharedScope lock {const_cast<RWLock*>(&shard.lock)};
+        n += shard.map.size();
+    }
+
+    return n;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename CL>
+inline void
+MapConcurrent<K, V, FN_HASH>::forEach(IThreadPool* pTp, const CL& clVisit)
+{
+    atomic::Int atomNLeft {int(m_spShards.size())};
+    IThreadPool::Future<void> fut {pTp};
+
+    for (isize i = 0; i < m_spShards.size(); ++i)
+    {
+        pTp->addRetry([this, i, &clVisit, &atomNLeft, &fut] {
+            Shard& shard = m_spShards[i];
+
+            {
+                LockScope lock {&shard.lock};
+                for (auto& kv : shard.map) clVisit(kv);
+            }
+
+            if (atomNLeft.fetchSub(1, atomic::ORDER::ACQ_REL) == 1)
+                fut.signal();
+        });
+    }
+
+    fut.wait();
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline void
+MapConcurrent<K, V, FN_HASH>::destroy(IAllocator* p) noexcept
+{
+    for (auto& shard : m_spShards)
+    {
+        shard.map.destroy(p);
+        shard.lock.destroy();
+    }
+
+    p->freeV(m_spShards.data(), m_spShards.size());
+    *this = {};
+}
+
+} /* namespace adt */
@@ -0,0 +1,616 @@
+/* Hashmap with SwissTable-style control bytes.
+ * Control bytes live in their own array: 7 bits of the hash for occupied slots, EMPTY or DELETED otherwise.
+ * Probing compares 16 control bytes at once and touches the key/value slots only on 7-bit hash matches.
+ * Same interface as Map (MapResult::pData points to a KeyVal here, don't look at eFlags). */
+
+#pragma once
+
+#include "Map.hh"
+
+#ifdef ADT_SSE4_2
+    #include <emmintrin.h>
+#endif
+
+#include <bit>
+
+namespace adt
+{
+
+constexpr f32 MAP_SWISS_DEFAULT_LOAD_FACTOR = 0.875f;
+
+namespace details
+{
+
+struct MapSwissGroup
+{
+    static constexpr isize SIZE = 16;
+
+    static constexpr i8 EMPTY = -128; /* 0b10000000 */
+    static constexpr i8 DELETED = -2; /* 0b11111110 */
+    /* Occupied: 0b0xxxxxxx. */
+
+    /* */
+
+#ifdef ADT_SSE4_2
+    __m128i m_ctrl;
+#else
+    i8 m_aCtrl[SIZE];
+#endif
+
+    /* */
+
+    explicit MapSwissGroup(const i8* pCtrl) noexcept;
+
+    /* */
+
+    u32 match(i8 h2) const noexcept; /* Bitmask of slots with this control byte. */
+    u32 matchEmpty() const noexcept { return match(EMPTY); }
+    u32 matchEmptyOrDeleted() const noexcept; /* Sign bit set. */
+    u32 matchOccupied() const noexcept { return ~matchEmptyOrDeleted() & 0xffff; }
+};
+
+inline
+MapSwissGroup::MapSwissGroup(const i8* pCtrl) noexcept
+{
+#ifdef ADT_SSE4_2
+    m_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pCtrl));
+#else
+    ::memcpy(m_aCtrl, pCtrl, SIZE);
+#endif
+}
+
+inline u32
+MapSwissGroup::match(i8 h2) const noexcept
+{
+#ifdef ADT_SSE4_2
+    return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(h2))));
+#else
+    u32 mask = 0;
+    for (isize i = 0; i < SIZE; ++i)
+        mask |= u32(m_aCtrl[i] == h2) << i;
+    return mask;
+#endif
+}
+
+inline u32
+MapSwissGroup::matchEmptyOrDeleted() const noexcept
+{
+#ifdef ADT_SSE4_2
+    return u32(_mm_movemask_epi8(m_ctrl));
+#else
+    u32 mask = 0;
+    for (isize i = 0; i < SIZE; ++i)
+        mask |= u32(m_aCtrl[i] < 0) << i;
+    return mask;
+#endif
+}
+
+} /* namespace details */
+
+template<typename K, typename V, usize (*FN_HASH)(const K&) = hash::func<K>>
+struct MapSwiss
+{
+    using Group = details::MapSwissGroup;
+
+    /* */
+
+    i8* m_pCtrl {};
+    KeyVal<K, V>* m_pSlots {};
+    isize m_cap {};
+    isize m_nOccupied {};
+    isize m_growthLeft {}; /* Empty slots we can still fill before rehashing (tombstones don't count). */
+    f32 m_maxLoadFactor {};
+
+    /* */
+
+    MapSwiss() = default;
+    MapSwiss(IAllocator* pAllocator, isize prealloc = SIZE_MIN, f32 loadFactor = MAP_SWISS_DEFAULT_LOAD_FACTOR);
+    MapSwiss(IAllocator* pAllocator, std::initializer_list<Pair<K, V>> lPairs);
+
+    /* */
+
+    [[nodiscard]] bool empty() const { return m_nOccupied <= 0; }
+
+    [[nodiscard]] isize idx(const KeyVal<K, V>* p) const;
+
+    [[nodiscard]] isize idx(const MapResult<K, V> res) const;
+
+    [[nodiscard]] isize firstI() const;
+
+    [[nodiscard]] isize nextI(isize i) const;
+
+    [[nodiscard]] f32 loadFactor() const;
+
+    MapResult<K, V> insert(IAllocator* p, const K& key, const V& val);
+    MapResult<K, V> insert(IAllocator* p, const K& key, V&& val);
+
+    template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+    MapResult<K, V> emplace(IAllocator* p, const K& key, ARGS&&... args);
+
+    template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+    MapResult<K, V> emplaceHashed(IAllocator* p, const K& key, const usize keyHash, ARGS&&... args);
+
+    [[nodiscard]] MapResult<K, V> search(const K& key);
+    [[nodiscard]] const MapResult<K, V> search(const K& key) const;
+
+    [[nodiscard]] MapResult<K, V> searchHashed(const K& key, usize keyHash) const;
+
+    void remove(isize i);
+
+    void remove(const K& key);
+
+    bool tryRemove(const K& key);
+
+    MapResult<K, V> tryInsert(IAllocator* p, const K& key, const V& val);
+    MapResult<K, V> tryInsert(IAllocator* p, const K& key, V&& val);
+
+    template<typename ...ARGS>
+    MapResult<K, V> tryEmplace(IAllocator* p, const K& key, ARGS&&... args);
+
+    void destroy(IAllocator* p) noexcept;
+
+    [[nodiscard]] MapSwiss release() noexcept;
+
+    [[nodiscard]] isize cap() const { return m_cap; }
+
+    [[nodiscard]] isize size() const { return m_nOccupied; }
+
+    void rehash(IAllocator* p, isize size);
+
+    /* */
+
+protected:
+    static constexpr i8 h2(usize hash) { return i8(hash & 0x7f); }
+    static constexpr usize h1(usize hash) { return hash >> 7; }
+
+    isize maxGrowth() const { return isize(f32(m_cap) * m_maxLoadFactor); }
+
+    /* First EMPTY or DELETED slot on the probe sequence. */
+    isize insertionIdx(usize hash) const;
+
+    MapResult<K, V> makeResult(isize i, usize hash, MAP_RESULT_STATUS eStatus) const;
+
+    /* Same capacity rehash in place: tombstones become EMPTY, occupied slots move to their first free slot. */
+    void dropDeletes();
+
+    /* */
+
+public:
+    template<typename P_MAP>
+    struct It
+    {
+        P_MAP s {};
+        isize i = 0;
+
+        It(P_MAP self, isize _i) : s(self), i(_i) {}
+
+        KeyVal<K, V>& operator*() { return s->m_pSlots[i]; }
+        KeyVal<K, V>* operator->() { return &s->m_pSlots[i]; }
+
+        It
+        operator++()
+        {
+            i = s->nextI(i);
+            return {s, i};
+        }
+
+        friend bool operator==(const It& l, const It& r) { return l.i == r.i; }
+        friend bool operator!=(const It& l, const It& r) { return l.i != r.i; }
+    };
+
+    It<MapSwiss*> begin() { return {this, firstI()}; }
+    It<MapSwiss*> end() { return {this, NPOS}; }
+
+    const It<const MapSwiss*> begin() const { return {this, firstI()}; }
+    const It<const MapSwiss*> end() const { return {this, NPOS}; }
+};
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline
+MapSwiss<K, V, FN_HASH>::MapSwiss(IAllocator* pAllocator, isize prealloc, f32 loadFactor)
+    : m_cap {utils::max(Group::SIZE, nextPowerOf2(isize(prealloc / loadFactor)))},
+      m_maxLoadFactor {loadFactor}
+{
+    ADT_ASSERT(isPowerOf2(m_cap), "{}", m_cap);
+    ADT_ASSERT(loadFactor > 0.0f && loadFactor < 1.0f, "loadFactor: {}", loadFactor);
+
+    m_pCtrl = pAllocator->mallocV<i8>(m_cap);
+    ::memset(m_pCtrl, Group::EMPTY, m_cap);
+    m_pSlots = pAllocator->mallocV<KeyVal<K, V>>(m_cap);
+    m_growthLeft = maxGrowth();
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline
+MapSwiss<K, V, FN_HASH>::MapSwiss(IAllocator* pAllocator, std::initializer_list<Pair<K, V>> lPairs)
+    : MapSwiss(pAllocator, lPairs.size())
+{
+    for (auto& pair : lPairs)
+        emplace(pAllocator, pair.first, pair.second);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline isize
+MapSwiss<K, V, FN_HASH>::idx(const KeyVal<K, V>* p) const
+{
+    isize r = p - m_pSlots;
+    ADT_ASSERT(r >= 0 && r < m_cap, "out of range, r: {}, cap: {}", r, m_cap);
+    return r;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline isize
+MapSwiss<K, V, FN_HASH>::idx(const MapResult<K, V> res) const
+{
+    return idx(reinterpret_cast<const KeyVal<K, V>*>(res.pData));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline isize
+MapSwiss<K, V, FN_HASH>::firstI() const
+{
+    return nextI(-1);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline isize
+MapSwiss<K, V, FN_HASH>::nextI(isize i) const
+{
+    ++i;
+    isize groupI = i & ~(Group::SIZE - 1);
+    u32 mask = i < m_cap ? Group {m_pCtrl + groupI}.matchOccupied() & (0xffffu << (i - groupI)) : 0;
+
+    while (mask == 0)
+    {
+        groupI += Group::SIZE;
+        if (groupI >= m_cap) return NPOS;
+        mask = Group {m_pCtrl + groupI}.matchOccupied();
+    }
+
+    return groupI + std::countr_zero(mask);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline f32
+MapSwiss<K, V, FN_HASH>::loadFactor() const
+{
+    ADT_ASSERT(m_cap > 0, "cap: {}", m_cap);
+    return f32(m_nOccupied) / f32(m_cap);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::insert(IAllocator* p, const K& key, const V& val)
+{
+    return emplace(p, key, val);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::insert(IAllocator* p, const K& key, V&& val)
+{
+    return emplace(p, key, std::move(val));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::emplace(IAllocator* p, const K& key, ARGS&&... args)
+{
+    return emplaceHashed(p, key, FN_HASH(key), std::forward<ARGS>(args)...);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>)
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::emplaceHashed(IAllocator* p, const K& key, const usize keyHash, ARGS&&... args)
+{
+    if (m_cap <= 0) *this = {p};
+
+    if (auto found = searchHashed(key, keyHash))
+    {
+        V& val = found.value();
+        utils::destruct(&val);
+        utils::destructiveMove(&val, std::forward<ARGS>(args)...);
+        return {.pData = found.pData, .hash = keyHash, .eStatus = MAP_RESULT_STATUS::FOUND};
+    }
+
+    isize i = insertionIdx(keyHash);
+    if (m_growthLeft <= 0 && m_pCtrl[i] == Group::EMPTY)
+    {
+        /* At least 1/8 of the growth budget is tombstones: clean up in place without allocating, otherwise grow. */
+        if (m_nOccupied <= maxGrowth() - maxGrowth() / 8) dropDeletes();
+        else rehash(p, m_cap * 2);
+        i = insertionIdx(keyHash);
+    }
+
+    if (m_pCtrl[i] == Group::EMPTY) --m_growthLeft;
+    m_pCtrl[i] = h2(keyHash);
+
+    KeyVal<K, V>* pSlot = &m_pSlots[i];
+    new(&pSlot->key) K(key);
+    utils::destructiveMove(&pSlot->val, std::forward<ARGS>(args)...);
+
+    ++m_nOccupied;
+
+    return makeResult(i, keyHash, MAP_RESULT_STATUS::INSERTED);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+[[nodiscard]] inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::search(const K& key)
+{
+    return searchHashed(key, FN_HASH(key));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+[[nodiscard]] inline const MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::search(const K& key) const
+{
+    return searchHashed(key, FN_HASH(key));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+[[nodiscard]] inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::searchHashed(const K& key, usize keyHash) const
+{
+    MapResult<K, V> res {.hash = keyHash, .eStatus = MAP_RESULT_STATUS::NOT_FOUND};
+
+    if (m_nOccupied == 0) return res;
+
+    const isize mask = m_cap - 1;
+    const i8 tag = h2(keyHash);
+    isize groupI = isize(h1(keyHash)) & mask & ~(Group::SIZE - 1);
+
+    /* Triangular steps over whole groups visit every group once. */
+    for (isize step = Group::SIZE; ; step += Group::SIZE)
+    {
+        const Group g {m_pCtrl + groupI};
+
+        for (u32 match = g.match(tag); match; match &= match - 1)
+        {
+            const isize i = groupI + std::countr_zero(match);
+            if (m_pSlots[i].key == key)
+                return makeResult(i, keyHash, MAP_RESULT_STATUS::FOUND);
+        }
+
+        if (g.matchEmpty()) return res;
+
+        groupI = (groupI + step) & mask;
+    }
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline void
+MapSwiss<K, V, FN_HASH>::remove(isize i)
+{
+    ADT_ASSERT(i >= 0 && i < m_cap && m_pCtrl[i] >= 0, "i: {}, cap: {}", i, m_cap);
+
+    utils::destruct(&m_pSlots[i]);
+
+    /* Probes stop at groups with empty slots, so this group doesn't need a tombstone if it has one already. */
+    const isize groupI = i & ~(Group::SIZE - 1);
+    if (Group {m_pCtrl + groupI}.matchEmpty())
+    {
+        m_pCtrl[i] = Group::EMPTY;
+        ++m_growthLeft;
+    }
+    else
+    {
+        m_pCtrl[i] = Group::DELETED;
+    }
+
+    --m_nOccupied;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline void
+MapSwiss<K, V, FN_HASH>::remove(const K& key)
+{
+    auto found = search(key);
+    ADT_ASSERT(found, "not found");
+    remove(idx(found));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline bool
+MapSwiss<K, V, FN_HASH>::tryRemove(const K& key)
+{
+    auto found = search(key);
+    if (found)
+    {
+        remove(idx(found));
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::tryInsert(IAllocator* p, const K& key, const V& val)
+{
+    return tryEmplace(p, key, val);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::tryInsert(IAllocator* p, const K& key, V&& val)
+{
+    return tryEmplace(p, key, std::move(val));
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+template<typename ...ARGS>
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::tryEmplace(IAllocator* p, const K& key, ARGS&&... args)
+{
+    const usize keyHash = FN_HASH(key);
+    auto f = searchHashed(key, keyHash);
+    if (f) return f;
+    else return emplaceHashed(p, key, keyHash, std::forward<ARGS>(args)...);
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline void
+MapSwiss<K, V, FN_HASH>::destroy(IAllocator* p) noexcept
+{
+    if constexpr (!std::is_trivially_destructible_v<KeyVal<K, V>>)
+        for (auto& e : *this)
+            e.~KeyVal<K, V>();
+
+    p->freeV(m_pCtrl, m_cap);
+    p->freeV(m_pSlots, m_cap);
+    *this = {};
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline MapSwiss<K, V, FN_HASH>
+MapSwiss<K, V, FN_HASH>::release() noexcept
+{
+    return utils::exchange(this, {});
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline void
+MapSwiss<K, V, FN_HASH>::rehash(IAllocator* p, isize size)
+{
+    ADT_ASSERT(isPowerOf2(size) && size >= m_cap, "size: {}, cap: {}", size, m_cap);
+
+    MapSwiss mNew {};
+    mNew.m_cap = size;
+    mNew.m_maxLoadFactor = m_maxLoadFactor;
+    mNew.m_pCtrl = p->mallocV<i8>(size);
+    ::memset(mNew.m_pCtrl, Group::EMPTY, size);
+    mNew.m_pSlots = p->mallocV<KeyVal<K, V>>(size);
+
+    /* Keys are unique already, no need to search. */
+    for (auto& kv : *this)
+    {
+        const usize hash = FN_HASH(kv.key);
+        const isize i = mNew.insertionIdx(hash);
+
+        mNew.m_pCtrl[i] = h2(hash);
+        new(&mNew.m_pSlots[i]) KeyVal<K, V> {std::move(kv)};
+        utils::destruct(&kv);
+    }
+
+    mNew.m_nOccupied = m_nOccupied;
+    mNew.m_growthLeft = mNew.maxGrowth() - m_nOccupied;
+
+    p->freeV(m_pCtrl, m_cap);
+    p->freeV(m_pSlots, m_cap);
+    *this = mNew;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline void
+MapSwiss<K, V, FN_HASH>::dropDeletes()
+{
+    /* DELETED -> EMPTY and occupied -> DELETED, DELETED marks slots that are still to be placed. */
+    for (isize i = 0; i < m_cap; ++i)
+        m_pCtrl[i] = m_pCtrl[i] >= 0 ? Group::DELETED : Group::EMPTY;
+
+    for (isize i = 0; i < m_cap; ++i)
+    {
+        if (m_pCtrl[i] != Group::DELETED) continue;
+
+        const usize hash = FN_HASH(m_pSlots[i].key);
+        const isize newI = insertionIdx(hash);
+
+        /* Probes visit whole groups, already in the first group it can be in. */
+        if ((newI & ~(Group::SIZE - 1)) == (i & ~(Group::SIZE - 1)))
+        {
+            m_pCtrl[i] = h2(hash);
+            continue;
+        }
+
+        if (m_pCtrl[newI] == Group::EMPTY)
+        {
+            new(&m_pSlots[newI]) KeyVal<K, V> {std::move(m_pSlots[i])};
+            utils::destruct(&m_pSlots[i]);
+            m_pCtrl[newI] = h2(hash);
+            m_pCtrl[i] = Group::EMPTY;
+        }
+        else
+        {
+            /* Not placed yet: swap and place whatever landed in i next. */
+            KeyVal<K, V> tmp {std::move(m_pSlots[newI])};
+            utils::destruct(&m_pSlots[newI]);
+            new(&m_pSlots[newI]) KeyVal<K, V> {std::move(m_pSlots[i])};
+            utils::destruct(&m_pSlots[i]);
+            new(&m_pSlots[i]) KeyVal<K, V> {std::move(tmp)};
+            m_pCtrl[newI] = h2(hash);
+            --i;
+        }
+    }
+
+    m_growthLeft = maxGrowth() - m_nOccupied;
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline isize
+MapSwiss<K, V, FN_HASH>::insertionIdx(usize hash) const
+{
+    const isize mask = m_cap - 1;
+    isize groupI = isize(h1(hash)) & mask & ~(Group::SIZE - 1);
+
+    for (isize step = Group::SIZE; ; step += Group::SIZE)
+    {
+        if (const u32 freeMask = Group {m_pCtrl + groupI}.matchEmptyOrDeleted())
+            return groupI + std::countr_zero(freeMask);
+
+        groupI = (groupI + step) & mask;
+    }
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&)>
+inline MapResult<K, V>
+MapSwiss<K, V, FN_HASH>::makeResult(isize i, usize hash, MAP_RESULT_STATUS eStatus) const
+{
+    return {
+        .pData = reinterpret_cast<MapBucket<K, V>*>(const_cast<KeyVal<K, V>*>(&m_pSlots[i])),
+        .hash = hash,
+        .eStatus = eStatus,
+    };
+}
+
+template<typename K, typename V, usize (*FN_HASH)(const K&) = hash::func<K>, typename ALLOC_T = GpaNV>
+struct MapSwissManaged : public MapSwiss<K, V, FN_HASH>
+{
+    using Base = MapSwiss<K, V, FN_HASH>;
+
+    /* */
+
+    MapSwissManaged() = default;
+    MapSwissManaged(isize prealloc, f32 loadFactor = MAP_SWISS_DEFAULT_LOAD_FACTOR) : Base::MapSwiss(allocator(), prealloc, loadFactor) {}
+    MapSwissManaged(std::initializer_list<Pair<K, V>> lPairs) : Base::MapSwiss(allocator(), lPairs) {}
+
+    /* */
+
+    auto* allocator() const { return ALLOC_T::inst(); }
+
+    MapResult<K, V> insert(const K& key, const V& val) { return Base::insert(allocator(), key, val); }
+    MapResult<K, V> insert(const K& key, V&& val) { return Base::insert(allocator(), key, std::move(val)); }
+
+    template<typename ...ARGS> requires(std::is_constructible_v<V, ARGS...>) MapResult<K, V> emplace(const K& key, ARGS&&... args)
+    { return Base::emplace(allocator(), key, std::forward<ARGS>(args)...); }
+
+    MapResult<K, V> tryInsert(const K& key, const V& val) { return Base::tryInsert(allocator(), key, val); }
+    MapResult<K, V> tryInsert(const K& key, V&& val) { return Base::tryInsert(allocator(), key, std::move(val)); }
+
+    template<typename ...ARGS>
+    MapResult<K, V> tryEmplace(const K& key, ARGS&&... args)
+    { return Base::tryEmplace(allocator(), key, std::forward<ARGS>(args)...); }
+
+    void destroy() noexcept { Base::destroy(allocator()); }
+
+    MapSwissManaged release() noexcept { return utils::exchange(this, {}); }
+};
+
+template<typename K, typename V, usize (*FN_HASH)(const K&) = hash::func<K>>
+using MapSwissM = MapSwissManaged<K, V, FN_HASH, GpaNV>;
+
+} /* namespace adt */
@@ -19,6 +19,11 @@ struct MiMalloc final : IAllocator
 
     [[nodiscard]] virtual constexpr bool doesFree() const noexcept override final { return true; }
     [[nodiscard]] virtual constexpr bool doesRealloc() const noexcept override final { return true; }
+
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+    virtual void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept override final;
     /* virtual end */
 
     static void free(void* ptr) noexcept;
@@ -43,6 +48,18 @@ struct MiMallocNV final : AllocatorHelperCRTP<MiMallocNV>
     static void free(void* ptr) noexcept
     { MiMalloc::inst()->free(ptr); }
 
+    [[nodiscard]] static void* mallocAligned(usize nBytes, usize alignment) noexcept(false)
+    { return MiMalloc::inst()->mallocAligned(nBytes, alignment); }
+
+    [[nodiscard]] static void* zallocAligned(usize nBytes, usize alignment) noexcept(false)
+    { return MiMalloc::inst()->zallocAligned(nBytes, alignment); }
+
+    [[nodiscard]] static void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false)
+    { return MiMalloc::inst()->reallocAligned(ptr, oldNBytes, newNBytes, alignment); }
+
+    static void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept
+    { MiMalloc::inst()->freeAligned(ptr, nBytes, alignment); }
+
     [[nodiscard]] static constexpr bool doesIndividualFree() noexcept { return true; }
 };
 
@@ -92,6 +109,39 @@ MiMalloc::free(void* ptr) noexcept
     ::mi_free(ptr);
 }
 
+inline void*
+MiMalloc::mallocAligned(usize nBytes, usize alignment)
+{
+    auto* r = ::mi_malloc_aligned(nBytes, alignment);
+    if (!r) [[unlikely]] throw AllocException("MiMalloc::mallocAligned()");
+
+    return r;
+}
+
+inline void*
+MiMalloc::zallocAligned(usize nBytes, usize alignment)
+{
+    auto* r = ::mi_zalloc_aligned(nBytes, alignment);
+    if (!r) [[unlikely]] throw AllocException("MiMalloc::zallocAligned()");
+
+    return r;
+}
+
+inline void*
+MiMalloc::reallocAligned(void* p, usize, usize newNBytes, usize alignment)
+{
+    auto* r = ::mi_realloc_aligned(p, newNBytes, alignment);
+    if (!r) [[unlikely]] throw AllocException("MiMalloc::reallocAligned()");
+
+    return r;
+}
+
+inline void
+MiMalloc::freeAligned(void* p, usize, usize) noexcept
+{
+    ::mi_free(p);
+}
+
 /* very fast general purpose, non thread safe, allocator. freeAll() is supported. */
 struct MiHeap final : IAllocator
 {
@@ -114,6 +164,11 @@ struct MiHeap final : IAllocator
     [[nodiscard]] virtual constexpr bool doesFree() const noexcept override final { return true; }
     [[nodiscard]] virtual constexpr bool doesRealloc() const noexcept override final { return true; }
 
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+    virtual void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept override final;
+
     /* */
 
     void freeAll() noexcept;
@@ -163,6 +218,39 @@ MiHeap::free(void* ptr) noexcept
     ::mi_free(ptr);
 }
 
+inline void*
+MiHeap::mallocAligned(usize nBytes, usize alignment)
+{
+    auto* r = ::mi_heap_malloc_aligned(m_pHeap, nBytes, alignment);
+    if (!r) [[unlikely]] throw AllocException("MiHeap::mallocAligned()");
+
+    return r;
+}
+
+inline void*
+MiHeap::zallocAligned(usize nBytes, usize alignment)
+{
+    auto* r = ::mi_heap_zalloc_aligned(m_pHeap, nBytes, alignment);
+    if (!r) [[unlikely]] throw AllocException("MiHeap::zallocAligned()");
+
+    return r;
+}
+
+inline void*
+MiHeap::reallocAligned(void* p, usize, usize newNBytes, usize alignment)
+{
+    auto* r = ::mi_heap_realloc_aligned(m_pHeap, p, newNBytes, alignment);
+    if (!r) [[unlikely]] throw AllocException("MiHeap::reallocAligned()");
+
+    return r;
+}
+
+inline void
+MiHeap::freeAligned(void* p, usize, usize) noexcept
+{
+    ::mi_free(p);
+}
+
 inline void
 MiHeap::freeAll() noexcept
 {
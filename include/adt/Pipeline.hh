@@ -16,8 +16,8 @@ struct Pipeline
         Queue<void*> qInput {};
         Stage* pNextStage {};
         Pipeline* pThisPipeline {};
-        CndVar cnd {};
-        Mutex mtx {};
+        EventCount ec {};
+        Mutex mtx {}; /* Guards qInput. */
         Thread thrd {};
         i64 stageId {};
 
@@ -28,15 +28,13 @@ struct Pipeline
         Stage(IAllocator* _pAlloc, void (*_pfn)(void*))
             : pAlloc {_pAlloc},
               pfn {_pfn},
-              cnd(INIT),
               mtx(INIT) {}
     };
 
     /* */
 
     Stage* m_pHead {};
-    Mutex m_mtxWait {};
-    CndVar m_cndWait {};
+    EventCount m_ecWait {};
     atomic::Int m_atomBDone {};
     atomic::Int m_atomNEnqueued {};
 
@@ -58,7 +56,6 @@ protected:
 
 inline
 Pipeline::Pipeline(IAllocator* p, std::initializer_list<Stage> stages)
-    : m_mtxWait {INIT}, m_cndWait {INIT}
 {
     Stage** ppCurrNewStage = &m_pHead;
     i64 i = 0;
@@ -91,7 +88,7 @@ Pipeline::add(void* pInput)
         LockScope lock {&m_pHead->mtx};
         m_pHead->qInput.emplaceBack(m_pHead->pAlloc, pInput);
     }
-    m_pHead->cnd.signal();
+    m_pHead->ec.notifyOne();
 }
 
 inline void
@@ -103,9 +100,8 @@ Pipeline::destroy(IAllocator* pAlloc) noexcept
     Stage* pStage = m_pHead;
     while (pStage)
     {
-        pStage->cnd.signal();
+        pStage->ec.notifyAll();
         pStage->thrd.join();
-        pStage->cnd.destroy();
         pStage->mtx.destroy();
         pStage->qInput.destroy(pStage->pAlloc);
 
@@ -114,18 +110,21 @@ Pipeline::destroy(IAllocator* pAlloc) noexcept
 
         pStage = pNext;
     }
-
-    m_mtxWait.destroy();
-    m_cndWait.destroy();
 }
 
 inline void
 Pipeline::wait()
 {
-    LockScope lock {&m_mtxWait};
-
-    while (m_atomNEnqueued.load(atomic::ORDER::ACQUIRE) > 0)
-        m_cndWait.wait(&m_mtxWait);
+    while (true)
+    {
+        const i32 key = m_ecWait.prepareWait();
+        if (m_atomNEnqueued.load(atomic::ORDER::ACQUIRE) <= 0)
+        {
+            m_ecWait.cancelWait();
+            break;
+        }
+        m_ecWait.wait(key);
+    }
 }
 
 inline THREAD_STATUS
@@ -141,15 +140,28 @@ Pipeline::stageLoop(void* pStage)
     {
         void* pPackage {};
 
+        while (true)
         {
-            LockScope inputLock {&stage.mtx};
+            const i32 key = stage.ec.prepareWait();
 
-            while (stage.qInput.empty() && !atomBDone.load(atomic::ORDER::ACQUIRE))
-                stage.cnd.wait(&stage.mtx);
+            if (atomBDone.load(atomic::ORDER::ACQUIRE))
+            {
+                stage.ec.cancelWait();
+                return 0;
+            }
 
-            if (atomBDone.load(atomic::ORDER::ACQUIRE)) return 0;
+            {
+                LockScope inputLock {&stage.mtx};
+                if (!stage.qInput.empty()) pPackage = stage.qInput.popFront();
+            }
+
+            if (pPackage)
+            {
+                stage.ec.cancelWait();
+                break;
+            }
 
-            pPackage = stage.qInput.popFront();
+            stage.ec.wait(key);
         }
 
         ADT_ASSERT(pPackage != nullptr, "");
@@ -163,7 +175,7 @@ Pipeline::stageLoop(void* pStage)
                     LockScope outputLock {&stage.pNextStage->mtx};
                     stage.pNextStage->qInput.emplaceBack(stage.pNextStage->pAlloc, pPackage);
                 }
-                stage.pNextStage->cnd.signal();
+                stage.pNextStage->ec.notifyOne();
             }
             catch (const AllocException& ex)
             {
@@ -172,9 +184,8 @@ Pipeline::stageLoop(void* pStage)
         }
         else
         {
-            pipeline.m_atomNEnqueued.fetchSub(1, atomic::ORDER::RELAXED);
-            if (pipeline.m_atomNEnqueued.load(atomic::ORDER::ACQUIRE) <= 0)
-                pipeline.m_cndWait.signal();
+            if (pipeline.m_atomNEnqueued.fetchSub(1, atomic::ORDER::ACQ_REL) <= 1)
+                pipeline.m_ecWait.notifyAll();
         }
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Array.hh"
+#include "Bitset.hh"
 
 namespace adt
 {
@@ -25,7 +26,7 @@ struct Pool
 
     T m_aSlots[CAP] {};
     Array<Handle, CAP> m_aFreeSlots {};
-    bool m_aOccupied[CAP] {};
+    Bitset<CAP> m_occupied {};
     isize m_nOccupied {};
 
     /* */
@@ -45,6 +46,10 @@ struct Pool
 
     isize idx(const T* const p) const;
 
+    /* cl(T* pFirst, isize firstI, isize count) for every run of consecutive occupied slots. */
+    template<typename CL>
+    void forEachOccupied(CL cl);
+
     [[nodiscard]] Handle insert();
     [[nodiscard]] Handle insert(const T& value); /* push and construct */
 
@@ -135,44 +140,30 @@ template<typename T, isize CAP>
 inline isize
 Pool<T, CAP>::firstI() const
 {
-    if (m_aFreeSlots.size() >= CAP) return -1;
-
-    for (isize i = 0; i < CAP; ++i)
-        if (m_aOccupied[i]) return i;
-
-    return -1;
+    if (m_nOccupied <= 0) return -1;
+    return m_occupied.next(0);
 }
 
 template<typename T, isize CAP>
 inline isize
 Pool<T, CAP>::lastI() const
 {
-    if (m_aFreeSlots.size() >= CAP) return -1;
-
-    for (isize i = CAP - 1; i >= 0; --i)
-        if (m_aOccupied[i]) return i;
-
-    return -1;
+    if (m_nOccupied <= 0) return -1;
+    return m_occupied.prev(CAP - 1);
 }
 
 template<typename T, isize CAP>
 inline isize
 Pool<T, CAP>::nextI(isize i) const
 {
-    do if (++i >= CAP) return -1;
-    while (!m_aOccupied[i]);
-
-    return i;
+    return m_occupied.next(i + 1);
 }
 
 template<typename T, isize CAP>
 inline isize
 Pool<T, CAP>::prevI(isize i) const
 {
-    do if (++i < 0) return -1;
-    while (!m_aOccupied[i]);
-
-    return i;
+    return m_occupied.prev(i - 1);
 }
 
 template<typename T, isize CAP>
@@ -184,6 +175,16 @@ Pool<T, CAP>::idx(const T* const p) const
     return r;
 }
 
+template<typename T, isize CAP>
+template<typename CL>
+inline void
+Pool<T, CAP>::forEachOccupied(CL cl)
+{
+    m_occupied.forEachRun([&](isize firstI, isize count) {
+        cl(&m_aSlots[firstI], firstI, count);
+    });
+}
+
 template<typename T, isize CAP>
 inline typename Pool<T, CAP>::Handle
 Pool<T, CAP>::insert()
@@ -199,7 +200,7 @@ Pool<T, CAP>::insert()
     }
 
     ret = m_aFreeSlots.pop();
-    m_aOccupied[ret.i] = true;
+    m_occupied.set(ret.i);
     ++m_nOccupied;
 
     return ret;
@@ -232,8 +233,8 @@ Pool<T, CAP>::remove(Handle hnd)
     --m_nOccupied;
 
     m_aFreeSlots.push(hnd);
-    ADT_ASSERT(m_aOccupied[hnd.i], "returning unoccupied node");
-    m_aOccupied[hnd.i] = false;
+    ADT_ASSERT(m_occupied[hnd.i], "returning unoccupied node");
+    m_occupied.unset(hnd.i);
 }
 
 template<typename T, isize CAP>
@@ -248,7 +249,7 @@ inline T&
 Pool<T, CAP>::at(Handle h)
 {
     ADT_ASSERT(h.i >= 0 && h.i < CAP, "i: {}, CAP: {}", h.i, CAP);
-    ADT_ASSERT(m_aOccupied[h.i], "trying to access unoccupied node");
+    ADT_ASSERT(m_occupied[h.i], "trying to access unoccupied node");
     return m_aSlots[h.i];
 }
 
@@ -69,6 +69,12 @@ struct PoolAllocator final : public IAllocator
     [[nodiscard]] virtual bool doesFree() const noexcept override final { return true; }
     [[nodiscard]] virtual bool doesRealloc() const noexcept override final { return false; }
 
+    /* Chunks can't be padded: works only if the chunk already has the alignment, throws otherwise. */
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+    virtual void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept override final;
+
     /* */
 
     void freeAll() noexcept;
@@ -164,7 +170,7 @@ PoolAllocator::free(void* p, usize) noexcept
     auto* pBlock = m_pBlocks;
     while (pBlock)
     {
-        if ((u8*)p > (u8*)pBlock->pMem() && ((u8*)pBlock + m_blockCap) > (u8*)p)
+        if ((u8*)p > pBlock->pMem() && (pBlock->pMem() + m_blockCap) > (u8*)p)
             break;
 
         pBlock = pBlock->next;
@@ -177,6 +183,42 @@ PoolAllocator::free(void* p, usize) noexcept
     pBlock->used -= m_chunkSize;
 }
 
+inline void*
+PoolAllocator::mallocAligned(usize nBytes, usize alignment)
+{
+    void* p = malloc(nBytes);
+    if ((usize(p) & (alignment - 1)) != 0)
+    {
+        free(p, nBytes);
+        throw AllocException("PoolAllocator: chunks don't have requested alignment");
+    }
+
+    return p;
+}
+
+inline void*
+PoolAllocator::zallocAligned(usize nBytes, usize alignment)
+{
+    void* p = mallocAligned(nBytes, alignment);
+    memset(p, 0, m_chunkSize - sizeof(Node));
+    return p;
+}
+
+inline void*
+PoolAllocator::reallocAligned(void*, usize, usize, usize)
+{
+    ADT_ASSERT_ALWAYS(false, "realloc() is not supported");
+    throw AllocException("PoolAllocator: realloc() is not supported");
+
+    return nullptr;
+}
+
+inline void
+PoolAllocator::freeAligned(void* p, usize nBytes, usize) noexcept
+{
+    free(p, nBytes);
+}
+
 inline void
 PoolAllocator::freeAll() noexcept
 {
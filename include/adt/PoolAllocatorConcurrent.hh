@@ -0,0 +1,431 @@
+#pragma once
+
+#include "Gpa.hh"
+#include "Thread.hh"
+#include "atomic.hh"
+
+#include <bit>
+#include <cstring>
+
+namespace adt
+{
+
+namespace details
+{
+
+/* Small index of a live thread, released when the thread exits and reused by the next one.
+ * Used to pick a thread's cache inside of PoolAllocatorConcurrent. */
+struct ThreadSlot
+{
+    static constexpr isize MAX = 64;
+
+    static inline atomic::Num<u64> s_atomUsed {};
+
+    /* */
+
+    isize m_i = -1; /* -1: more than MAX live threads. */
+
+    /* */
+
+    ThreadSlot() noexcept;
+    ~ThreadSlot() noexcept;
+
+    /* */
+
+    [[nodiscard]] static isize get() noexcept;
+};
+
+inline
+ThreadSlot::ThreadSlot() noexcept
+{
+    u64 used = s_atomUsed.load(atomic::ORDER::RELAXED);
+    while (~used != 0)
+    {
+        const isize i = std::countr_one(used);
+        if (s_atomUsed.compareExchangeWeak(&used, used | (u64(1) << i), atomic::ORDER::ACQUIRE, atomic::ORDER::RELAXED))
+        {
+            m_i = i;
+            break;
+        }
+    }
+}
+
+inline
+ThreadSlot::~ThreadSlot() noexcept
+{
+    if (m_i < 0) return;
+
+    /* Release: the next owner of the slot sees everything this thread did to its caches. */
+    u64 used = s_atomUsed.load(atomic::ORDER::RELAXED);
+    while (!s_atomUsed.compareExchangeWeak(&used, used & ~(u64(1) << m_i), atomic::ORDER::RELEASE, atomic::ORDER::RELAXED))
+        ;
+}
+
+inline isize
+ThreadSlot::get() noexcept
+{
+    static thread_local ThreadSlot stl_slot {};
+    return stl_slot.m_i;
+}
+
+} /* namespace details */
+
+/* Thread safe fixed byte size (chunk) allocator. Calling realloc() is an error.
+ * Each thread keeps two magazines (small stacks of free chunks) and only touches shared state when both run out
+ * (or fill up): then it swaps a whole magazine with the lock-free depot. Blocks come from the back allocator under a mutex.
+ * Chunks can be freed from any thread. Chunks cached by a thread that exited stay in its slot for the next thread. */
+struct PoolAllocatorConcurrent final : public IAllocator
+{
+    static constexpr isize MAGAZINE_CAP = 64;
+
+    struct Magazine
+    {
+        atomic::Num<Magazine*> atomNext {}; /* Depot link, can be read by a racing pop(). */
+        Magazine* pNextAll {}; /* Every magazine ever allocated, for freeAll(). */
+        isize size {};
+        void* aChunks[MAGAZINE_CAP];
+    };
+
+    /* Lock-free stack (Treiber), top pointer is tagged with a counter in the high 16 bits against ABA.
+     * Magazines are never freed until freeAll(), so a racing pop() can always read the top's link. */
+    struct MagazineStack
+    {
+        static constexpr u64 PTR_MASK = (u64(1) << 48) - 1;
+
+        atomic::Num<u64> atomTop {};
+
+        /* */
+
+        void push(Magazine* p) noexcept;
+        [[nodiscard]] Magazine* pop() noexcept;
+    };
+
+    struct ThreadCache
+    {
+        Magazine* pLoaded {};
+        Magazine* pPrevious {};
+        char aPad[CACHELINE_SIZE - sizeof(Magazine*) * 2] {}; /* Caches of different threads don't share lines. */
+    };
+
+    struct Block
+    {
+        Block* next = nullptr;
+        usize size = 0;
+
+        /* */
+
+        u8* pMem() noexcept { return ((u8*)this) + alignUpPO2(sizeof(*this), 16); } /* 'Flexible array member'. */
+    };
+
+    /* */
+
+    usize m_chunkSize = 0;
+    usize m_blockCap = 0;
+    IAllocator* m_pBackAlloc {};
+
+    Mutex m_mtx {}; /* Guards everything down to m_stackFull. */
+    Block* m_pBlocks {};
+    u8* m_pBump {};
+    u8* m_pBumpEnd {};
+    void* m_pFreeList {}; /* Chunks freed by threads without a slot. */
+    Magazine* m_pMagazines {};
+
+    MagazineStack m_stackFull {};
+    MagazineStack m_stackEmpty {};
+
+    void* m_pCachesMem {};
+    ThreadCache* m_pCaches {}; /* [details::ThreadSlot::MAX]. */
+
+    /* */
+
+    PoolAllocatorConcurrent() = default;
+    PoolAllocatorConcurrent(usize chunkSize, usize blockSize, IAllocator* pBackAlloc = Gpa::inst()) noexcept(false);
+
+    /* */
+
+    [[nodiscard]] virtual void* malloc(usize nBytes) noexcept(false) override final;
+    [[nodiscard]] virtual void* zalloc(usize nBytes) noexcept(false) override final;
+    ADT_WARN_IMPOSSIBLE_OPERATION virtual void* realloc(void* ptr, usize oldNBytes, usize newNBytes) noexcept(false) override final;
+    void virtual free(void* ptr, usize nBytes) noexcept override final;
+
+    [[nodiscard]] virtual bool doesFree() const noexcept override final { return true; }
+    [[nodiscard]] virtual bool doesRealloc() const noexcept override final { return false; }
+
+    /* Chunks can't be padded: works only if the chunk already has the alignment, throws otherwise. */
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+    virtual void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept override final;
+
+    /* */
+
+    void freeAll() noexcept; /* Not thread safe, nothing may use the pool after. */
+
+    /* */
+
+private:
+    [[nodiscard]] void* mallocRefill(ThreadCache* pCache);
+    void freeSpill(ThreadCache* pCache, void* p);
+    [[nodiscard]] Magazine* emptyMagazine();
+    void fillFromBlocks(Magazine* pMag); /* Locks. */
+    [[nodiscard]] void* chunkFromBlocks(); /* m_mtx must be locked. */
+};
+
+inline void
+PoolAllocatorConcurrent::MagazineStack::push(Magazine* p) noexcept
+{
+    ADT_ASSERT((u64(p) & ~PTR_MASK) == 0, "pointer doesn't fit in 48 bits: {}", (void*)p);
+
+    u64 top = atomTop.load(atomic::ORDER::RELAXED);
+    u64 newTop;
+    do
+    {
+        p->atomNext.store((Magazine*)(top & PTR_MASK), atomic::ORDER::RELAXED);
+        newTop = u64(p) | ((top & ~PTR_MASK) + (PTR_MASK + 1));
+    }
+    while (!atomTop.compareExchangeWeak(&top, newTop, atomic::ORDER::RELEASE, atomic::ORDER::RELAXED));
+}
+
+inline PoolAllocatorConcurrent::Magazine*
+PoolAllocatorConcurrent::MagazineStack::pop() noexcept
+{
+    u64 top = atomTop.load(atomic::ORDER::ACQUIRE);
+    while (true)
+    {
+        auto* p = (Magazine*)(top & PTR_MASK);
+        if (!p) return nullptr;
+
+        const u64 newTop = u64(p->atomNext.load(atomic::ORDER::RELAXED)) | ((top & ~PTR_MASK) + (PTR_MASK + 1));
+        if (atomTop.compareExchangeWeak(&top, newTop, atomic::ORDER::ACQUIRE, atomic::ORDER::ACQUIRE))
+            return p;
+    }
+}
+
+inline
+PoolAllocatorConcurrent::PoolAllocatorConcurrent(usize chunkSize, usize blockSize, IAllocator* pBackAlloc)
+    : m_chunkSize {alignUp8(utils::max(chunkSize, usize(sizeof(void*))))},
+      m_pBackAlloc {pBackAlloc},
+      m_mtx {Mutex::TYPE::PLAIN}
+{
+    m_blockCap = utils::max(alignUp(blockSize, m_chunkSize), m_chunkSize * usize(MAGAZINE_CAP));
+
+    const usize cachesSize = sizeof(ThreadCache) * details::ThreadSlot::MAX + CACHELINE_SIZE;
+    m_pCachesMem = m_pBackAlloc->zalloc(cachesSize);
+    m_pCaches = (ThreadCache*)alignUpPO2(usize(m_pCachesMem), CACHELINE_SIZE);
+}
+
+inline void*
+PoolAllocatorConcurrent::malloc(usize)
+{
+    const isize slotI = details::ThreadSlot::get();
+    if (slotI < 0) [[unlikely]]
+    {
+        LockScope lock {&m_mtx};
+        if (m_pFreeList)
+        {
+            void* p = m_pFreeList;
+            m_pFreeList = *(void**)p;
+            return p;
+        }
+        return chunkFromBlocks();
+    }
+
+    ThreadCache* pCache = &m_pCaches[slotI];
+    Magazine* pLoaded = pCache->pLoaded;
+    if (pLoaded && pLoaded->size > 0) [[likely]]
+        return pLoaded->aChunks[--pLoaded->size];
+
+    return mallocRefill(pCache);
+}
+
+inline void*
+PoolAllocatorConcurrent::zalloc(usize)
+{
+    void* p = malloc(0);
+    memset(p, 0, m_chunkSize);
+    return p;
+}
+
+inline void*
+PoolAllocatorConcurrent::realloc(void*, usize, usize)
+{
+    ADT_ASSERT_ALWAYS(false, "realloc() is not supported");
+    throw AllocException("PoolAllocatorConcurrent: realloc() is not supported");
+
+    return nullptr;
+}
+
+inline void
+PoolAllocatorConcurrent::free(void* p, usize) noexcept
+{
+    if (!p) return;
+
+    const isize slotI = details::ThreadSlot::get();
+    if (slotI < 0) [[unlikely]]
+    {
+        LockScope lock {&m_mtx};
+        *(void**)p = m_pFreeList;
+        m_pFreeList = p;
+        return;
+    }
+
+    ThreadCache* pCache = &m_pCaches[slotI];
+    Magazine* pLoaded = pCache->pLoaded;
+    if (pLoaded && pLoaded->size < MAGAZINE_CAP) [[likely]]
+    {
+        pLoaded->aChunks[pLoaded->size++] = p;
+        return;
+    }
+
+    freeSpill(pCache, p);
+}
+
+inline void*
+PoolAllocatorConcurrent::mallocRefill(ThreadCache* pCache)
+{
+    if (pCache->pPrevious && pCache->pPrevious->size > 0)
+    {
+        utils::swap(&pCache->pLoaded, &pCache->pPrevious);
+    }
+    else if (Magazine* pFull = m_stackFull.pop())
+    {
+        if (pCache->pPrevious) m_stackEmpty.push(pCache->pPrevious);
+        pCache->pPrevious = pCache->pLoaded;
+        pCache->pLoaded = pFull;
+    }
+    else
+    {
+        if (!pCache->pLoaded) pCache->pLoaded = emptyMagazine();
+        fillFromBlocks(pCache->pLoaded);
+    }
+
+    return pCache->pLoaded->aChunks[--pCache->pLoaded->size];
+}
+
+inline void
+PoolAllocatorConcurrent::freeSpill(ThreadCache* pCache, void* p)
+{
+    if (pCache->pPrevious && pCache->pPrevious->size < MAGAZINE_CAP)
+    {
+        utils::swap(&pCache->pLoaded, &pCache->pPrevious);
+    }
+    else
+    {
+        /* Both are full (or missing): the previous one goes to the depot for other threads. */
+        if (pCache->pPrevious) m_stackFull.push(pCache->pPrevious);
+        pCache->pPrevious = pCache->pLoaded;
+        pCache->pLoaded = emptyMagazine();
+    }
+
+    pCache->pLoaded->aChunks[pCache->pLoaded->size++] = p;
+}
+
+inline PoolAllocatorConcurrent::Magazine*
+PoolAllocatorConcurrent::emptyMagazine()
+{
+    if (Magazine* p = m_stackEmpty.pop()) return p;
+
+    LockScope lock {&m_mtx};
+
+    auto* p = m_pBackAlloc->alloc<Magazine>();
+    p->pNextAll = m_pMagazines;
+    m_pMagazines = p;
+
+    return p;
+}
+
+inline void
+PoolAllocatorConcurrent::fillFromBlocks(Magazine* pMag)
+{
+    LockScope lock {&m_mtx};
+
+    while (pMag->size < MAGAZINE_CAP && m_pFreeList)
+    {
+        pMag->aChunks[pMag->size++] = m_pFreeList;
+        m_pFreeList = *(void**)m_pFreeList;
+    }
+
+    while (pMag->size < MAGAZINE_CAP)
+        pMag->aChunks[pMag->size++] = chunkFromBlocks();
+}
+
+inline void*
+PoolAllocatorConcurrent::chunkFromBlocks()
+{
+    if (m_pBump + m_chunkSize > m_pBumpEnd)
+    {
+        ADT_ASSERT(m_pBackAlloc, "uninitialized: m_pBackAlloc == nullptr");
+
+        const usize total = m_blockCap + alignUpPO2(sizeof(Block), 16);
+        auto* pBlock = (Block*)m_pBackAlloc->malloc(total);
+        pBlock->next = m_pBlocks;
+        pBlock->size = total;
+        m_pBlocks = pBlock;
+
+        m_pBump = pBlock->pMem();
+        m_pBumpEnd = m_pBump + m_blockCap;
+    }
+
+    void* p = m_pBump;
+    m_pBump += m_chunkSize;
+    return p;
+}
+
+inline void*
+PoolAllocatorConcurrent::mallocAligned(usize nBytes, usize alignment)
+{
+    void* p = malloc(nBytes);
+    if ((usize(p) & (alignment - 1)) != 0)
+    {
+        free(p, nBytes);
+        throw AllocException("PoolAllocatorConcurrent: chunks don't have requested alignment");
+    }
+
+    return p;
+}
+
+inline void*
+PoolAllocatorConcurrent::zallocAligned(usize nBytes, usize alignment)
+{
+    void* p = mallocAligned(nBytes, alignment);
+    memset(p, 0, m_chunkSize);
+    return p;
+}
+
+inline void*
+PoolAllocatorConcurrent::reallocAligned(void*, usize, usize, usize)
+{
+    ADT_ASSERT_ALWAYS(false, "realloc() is not supported");
+    throw AllocException("PoolAllocatorConcurrent: realloc() is not supported");
+
+    return nullptr;
+}
+
+inline void
+PoolAllocatorConcurrent::freeAligned(void* p, usize nBytes, usize) noexcept
+{
+    free(p, nBytes);
+}
+
+inline void
+PoolAllocatorConcurrent::freeAll() noexcept
+{
+    for (Block* p = m_pBlocks, * next = nullptr; p; p = next)
+    {
+        next = p->next;
+        m_pBackAlloc->free(p, p->size);
+    }
+
+    for (Magazine* p = m_pMagazines, * next = nullptr; p; p = next)
+    {
+        next = p->pNextAll;
+        m_pBackAlloc->dealloc(p);
+    }
+
+    m_pBackAlloc->free(m_pCachesMem, sizeof(ThreadCache) * details::ThreadSlot::MAX + CACHELINE_SIZE);
+    m_mtx.destroy();
+
+    *this = {};
+}
+
+} /* namespace adt */
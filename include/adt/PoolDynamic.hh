@@ -0,0 +1,327 @@
+#pragma once
+
+#include "Bitset.hh"
+#include "Vec.hh"
+
+namespace adt
+{
+
+/* Growable reusable resource collection.
+ * Slots live in CHUNK_CAP sized chunks, so addresses stay stable when the pool grows.
+ * Handles carry the slot generation, which is bumped on every remove(), stale handles fail isValid()/tryGet() instead of aliasing a reused slot.
+ * Occupied slots are tracked in a bitmap, iteration skips empty words and finds set bits with countr_zero(). */
+template<typename T, isize CHUNK_CAP = 256>
+struct PoolDynamic
+{
+    static_assert(CHUNK_CAP >= 64 && isPowerOf2(CHUNK_CAP), "CHUNK_CAP must be a power of 2 and cover whole bitmap words");
+
+    static constexpr isize CHUNK_SHIFT = std::countr_zero(usize(CHUNK_CAP));
+    static constexpr isize CHUNK_MASK = CHUNK_CAP - 1;
+
+    struct Handle
+    {
+        using ResourceType = T;
+
+        /* */
+
+        u32 i = NPOS32; /* Slot index. */
+        u32 gen {};
+
+        /* */
+
+        explicit operator bool() const { return i != NPOS32; }
+        friend bool operator==(const Handle l, const Handle r) { return l.i == r.i && l.gen == r.gen; }
+    };
+
+    /* */
+
+    Vec<T*> m_vChunks {};
+    Vec<u32> m_vGens {}; /* Per slot, odd while occupied. */
+    Vec<u64> m_vOccupied {}; /* Bitmap, one bit per slot. */
+    Vec<u32> m_vFreeSlots {}; /* Stack of removed slots, reused first. */
+    isize m_nOccupied {};
+
+    /* */
+
+    PoolDynamic() = default;
+
+    template<IsAllocator ALLOC>
+    PoolDynamic(ALLOC* p, isize prealloc = CHUNK_CAP);
+
+    /* */
+
+    T& operator[](Handle h)             { return at(h); }
+    const T& operator[](Handle h) const { return const_cast<PoolDynamic*>(this)->at(h); }
+
+    [[nodiscard]] bool isValid(Handle h) const noexcept;
+    [[nodiscard]] T* tryGet(Handle h) noexcept; /* nullptr if h is stale or empty. */
+
+    isize firstI() const;
+    isize nextI(isize i) const;
+
+    [[nodiscard]] T& slot(isize i) noexcept { return m_vChunks[i >> CHUNK_SHIFT][i & CHUNK_MASK]; }
+    [[nodiscard]] const T& slot(isize i) const noexcept { return m_vChunks[i >> CHUNK_SHIFT][i & CHUNK_MASK]; }
+    [[nodiscard]] Handle handle(isize i) const noexcept; /* Handle of the occupied slot i. */
+
+    isize idx(const T* const p) const;
+
+    /* cl(T* pFirst, isize firstI, isize count) for every run of consecutive occupied slots, runs are split at chunk ends. */
+    template<typename CL>
+    void forEachOccupied(CL cl);
+
+    template<IsAllocator ALLOC>
+    [[nodiscard]] Handle insert(ALLOC* p, const T& value);
+
+    template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
+    [[nodiscard]] Handle emplace(ALLOC* p, ARGS&&... args);
+
+    void remove(Handle h) noexcept; /* Runs the destructor, h and its copies become stale. */
+    void remove(T* p) noexcept;
+
+    isize cap() const { return m_vChunks.size() * CHUNK_CAP; }
+    isize size() const { return m_nOccupied; }
+
+    bool empty() const { return size() == 0; }
+
+    template<IsAllocator ALLOC>
+    void destroy(ALLOC* p) noexcept;
+
+    /* */
+
+private:
+    T& at(Handle h);
+
+    bool occupied(isize i) const noexcept { return bitset::test(m_vOccupied.data(), i); }
+
+    template<IsAllocator ALLOC>
+    void newChunk(ALLOC* p);
+
+    /* */
+
+public:
+    struct It
+    {
+        PoolDynamic* s {};
+        isize i {};
+
+        /* */
+
+        It(const PoolDynamic* _self, isize _i) : s(const_cast<PoolDynamic*>(_self)), i(_i) {}
+
+        /* */
+
+        auto& operator*() { return s->slot(i); }
+        auto* operator->() { return &s->slot(i); }
+
+        It
+        operator++()
+        {
+            i = s->nextI(i);
+            return {s, i};
+        }
+
+        It
+        operator++(int)
+        {
+            isize tmp = i;
+            i = s->nextI(i);
+            return {s, tmp};
+        }
+
+        friend bool operator==(const It l, const It r) { return l.i == r.i; }
+        friend bool operator!=(const It l, const It r) { return l.i != r.i; }
+    };
+
+    It begin() { return {this, firstI()}; }
+    It end() { return {this, -1}; }
+
+    const It begin() const { return {this, firstI()}; }
+    const It end() const { return {this, -1}; }
+};
+
+template<typename T, isize CHUNK_CAP>
+template<IsAllocator ALLOC>
+inline
+PoolDynamic<T, CHUNK_CAP>::PoolDynamic(ALLOC* p, isize prealloc)
+{
+    for (isize i = 0; i < prealloc; i += CHUNK_CAP)
+        newChunk(p);
+}
+
+template<typename T, isize CHUNK_CAP>
+inline bool
+PoolDynamic<T, CHUNK_CAP>::isValid(Handle h) const noexcept
+{
+    return h.i < u32(cap()) && m_vGens[h.i] == h.gen && occupied(h.i);
+}
+
+template<typename T, isize CHUNK_CAP>
+inline T*
+PoolDynamic<T, CHUNK_CAP>::tryGet(Handle h) noexcept
+{
+    if (!isValid(h)) return nullptr;
+    return &slot(h.i);
+}
+
+template<typename T, isize CHUNK_CAP>
+inline isize
+PoolDynamic<T, CHUNK_CAP>::firstI() const
+{
+    return nextI(-1);
+}
+
+template<typename T, isize CHUNK_CAP>
+inline isize
+PoolDynamic<T, CHUNK_CAP>::nextI(isize i) const
+{
+    return bitset::next(m_vOccupied.data(), m_vOccupied.size(), i + 1);
+}
+
+template<typename T, isize CHUNK_CAP>
+inline typename PoolDynamic<T, CHUNK_CAP>::Handle
+PoolDynamic<T, CHUNK_CAP>::handle(isize i) const noexcept
+{
+    ADT_ASSERT(i >= 0 && i < cap() && occupied(i), "i: {}, cap: {}", i, cap());
+    return {.i = u32(i), .gen = m_vGens[i]};
+}
+
+template<typename T, isize CHUNK_CAP>
+inline isize
+PoolDynamic<T, CHUNK_CAP>::idx(const T* const p) const
+{
+    for (isize chunkI = 0; chunkI < m_vChunks.size(); ++chunkI)
+    {
+        const isize r = p - m_vChunks[chunkI];
+        if (r >= 0 && r < CHUNK_CAP) return (chunkI << CHUNK_SHIFT) + r;
+    }
+
+    ADT_ASSERT(false, "out of range");
+    return -1;
+}
+
+template<typename T, isize CHUNK_CAP>
+template<typename CL>
+inline void
+PoolDynamic<T, CHUNK_CAP>::forEachOccupied(CL cl)
+{
+    bitset::forEachRun(m_vOccupied.data(), m_vOccupied.size(), [&](isize firstI, isize count) {
+        while (count > 0)
+        {
+            const isize n = utils::min(count, CHUNK_CAP - (firstI & CHUNK_MASK));
+            cl(&slot(firstI), firstI, n);
+            firstI += n;
+            count -= n;
+        }
+    });
+}
+
+template<typename T, isize CHUNK_CAP>
+template<IsAllocator ALLOC>
+inline typename PoolDynamic<T, CHUNK_CAP>::Handle
+PoolDynamic<T, CHUNK_CAP>::insert(ALLOC* p, const T& value)
+{
+    return emplace(p, value);
+}
+
+template<typename T, isize CHUNK_CAP>
+template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
+inline typename PoolDynamic<T, CHUNK_CAP>::Handle
+PoolDynamic<T, CHUNK_CAP>::emplace(ALLOC* p, ARGS&&... args)
+{
+    if (m_vFreeSlots.empty()) newChunk(p);
+
+    const u32 i = m_vFreeSlots.pop();
+    ADT_ASSERT(!occupied(i), "i: {}", i);
+
+    new(&slot(i)) T(std::forward<ARGS>(args)...);
+    bitset::set(m_vOccupied.data(), i);
+    ++m_vGens[i];
+    ++m_nOccupied;
+
+    return {.i = i, .gen = m_vGens[i]};
+}
+
+template<typename T, isize CHUNK_CAP>
+inline void
+PoolDynamic<T, CHUNK_CAP>::remove(Handle h) noexcept
+{
+    ADT_ASSERT(isValid(h), "stale or empty handle, i: {}, gen: {}", h.i, h.gen);
+
+    if constexpr (!std::is_trivially_destructible_v<T>)
+        slot(h.i).~T();
+
+    bitset::unset(m_vOccupied.data(), h.i);
+    ++m_vGens[h.i];
+    --m_nOccupied;
+
+    /* Can't fail: m_vFreeSlots has room for every slot since newChunk(). */
+    m_vFreeSlots.m_pData[m_vFreeSlots.m_size++] = h.i;
+}
+
+template<typename T, isize CHUNK_CAP>
+inline void
+PoolDynamic<T, CHUNK_CAP>::remove(T* p) noexcept
+{
+    remove(handle(idx(p)));
+}
+
+template<typename T, isize CHUNK_CAP>
+template<IsAllocator ALLOC>
+inline void
+PoolDynamic<T, CHUNK_CAP>::destroy(ALLOC* p) noexcept
+{
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        for (isize i = firstI(); i != -1; i = nextI(i))
+            slot(i).~T();
+    }
+
+    for (T* pChunk : m_vChunks) p->freeV(pChunk, CHUNK_CAP);
+
+    m_vChunks.destroy(p);
+    m_vGens.destroy(p);
+    m_vOccupied.destroy(p);
+    m_vFreeSlots.destroy(p);
+    *this = {};
+}
+
+template<typename T, isize CHUNK_CAP>
+inline T&
+PoolDynamic<T, CHUNK_CAP>::at(Handle h)
+{
+    ADT_ASSERT(isValid(h), "stale or empty handle, i: {}, gen: {}", h.i, h.gen);
+    return slot(h.i);
+}
+
+template<typename T, isize CHUNK_CAP>
+template<IsAllocator ALLOC>
+inline void
+PoolDynamic<T, CHUNK_CAP>::newChunk(ALLOC* p)
+{
+    const isize firstI = cap();
+    ADT_ASSERT(firstI + CHUNK_CAP < NPOS32, "too many slots: {}", firstI + CHUNK_CAP);
+
+    m_vChunks.push(p, p->template mallocV<T>(CHUNK_CAP));
+    for (isize i = 0; i < CHUNK_CAP; ++i) m_vGens.push(p, 0u);
+    for (isize i = 0; i < CHUNK_CAP / 64; ++i) m_vOccupied.push(p, 0llu);
+
+    /* Room for every slot, remove() pushes without allocating. */
+    if (m_vFreeSlots.cap() < firstI + CHUNK_CAP)
+        m_vFreeSlots.setCap(p, utils::max(m_vFreeSlots.cap() * 2, firstI + CHUNK_CAP));
+    for (isize i = firstI + CHUNK_CAP - 1; i >= firstI; --i)
+        m_vFreeSlots.m_pData[m_vFreeSlots.m_size++] = u32(i);
+}
+
+namespace print
+{
+
+template<typename T, isize CHUNK_CAP>
+inline isize
+format(Context* pCtx, FmtArgs* pFmtArgs, const typename PoolDynamic<T, CHUNK_CAP>::Handle& x)
+{
+    return format(pCtx, pFmtArgs, x.i);
+}
+
+} /* namespace print */
+
+} /* namespace adt */
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Array.hh"
+#include "Bitset.hh"
+#include "Span.hh"
 
 namespace adt
 {
@@ -33,8 +35,8 @@ template<typename STRUCT, typename BIND, int CAP, auto ...MEMBERS>
 struct PoolSOA : public SOAArrayHolder<STRUCT, CAP, MEMBERS>...
 {
     Array<PoolSOAHandle<STRUCT>, CAP> m_aFreeHandles {};
-    bool m_aOccupiedIdxs[CAP] {};
-    int m_size {};
+    Bitset<CAP> m_occupied {};
+    int m_size {}; /* Slots handed out so far, including removed ones. */
 
     /* */
 
@@ -54,7 +56,7 @@ struct PoolSOA : public SOAArrayHolder<STRUCT, CAP, MEMBERS>...
         if (!m_aFreeHandles.empty())
         {
             PoolSOAHandle h = m_aFreeHandles.pop();
-            m_aOccupiedIdxs[h.i] = true;
+            m_occupied.set(h.i);
             set(h, x);
             return h;
         }
@@ -69,7 +71,7 @@ struct PoolSOA : public SOAArrayHolder<STRUCT, CAP, MEMBERS>...
             }
 
             ++m_size;
-            m_aOccupiedIdxs[m_size - 1] = true;
+            m_occupied.set(m_size - 1);
             set({m_size - 1}, x);
             return {m_size - 1};
         }
@@ -78,7 +80,7 @@ struct PoolSOA : public SOAArrayHolder<STRUCT, CAP, MEMBERS>...
     void
     remove(PoolSOAHandle<STRUCT> h)
     {
-        m_aOccupiedIdxs[h.i] = false;
+        m_occupied.unset(h.i);
         m_aFreeHandles.push(h);
     }
 
@@ -87,7 +89,7 @@ struct PoolSOA : public SOAArrayHolder<STRUCT, CAP, MEMBERS>...
     bindMember(PoolSOAHandle<STRUCT> h)
     {
         ADT_ASSERT(h.i >= 0 && h.i < CAP, "out of range: h: {}, CAP: {}", h.i, CAP);
-        ADT_ASSERT(m_aOccupiedIdxs[h.i], "handle '{}' is free", h.i);
+        ADT_ASSERT(m_occupied[h.i], "handle '{}' is free", h.i);
         return static_cast<SOAArrayHolder<STRUCT, CAP, MEMBER>&>(*this).m_arrays[h.i];
     }
 
@@ -96,52 +98,38 @@ struct PoolSOA : public SOAArrayHolder<STRUCT, CAP, MEMBERS>...
     bindMember(PoolSOAHandle<STRUCT> h) const
     {
         ADT_ASSERT(h.i >= 0 && h.i < CAP, "out of range: h: {}, CAP: {}", h.i, CAP);
-        ADT_ASSERT(m_aOccupiedIdxs[h.i], "handle '{}' is free", h.i);
+        ADT_ASSERT(m_occupied[h.i], "handle '{}' is free", h.i);
         return static_cast<const SOAArrayHolder<STRUCT, CAP, MEMBER>&>(*this).m_arrays[h.i];
     }
 
-    isize size() const { return static_cast<isize>(m_size); }
-    isize cap() const { return static_cast<isize>(CAP); }
-
-    int
-    firstI() const
+    /* Whole column up to size(), removed slots included: pair with forEachOccupied(). */
+    template<auto MEMBER>
+    [[nodiscard]] auto
+    column() noexcept
     {
-        if (m_size == 0) return -1;
-
-        for (isize i = 0; i < m_size; ++i)
-            if (m_aOccupiedIdxs[i]) return i;
-
-        return NPOS;
+        auto& arr = static_cast<SOAArrayHolder<STRUCT, CAP, MEMBER>&>(*this).m_arrays;
+        return Span {arr, m_size};
     }
 
-    int
-    lastI() const
+    template<auto MEMBER>
+    [[nodiscard]] auto
+    column() const noexcept
     {
-        if (m_size == 0) return -1;
-
-        for (isize i = m_size - 1; i >= 0; --i)
-            if (m_aOccupiedIdxs[i]) return i;
-
-        return NPOS;
+        const auto& arr = static_cast<const SOAArrayHolder<STRUCT, CAP, MEMBER>&>(*this).m_arrays;
+        return Span {arr, m_size};
     }
 
-    int
-    nextI(int i) const
-    {
-        do ++i;
-        while (i < m_size && !m_aOccupiedIdxs[i]);
-
-        return i;
-    }
+    isize size() const { return static_cast<isize>(m_size); }
+    isize cap() const { return static_cast<isize>(CAP); }
 
-    int
-    prevI(int i) const
-    {
-        do --i;
-        while (i >= 0 && !m_aOccupiedIdxs[i]);
+    int firstI() const { return m_occupied.next(0); }
+    int lastI() const { return m_occupied.prev(m_size - 1); }
+    int nextI(int i) const { return m_occupied.next(i + 1); }
+    int prevI(int i) const { return m_occupied.prev(i - 1); }
 
-        return i;
-    }
+    /* cl(firstI, count) for every run of consecutive occupied slots, columns are contiguous within a run. */
+    template<typename CL>
+    void forEachOccupied(CL cl) const { m_occupied.forEachRun(cl); }
 
     /* */
 
@@ -193,10 +181,10 @@ struct PoolSOA : public SOAArrayHolder<STRUCT, CAP, MEMBERS>...
     };
 
     It begin() { return {this, firstI()}; }
-    It end() { return {this, size() == 0 ? -1 : lastI() + 1}; }
+    It end() { return {this, -1}; }
 
     const It begin() const { return {this, firstI()}; }
-    const It end() const { return {this, size() == 0 ? -1 : lastI() + 1}; }
+    const It end() const { return {this, -1}; }
 };
 
 } /* namespace adt */
@@ -20,7 +20,8 @@ struct Queue
     /* */
 
     Queue() : m_pData {}, m_size {}, m_cap {}, m_headI {}, m_tailI {} {}
-    Queue(IAllocator* pAlloc, isize prealloc = 8);
+    template<IsAllocator ALLOC>
+    Queue(ALLOC* pAlloc, isize prealloc = 8);
 
     /* */
 
@@ -35,32 +36,38 @@ struct Queue
     isize cap() const;
     bool empty() const;
 
-    isize pushBack(IAllocator* pAlloc, const T& x) { return emplaceBack(pAlloc, x); }
-    isize pushBack(IAllocator* pAlloc, T&& x) { return emplaceBack(pAlloc, std::move(x)); }
+    template<IsAllocator ALLOC>
+    isize pushBack(ALLOC* pAlloc, const T& x) { return emplaceBack(pAlloc, x); }
+    template<IsAllocator ALLOC>
+    isize pushBack(ALLOC* pAlloc, T&& x) { return emplaceBack(pAlloc, std::move(x)); }
 
-    isize pushFront(IAllocator* pAlloc, const T& x) { return emplaceFront(pAlloc, x); }
-    isize pushFront(IAllocator* pAlloc, T&& x) { return emplaceFront(pAlloc, std::move(x)); }
+    template<IsAllocator ALLOC>
+    isize pushFront(ALLOC* pAlloc, const T& x) { return emplaceFront(pAlloc, x); }
+    template<IsAllocator ALLOC>
+    isize pushFront(ALLOC* pAlloc, T&& x) { return emplaceFront(pAlloc, std::move(x)); }
 
     T popFront();
     T popBack();
 
-    template<typename ...ARGS>
-    isize emplaceFront(IAllocator* pAlloc, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS>
+    isize emplaceFront(ALLOC* pAlloc, ARGS&&... args);
 
     template<typename ...ARGS>
     isize emplaceFrontNoGrow(ARGS&&... args);
 
-    template<typename ...ARGS>
-    isize emplaceBack(IAllocator* pAlloc, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS>
+    isize emplaceBack(ALLOC* pAlloc, ARGS&&... args);
 
     template<typename ...ARGS>
     isize emplaceBackNoGrow(ARGS&&... args);
 
-    void destroy(IAllocator* pAlloc) noexcept;
+    template<IsAllocator ALLOC>
+    void destroy(ALLOC* pAlloc) noexcept;
     [[nodiscard]] Queue release() noexcept;
 
 protected:
-    void grow(IAllocator* pAlloc);
+    template<IsAllocator ALLOC>
+    void grow(ALLOC* pAlloc);
 
 public:
 
@@ -114,14 +121,15 @@ public:
 };
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline
-Queue<T>::Queue(IAllocator* pAlloc, isize prealloc)
+Queue<T>::Queue(ALLOC* pAlloc, isize prealloc)
     : m_size {}, m_headI {}, m_tailI {}
 {
     const isize cap = nextPowerOf2(prealloc);
     ADT_ASSERT(isPowerOf2(cap), "nextPowerOf2: {}", cap);
 
-    m_pData = pAlloc->zallocV<T>(cap);
+    m_pData = pAlloc->template zallocV<T>(cap);
     m_cap = cap;
 }
 
@@ -169,9 +177,9 @@ Queue<T>::empty() const
 }
 
 template<typename T>
-template<typename ...ARGS>
+template<IsAllocator ALLOC, typename ...ARGS>
 inline isize
-Queue<T>::emplaceBack(IAllocator* pAlloc, ARGS&&... args)
+Queue<T>::emplaceBack(ALLOC* pAlloc, ARGS&&... args)
 {
     if (m_size >= m_cap) grow(pAlloc);
 
@@ -202,9 +210,9 @@ Queue<T>::emplaceBackNoGrow(ARGS&&... args)
 }
 
 template<typename T>
-template<typename ...ARGS>
+template<IsAllocator ALLOC, typename ...ARGS>
 inline isize
-Queue<T>::emplaceFront(IAllocator* pAlloc, ARGS&&... args)
+Queue<T>::emplaceFront(ALLOC* pAlloc, ARGS&&... args)
 {
     if (m_size >= m_cap) grow(pAlloc);
 
@@ -265,8 +273,9 @@ Queue<T>::popBack()
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Queue<T>::destroy(IAllocator* pAlloc) noexcept
+Queue<T>::destroy(ALLOC* pAlloc) noexcept
 {
     pAlloc->dealloc(m_pData, m_size);
     *this = {};
@@ -280,11 +289,12 @@ Queue<T>::release() noexcept
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Queue<T>::grow(IAllocator* pAlloc)
+Queue<T>::grow(ALLOC* pAlloc)
 {
     const isize newCap = utils::max(isize(2), m_cap * 2);
-    m_pData = pAlloc->relocate<T>(m_pData, m_cap, newCap);
+    m_pData = pAlloc->template relocate<T>(m_pData, m_cap, newCap);
 
     ADT_DEFER( m_cap = newCap );
 
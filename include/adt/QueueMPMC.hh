@@ -21,22 +21,24 @@
 
 #pragma once
 
-#include "adt/Opt.hh"
-#include "adt/atomic.hh"
-#include "adt/Gpa.hh"
+#include "Gpa.hh"
+#include "Opt.hh"
+#include "Span.hh"
+#include "atomic.hh"
 
 namespace adt
 {
 
+/* Bounded, capacity is rounded up to the power of 2.
+ * Sequences and positions are 64-bit, so they never wrap in practice. */
 template<typename T>
 struct QueueMPMC
 {
-    static constexpr isize CACHELINE_SIZE = 64;
     using CacheLinePad = char[CACHELINE_SIZE];
 
     struct Cell
     {
-        atomic::Int sequence {};
+        atomic::Long sequence {};
         T data {};
     };
 
@@ -46,9 +48,9 @@ struct QueueMPMC
     Cell* m_pBuff {};
     isize m_cap {};
     CacheLinePad m_pad1 {};
-    atomic::Int m_enqueuePos {};
+    atomic::Long m_enqueuePos {};
     CacheLinePad m_pad2 {};
-    atomic::Int m_dequeuePos {};
+    atomic::Long m_dequeuePos {};
     CacheLinePad m_pad3 {};
 #ifndef NDEBUG
     bool m_bInitialized {};
@@ -69,19 +71,27 @@ struct QueueMPMC
     bool push(const T& x) { return emplace(x); }
     bool push(T&& x) { return emplace(std::move(x)); }
 
+    /* Pushes up to sp.size() elements with one CAS, returns number of pushed elements. */
+    isize pushBatch(Span<const T> sp);
+
     [[nodiscard]] Opt<T> pop();
-    int cap() const noexcept { return m_cap; }
+
+    /* Pops up to spOut.size() elements with one CAS, returns number of popped elements. */
+    isize popBatch(Span<T> spOut);
+
+    isize cap() const noexcept { return m_cap; }
+    isize size() const noexcept; /* Approximate. */
     bool empty() const noexcept;
 };
 
 template<typename T>
 inline
 QueueMPMC<T>::QueueMPMC(isize capPO2)
-    : m_cap{nextPowerOf2(capPO2)}
+    : m_cap{nextPowerOf2(utils::max(capPO2, isize(2)))}
 {
     m_pBuff = Gpa::inst()->zallocV<Cell>(m_cap);
-    for (int i = 0; i < m_cap; ++i)
-        m_pBuff[i].sequence = atomic::Int(i);
+    for (isize i = 0; i < m_cap; ++i)
+        m_pBuff[i].sequence = atomic::Long(i);
 
 #ifndef NDEBUG
     m_bInitialized = true;
@@ -92,10 +102,16 @@ template<typename T>
 inline void
 QueueMPMC<T>::destroy() noexcept
 {
-    for (isize i = 0; i < m_cap; ++i)
-        m_pBuff[i].data.~T();
+    if constexpr (!std::is_trivially_destructible_v<T>)
+    {
+        const isize first = m_dequeuePos.load(atomic::ORDER::ACQUIRE);
+        const isize last = m_enqueuePos.load(atomic::ORDER::ACQUIRE);
+        for (isize i = first; i < last; ++i)
+            m_pBuff[i & (m_cap - 1)].data.~T();
+    }
 
-    Gpa::inst()->free(m_pBuff);
+    Gpa::inst()->freeV(m_pBuff, m_cap);
+    *this = {};
 }
 
 template<typename T>
@@ -106,13 +122,13 @@ QueueMPMC<T>::emplace(ARGS&&... args)
     ADT_ASSERT(m_bInitialized != false, "forgot to {INIT}");
 
     Cell* pCell;
-    atomic::Int::Type pos = m_enqueuePos.load(atomic::ORDER::RELAXED);
+    isize pos = m_enqueuePos.load(atomic::ORDER::RELAXED);
 
     while (true)
     {
         pCell = &m_pBuff[pos & (m_cap - 1)];
-        int seq = pCell->sequence.load(atomic::ORDER::ACQUIRE);
-        int diff = seq - pos;
+        const isize seq = pCell->sequence.load(atomic::ORDER::ACQUIRE);
+        const isize diff = seq - pos;
         if (diff == 0)
         {
             if (m_enqueuePos.compareExchangeWeak(&pos, pos + 1,
@@ -139,18 +155,68 @@ QueueMPMC<T>::emplace(ARGS&&... args)
     return true;
 }
 
+template<typename T>
+inline isize
+QueueMPMC<T>::pushBatch(Span<const T> sp)
+{
+    ADT_ASSERT(m_bInitialized != false, "forgot to {INIT}");
+
+    if (sp.empty()) return 0;
+
+    isize pos = m_enqueuePos.load(atomic::ORDER::RELAXED);
+    isize n;
+
+    while (true)
+    {
+        /* Count how many consecutive cells are free starting from pos. */
+        n = 0;
+        const isize maxN = utils::min(sp.size(), m_cap);
+        for (; n < maxN; ++n)
+        {
+            const isize seq = m_pBuff[(pos + n) & (m_cap - 1)].sequence.load(atomic::ORDER::ACQUIRE);
+            if (seq != pos + n) break;
+        }
+
+        if (n == 0)
+        {
+            const isize seq = m_pBuff[pos & (m_cap - 1)].sequence.load(atomic::ORDER::ACQUIRE);
+            if (seq - pos < 0) return 0; /* Full. */
+
+            pos = m_enqueuePos.load(atomic::ORDER::RELAXED);
+            continue;
+        }
+
+        if (m_enqueuePos.compareExchangeWeak(&pos, pos + n,
+                atomic::ORDER::RELAXED, atomic::ORDER::RELAXED
+            )
+        )
+        {
+            break;
+        }
+    }
+
+    for (isize i = 0; i < n; ++i)
+    {
+        Cell* pCell = &m_pBuff[(pos + i) & (m_cap - 1)];
+        new(&pCell->data) T(sp[i]);
+        pCell->sequence.store(pos + i + 1, atomic::ORDER::RELEASE);
+    }
+
+    return n;
+}
+
 template<typename T>
 inline Opt<T>
 QueueMPMC<T>::pop()
 {
     Cell* pCell;
-    atomic::Int::Type pos = m_dequeuePos.load(atomic::ORDER::RELAXED);
+    isize pos = m_dequeuePos.load(atomic::ORDER::RELAXED);
 
     while (true)
     {
         pCell = &m_pBuff[pos & (m_cap - 1)];
-        int seq = pCell->sequence.load(atomic::ORDER::ACQUIRE);
-        int diff = seq - (pos + 1);
+        const isize seq = pCell->sequence.load(atomic::ORDER::ACQUIRE);
+        const isize diff = seq - (pos + 1);
         if (diff == 0)
         {
             if (m_dequeuePos.compareExchangeWeak(&pos, pos + 1,
@@ -174,11 +240,69 @@ QueueMPMC<T>::pop()
     Opt<T> ret = std::move(pCell->data);
     if constexpr (!std::is_trivially_destructible_v<T>)
         pCell->data.~T();
-    pCell->sequence.store(pos + (m_cap - 1) + 1, atomic::ORDER::RELEASE);
+    pCell->sequence.store(pos + m_cap, atomic::ORDER::RELEASE);
 
     return ret;
 }
 
+template<typename T>
+inline isize
+QueueMPMC<T>::popBatch(Span<T> spOut)
+{
+    if (spOut.empty()) return 0;
+
+    isize pos = m_dequeuePos.load(atomic::ORDER::RELAXED);
+    isize n;
+
+    while (true)
+    {
+        /* Count how many consecutive cells are published starting from pos. */
+        n = 0;
+        const isize maxN = utils::min(spOut.size(), m_cap);
+        for (; n < maxN; ++n)
+        {
+            const isize seq = m_pBuff[(pos + n) & (m_cap - 1)].sequence.load(atomic::ORDER::ACQUIRE);
+            if (seq != pos + n + 1) break;
+        }
+
+        if (n == 0)
+        {
+            const isize seq = m_pBuff[pos & (m_cap - 1)].sequence.load(atomic::ORDER::ACQUIRE);
+            if (seq - (pos + 1) < 0) return 0; /* Empty. */
+
+            pos = m_dequeuePos.load(atomic::ORDER::RELAXED);
+            continue;
+        }
+
+        if (m_dequeuePos.compareExchangeWeak(&pos, pos + n,
+                atomic::ORDER::RELAXED, atomic::ORDER::RELAXED
+            )
+        )
+        {
+            break;
+        }
+    }
+
+    for (isize i = 0; i < n; ++i)
+    {
+        Cell* pCell = &m_pBuff[(pos + i) & (m_cap - 1)];
+        spOut[i] = std::move(pCell->data);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            pCell->data.~T();
+        pCell->sequence.store(pos + i + m_cap, atomic::ORDER::RELEASE);
+    }
+
+    return n;
+}
+
+template<typename T>
+inline isize
+QueueMPMC<T>::size() const noexcept
+{
+    const isize size = m_enqueuePos.load(atomic::ORDER::RELAXED) - m_dequeuePos.load(atomic::ORDER::RELAXED);
+    return size < 0 ? 0 : size;
+}
+
 template<typename T>
 inline bool
 QueueMPMC<T>::empty() const noexcept
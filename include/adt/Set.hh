@@ -74,18 +74,19 @@ struct Set : public Map<T, Empty, FN_HASH>
 
     /* */
 
-    SetResult<T> insert(IAllocator* p, const T& x);
+    template<IsAllocator ALLOC>
+    SetResult<T> insert(ALLOC* p, const T& x);
     auto tryInsert() = delete;
 
-    template<typename ...ARGS>
-    SetResult<T> emplace(IAllocator* p, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS>
+    SetResult<T> emplace(ALLOC* p, ARGS&&... args);
 
     [[nodiscard]] SetResult<T> search(const T& key);
     [[nodiscard]] const SetResult<T> search(const T& key) const;
 
     [[nodiscard]] SetResult<T> searchHashed(const T& key, usize keyHash) const { return Base::searchHashed(key, keyHash); }
 
-    void rehash(IAllocator* p, isize size);
+    isize searchBatch(Span<const T> spKeys, Span<SetResult<T>> spResults) const { return Base::searchBatch(spKeys, spResults); }
 
     isize idx(const T* const p) const;
     isize idx(const SetResult<T> res) const;
@@ -121,23 +122,24 @@ struct Set : public Map<T, Empty, FN_HASH>
 };
 
 template<typename T, usize (*FN_HASH)(const T&)>
+template<IsAllocator ALLOC>
 inline SetResult<T>
-Set<T, FN_HASH>::insert(IAllocator* p, const T& x)
+Set<T, FN_HASH>::insert(ALLOC* p, const T& x)
 {
     return emplace(p, x);
 }
 
 template<typename T, usize (*FN_HASH)(const T&)>
-template<typename ...ARGS>
+template<IsAllocator ALLOC, typename ...ARGS>
 inline SetResult<T>
-Set<T, FN_HASH>::emplace(IAllocator* p, ARGS&&... args)
+Set<T, FN_HASH>::emplace(ALLOC* p, ARGS&&... args)
 {
     static_assert(std::is_constructible_v<T, ARGS...>);
 
     if (Base::m_vBuckets.cap() <= 0)
         *this = {p};
     else if (Base::loadFactor() >= Base::m_maxLoadFactor)
-        rehash(p, Base::m_vBuckets.cap() * 2);
+        Base::rehash(p, Base::m_vBuckets.cap() * 2);
 
     T tmpVal = T (std::forward<ARGS>(args)...);
 
@@ -145,18 +147,19 @@ Set<T, FN_HASH>::emplace(IAllocator* p, ARGS&&... args)
     const isize idx = Base::insertionIdx(hash, tmpVal);
     auto& rBucket = Base::m_vBuckets[idx];
 
-    rBucket.eFlags = MAP_BUCKET_FLAGS::OCCUPIED;
-
     SetResult<T> res {
         &rBucket, hash, MAP_RESULT_STATUS::INSERTED
     };
 
-    if (rBucket.key == tmpVal)
+    if (rBucket.eFlags == MAP_BUCKET_FLAGS::OCCUPIED)
     {
         res.eStatus = MAP_RESULT_STATUS::FOUND;
         return res;
     }
 
+    rBucket.eFlags = MAP_BUCKET_FLAGS::OCCUPIED;
+    if constexpr (MapBucket<T, Empty>::STORE_HASH) rBucket.hash = hash;
+
     utils::destructiveMove(&rBucket.key, std::move(tmpVal));
 
     ++Base::m_nOccupied;
@@ -178,19 +181,6 @@ Set<T, FN_HASH>::search(const T& key) const
     return Base::searchHashed(key, FN_HASH(key));
 }
 
-template<typename T, usize (*FN_HASH)(const T&)>
-inline void
-Set<T, FN_HASH>::rehash(IAllocator* p, isize size)
-{
-    Set mNew {p, size};
-
-    for (auto& key : *this)
-        mNew.emplace(p, std::move(key));
-
-    Base::destroy(p);
-    *this = mNew;
-}
-
 template<typename T, usize (*FN_HASH)(const T&)>
 inline isize
 Set<T, FN_HASH>::idx(const T* const p) const
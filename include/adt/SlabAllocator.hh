@@ -0,0 +1,310 @@
+#pragma once
+
+#include "Gpa.hh"
+#include "Map.hh"
+
+#include <bit>
+#include <cstring>
+
+namespace adt
+{
+
+struct SlabClassStats
+{
+    usize chunkSize {};
+    isize nUsed {}; /* Live chunks. */
+    isize nMaxUsed {}; /* High-water mark of nUsed. */
+    isize nCapacity {}; /* Chunks carved from slabs so far (used + free). */
+    isize nSlabs {};
+};
+
+/* Mixed small allocations with individual frees.
+ * 8 byte size classes (sizeClass8) up to 256 bytes, power of 2 classes up to 4K, larger requests go to the back allocator.
+ * Each class carves chunks out of SLAB_SIZE aligned slabs and keeps an intrusive free list.
+ * free() finds the class by the slab address, not by nBytes, so callers that pass imprecise sizes (Vec::destroy()) are fine.
+ * Not thread safe. freeAll() releases slabs only (the allocator stays usable), large allocations must be freed individually. */
+struct SlabAllocator final : public IAllocator
+{
+    static constexpr usize SLAB_SIZE = SIZE_1K * 64;
+    static constexpr usize MAX_SIZE_8 = 256;
+    static constexpr usize MAX_SIZE = SIZE_1K * 4;
+    static constexpr isize N_CLASSES_8 = sizeClass8(MAX_SIZE_8);
+    static constexpr isize N_CLASSES = N_CLASSES_8 + std::countr_zero(MAX_SIZE) - std::countr_zero(MAX_SIZE_8);
+
+    struct SizeClass
+    {
+        void* pFreeList {};
+        u8* pBump {}; /* Uncarved rest of the newest slab. */
+        u8* pBumpEnd {};
+        SlabClassStats stats {};
+    };
+
+    /* */
+
+    IAllocator* m_pBackAlloc {};
+    SizeClass m_aClasses[N_CLASSES] {};
+    Map<usize, u32> m_mapSlabs {}; /* Slab address -> class. */
+    usize m_lastSlab {}; /* One entry cache in front of m_mapSlabs. */
+    u32 m_lastSlabClass {};
+    isize m_nLarge {}; /* Live allocations from the back allocator. */
+
+    /* */
+
+    SlabAllocator() = default;
+    SlabAllocator(IAllocator* pBackAlloc) noexcept(false);
+
+    /* */
+
+    [[nodiscard]] virtual void* malloc(usize nBytes) noexcept(false) override final;
+    [[nodiscard]] virtual void* zalloc(usize nBytes) noexcept(false) override final;
+    [[nodiscard]] virtual void* realloc(void* ptr, usize oldNBytes, usize newNBytes) noexcept(false) override final;
+    void virtual free(void* ptr, usize nBytes) noexcept override final;
+
+    [[nodiscard]] virtual bool doesFree() const noexcept override final { return true; }
+    [[nodiscard]] virtual bool doesRealloc() const noexcept override final { return true; }
+
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+    virtual void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept override final;
+
+    /* */
+
+    [[nodiscard]] static constexpr isize classI(usize nBytes) noexcept; /* nBytes <= MAX_SIZE. */
+    [[nodiscard]] static constexpr usize classChunkSize(isize classI) noexcept;
+
+    [[nodiscard]] const SlabClassStats& classStats(isize classI) const noexcept { return m_aClasses[classI].stats; }
+    [[nodiscard]] isize nLarge() const noexcept { return m_nLarge; }
+
+    void freeAll() noexcept;
+
+    /* */
+
+private:
+    [[nodiscard]] isize slabClassI(const void* p) noexcept; /* -1 if p is not in a slab. */
+    [[nodiscard]] void* mallocFromClass(isize classI);
+    void freeToClass(isize classI, void* p) noexcept;
+    void newSlab(isize classI);
+};
+
+inline
+SlabAllocator::SlabAllocator(IAllocator* pBackAlloc)
+    : m_pBackAlloc {pBackAlloc},
+      m_mapSlabs {pBackAlloc, SIZE_1K}
+{
+    for (isize i = 0; i < N_CLASSES; ++i)
+        m_aClasses[i].stats.chunkSize = classChunkSize(i);
+}
+
+constexpr isize
+SlabAllocator::classI(usize nBytes) noexcept
+{
+    if (nBytes <= MAX_SIZE_8) return sizeClass8(utils::max(nBytes, usize(1))) - 1;
+    return N_CLASSES_8 + std::bit_width(nBytes - 1) - std::countr_zero(MAX_SIZE_8) - 1;
+}
+
+constexpr usize
+SlabAllocator::classChunkSize(isize classI) noexcept
+{
+    if (classI < N_CLASSES_8) return (classI + 1) * 8;
+    return MAX_SIZE_8 << (classI - N_CLASSES_8 + 1);
+}
+
+inline void*
+SlabAllocator::malloc(usize nBytes)
+{
+    if (nBytes > MAX_SIZE)
+    {
+        void* p = m_pBackAlloc->malloc(nBytes);
+        ++m_nLarge;
+        return p;
+    }
+
+    return mallocFromClass(classI(nBytes));
+}
+
+inline void*
+SlabAllocator::zalloc(usize nBytes)
+{
+    void* p = malloc(nBytes);
+    memset(p, 0, nBytes);
+    return p;
+}
+
+inline void*
+SlabAllocator::realloc(void* p, usize oldNBytes, usize newNBytes)
+{
+    if (!p) return malloc(newNBytes);
+
+    const isize cI = slabClassI(p);
+    if (cI >= 0)
+    {
+        if (newNBytes <= classChunkSize(cI)) return p;
+    }
+    else if (newNBytes > MAX_SIZE)
+    {
+        return m_pBackAlloc->realloc(p, oldNBytes, newNBytes);
+    }
+
+    void* pNew = malloc(newNBytes);
+    memcpy(pNew, p, utils::min(oldNBytes, newNBytes));
+    free(p, oldNBytes);
+
+    return pNew;
+}
+
+inline void
+SlabAllocator::free(void* p, usize nBytes) noexcept
+{
+    if (!p) return;
+
+    const isize cI = slabClassI(p);
+    if (cI >= 0)
+    {
+        freeToClass(cI, p);
+    }
+    else
+    {
+        m_pBackAlloc->free(p, nBytes);
+        --m_nLarge;
+    }
+}
+
+/* Class chunks are multiples of the rounded up size and slabs are SLAB_SIZE aligned,
+ * so any alignment that divides the chunk size comes for free. */
+inline void*
+SlabAllocator::mallocAligned(usize nBytes, usize alignment)
+{
+    if (alignment <= ALLOC_ALIGNMENT) return malloc(nBytes);
+
+    const usize alignedSize = alignUpPO2(utils::max(nBytes, usize(1)), alignment);
+    if (alignedSize <= MAX_SIZE) return mallocFromClass(classI(alignedSize));
+
+    void* p = m_pBackAlloc->mallocAligned(nBytes, alignment);
+    ++m_nLarge;
+    return p;
+}
+
+inline void*
+SlabAllocator::zallocAligned(usize nBytes, usize alignment)
+{
+    void* p = mallocAligned(nBytes, alignment);
+    memset(p, 0, nBytes);
+    return p;
+}
+
+inline void*
+SlabAllocator::reallocAligned(void* p, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    if (alignment <= ALLOC_ALIGNMENT) return realloc(p, oldNBytes, newNBytes);
+    if (!p) return mallocAligned(newNBytes, alignment);
+
+    const isize cI = slabClassI(p);
+    if (cI >= 0 && newNBytes <= classChunkSize(cI)) return p;
+
+    void* pNew = mallocAligned(newNBytes, alignment);
+    memcpy(pNew, p, utils::min(oldNBytes, newNBytes));
+    freeAligned(p, oldNBytes, alignment);
+
+    return pNew;
+}
+
+inline void
+SlabAllocator::freeAligned(void* p, usize nBytes, usize alignment) noexcept
+{
+    if (!p) return;
+
+    const isize cI = slabClassI(p);
+    if (cI >= 0)
+    {
+        freeToClass(cI, p);
+    }
+    else
+    {
+        m_pBackAlloc->freeAligned(p, nBytes, alignment);
+        --m_nLarge;
+    }
+}
+
+inline void
+SlabAllocator::freeAll() noexcept
+{
+    for (auto& kv : m_mapSlabs)
+        m_pBackAlloc->freeAligned((void*)kv.key, SLAB_SIZE, SLAB_SIZE);
+
+    m_mapSlabs.destroy(m_pBackAlloc);
+    m_mapSlabs = {}; /* Allocated again by the next newSlab(). */
+    m_lastSlab = 0;
+    m_lastSlabClass = 0;
+
+    /* Keeps m_pBackAlloc and the chunk sizes, usable like after construction. */
+    for (isize i = 0; i < N_CLASSES; ++i)
+        m_aClasses[i] = {.stats {.chunkSize = classChunkSize(i)}};
+}
+
+inline isize
+SlabAllocator::slabClassI(const void* p) noexcept
+{
+    const usize slab = alignDownPO2(usize(p), SLAB_SIZE);
+    if (slab == m_lastSlab) return m_lastSlabClass;
+
+    /* Large allocations never share an aligned SLAB_SIZE range with a slab. */
+    auto found = m_mapSlabs.search(slab);
+    if (!found) return -1;
+
+    m_lastSlab = slab;
+    m_lastSlabClass = found.value();
+    return m_lastSlabClass;
+}
+
+inline void*
+SlabAllocator::mallocFromClass(isize cI)
+{
+    SizeClass& c = m_aClasses[cI];
+
+    void* p;
+    if (c.pFreeList)
+    {
+        p = c.pFreeList;
+        c.pFreeList = *(void**)p;
+    }
+    else
+    {
+        if (usize(c.pBumpEnd - c.pBump) < c.stats.chunkSize) newSlab(cI); /* Both null before the first slab. */
+
+        p = c.pBump;
+        c.pBump += c.stats.chunkSize;
+        ++c.stats.nCapacity;
+    }
+
+    if (++c.stats.nUsed > c.stats.nMaxUsed) c.stats.nMaxUsed = c.stats.nUsed;
+
+    return p;
+}
+
+inline void
+SlabAllocator::freeToClass(isize cI, void* p) noexcept
+{
+    SizeClass& c = m_aClasses[cI];
+    ADT_ASSERT(c.stats.nUsed > 0, "double free? class: {}, p: {}", cI, p);
+
+    *(void**)p = c.pFreeList;
+    c.pFreeList = p;
+    --c.stats.nUsed;
+}
+
+inline void
+SlabAllocator::newSlab(isize cI)
+{
+    ADT_ASSERT(m_pBackAlloc, "uninitialized: m_pBackAlloc == nullptr");
+
+    u8* pSlab = static_cast<u8*>(m_pBackAlloc->mallocAligned(SLAB_SIZE, SLAB_SIZE));
+    m_mapSlabs.insert(m_pBackAlloc, usize(pSlab), u32(cI));
+
+    SizeClass& c = m_aClasses[cI];
+    c.pBump = pSlab;
+    c.pBumpEnd = pSlab + SLAB_SIZE;
+    ++c.stats.nSlabs;
+}
+
+} /* namespace adt */
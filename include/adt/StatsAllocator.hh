@@ -0,0 +1,419 @@
+#pragma once
+
+#include "Thread.hh"
+#include "atomic.hh"
+#include "print.hh"
+
+#include <bit>
+
+namespace adt
+{
+
+/* Decorator that counts everything going through pBackAlloc: calls, live/peak/total bytes and a power of 2 size histogram.
+ * Counters are relaxed atomics, the allocator stays as thread safe as pBackAlloc is.
+ * Live bytes trust nBytes passed to free()/realloc(), containers pass their capacity (Vec::destroy()).
+ * With bAttribute, allocations made under a StatsAllocator::SiteScope are also counted per source location. */
+struct StatsAllocator final : public IAllocator
+{
+    static constexpr isize HISTOGRAM_SIZE = 24; /* Bucket i: (2^(i-1), 2^i] bytes, the last one takes the rest. */
+    static constexpr isize MAX_SITES = 128; /* Power of 2. */
+
+    struct Counters
+    {
+        atomic::Num<isize> atomNMallocs {};
+        atomic::Num<isize> atomNReallocs {};
+        atomic::Num<isize> atomNFrees {};
+        atomic::Num<isize> atomBytesLive {};
+        atomic::Num<isize> atomBytesTotal {}; /* Sum of all malloc sizes and realloc growths. */
+    };
+
+    struct Site
+    {
+        atomic::Num<usize> atomKey {}; /* Hash of loc, 0: free slot. Only filters, a hit compares loc. */
+        std::source_location loc {};
+        Counters counters {};
+    };
+
+    /* Plain copy of the counters. */
+    struct Snapshot
+    {
+        isize nMallocs {};
+        isize nReallocs {};
+        isize nFrees {};
+        isize bytesLive {};
+        isize bytesPeak {};
+        isize bytesTotal {};
+        isize aHistogram[HISTOGRAM_SIZE] {};
+    };
+
+    /* Attributes allocations of this thread to the location of the scope until it ends. */
+    struct SiteScope
+    {
+        std::source_location m_loc {};
+        const std::source_location* m_pPrev {};
+
+        /* */
+
+        SiteScope(std::source_location loc = std::source_location::current()) noexcept;
+        ~SiteScope() noexcept;
+
+        /* gtl_pSite points at m_loc, a copy or a move would leave it dangling. */
+        SiteScope(const SiteScope&) = delete;
+        SiteScope(SiteScope&&) = delete;
+        SiteScope& operator=(const SiteScope&) = delete;
+        SiteScope& operator=(SiteScope&&) = delete;
+    };
+
+    /* */
+
+    static inline thread_local const std::source_location* gtl_pSite {};
+
+    /* */
+
+    IAllocator* m_pBackAlloc {};
+    bool m_bAttribute {};
+    Counters m_counters {};
+    atomic::Num<isize> m_atomBytesPeak {};
+    atomic::Num<isize> m_aAtomHistogram[HISTOGRAM_SIZE] {};
+    Mutex m_mtxSites {}; /* Only for claiming new sites. */
+    Site m_aSites[MAX_SITES] {};
+    atomic::Num<isize> m_atomNSitesDropped {}; /* Allocations from sites that didn't fit. */
+
+    /* */
+
+    StatsAllocator() = default;
+    StatsAllocator(IAllocator* pBackAlloc, bool bAttribute = false) noexcept;
+
+    /* */
+
+    [[nodiscard]] virtual void* malloc(usize nBytes) noexcept(false) override final;
+    [[nodiscard]] virtual void* zalloc(usize nBytes) noexcept(false) override final;
+    [[nodiscard]] virtual void* realloc(void* ptr, usize oldNBytes, usize newNBytes) noexcept(false) override final;
+    void virtual free(void* ptr, usize nBytes) noexcept override final;
+
+    [[nodiscard]] virtual bool doesFree() const noexcept override final { return m_pBackAlloc->doesFree(); }
+    [[nodiscard]] virtual bool doesRealloc() const noexcept override final { return m_pBackAlloc->doesRealloc(); }
+
+    [[nodiscard]] virtual void* mallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* zallocAligned(usize nBytes, usize alignment) noexcept(false) override final;
+    [[nodiscard]] virtual void* reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment) noexcept(false) override final;
+    virtual void freeAligned(void* ptr, usize nBytes, usize alignment) noexcept override final;
+
+    /* */
+
+    [[nodiscard]] Snapshot snapshot() const noexcept;
+    [[nodiscard]] Snapshot siteSnapshot(isize siteI) const noexcept; /* No peak and histogram. */
+
+    void reset() noexcept; /* No concurrent allocations. */
+    isize dump(print::Builder* pBuilder) const; /* Totals, non empty histogram buckets and sites. */
+
+    void destroy() noexcept;
+
+    /* */
+
+protected:
+    [[nodiscard]] static isize histogramI(usize nBytes) noexcept;
+    [[nodiscard]] static Snapshot loadCounters(const Counters& c) noexcept;
+
+    [[nodiscard]] Counters* siteCounters() noexcept; /* nullptr if not attributing. */
+    void onMalloc(usize nBytes) noexcept;
+    void onRealloc(usize oldNBytes, usize newNBytes) noexcept;
+    void onFree(usize nBytes) noexcept;
+};
+
+inline
+StatsAllocator::SiteScope::SiteScope(std::source_location loc) noexcept
+    : m_loc {loc}, m_pPrev {gtl_pSite}
+{
+    gtl_pSite = &m_loc;
+}
+
+inline
+StatsAllocator::SiteScope::~SiteScope() noexcept
+{
+    gtl_pSite = m_pPrev;
+}
+
+inline
+StatsAllocator::StatsAllocator(IAllocator* pBackAlloc, bool bAttribute) noexcept
+    : m_pBackAlloc {pBackAlloc},
+      m_bAttribute {bAttribute},
+      m_mtxSites {Mutex::TYPE::PLAIN}
+{
+}
+
+inline void*
+StatsAllocator::malloc(usize nBytes)
+{
+    void* p = m_pBackAlloc->malloc(nBytes);
+    onMalloc(nBytes);
+    return p;
+}
+
+inline void*
+StatsAllocator::zalloc(usize nBytes)
+{
+    void* p = m_pBackAlloc->zalloc(nBytes);
+    onMalloc(nBytes);
+    return p;
+}
+
+inline void*
+StatsAllocator::realloc(void* ptr, usize oldNBytes, usize newNBytes)
+{
+    void* p = m_pBackAlloc->realloc(ptr, oldNBytes, newNBytes);
+    if (ptr) onRealloc(oldNBytes, newNBytes);
+    else onMalloc(newNBytes);
+    return p;
+}
+
+inline void
+StatsAllocator::free(void* ptr, usize nBytes) noexcept
+{
+    if (!ptr) return;
+
+    m_pBackAlloc->free(ptr, nBytes);
+    onFree(nBytes);
+}
+
+inline void*
+StatsAllocator::mallocAligned(usize nBytes, usize alignment)
+{
+    void* p = m_pBackAlloc->mallocAligned(nBytes, alignment);
+    onMalloc(nBytes);
+    return p;
+}
+
+inline void*
+StatsAllocator::zallocAligned(usize nBytes, usize alignment)
+{
+    void* p = m_pBackAlloc->zallocAligned(nBytes, alignment);
+    onMalloc(nBytes);
+    return p;
+}
+
+inline void*
+StatsAllocator::reallocAligned(void* ptr, usize oldNBytes, usize newNBytes, usize alignment)
+{
+    void* p = m_pBackAlloc->reallocAligned(ptr, oldNBytes, newNBytes, alignment);
+    if (ptr) onRealloc(oldNBytes, newNBytes);
+    else onMalloc(newNBytes);
+    return p;
+}
+
+inline void
+StatsAllocator::freeAligned(void* ptr, usize nBytes, usize alignment) noexcept
+{
+    if (!ptr) return;
+
+    m_pBackAlloc->freeAligned(ptr, nBytes, alignment);
+    onFree(nBytes);
+}
+
+inline StatsAllocator::Snapshot
+StatsAllocator::snapshot() const noexcept
+{
+    Snapshot s = loadCounters(m_counters);
+    s.bytesPeak = m_atomBytesPeak.load(atomic::ORDER::RELAXED);
+    for (isize i = 0; i < HISTOGRAM_SIZE; ++i)
+        s.aHistogram[i] = m_aAtomHistogram[i].load(atomic::ORDER::RELAXED);
+
+    return s;
+}
+
+inline StatsAllocator::Snapshot
+StatsAllocator::siteSnapshot(isize siteI) const noexcept
+{
+    return loadCounters(m_aSites[siteI].counters);
+}
+
+inline void
+StatsAllocator::reset() noexcept
+{
+    auto clZero = [](Counters* pC) {
+        pC->atomNMallocs.store(0, atomic::ORDER::RELAXED);
+        pC->atomNReallocs.store(0, atomic::ORDER::RELAXED);
+        pC->atomNFrees.store(0, atomic::ORDER::RELAXED);
+        pC->atomBytesLive.store(0, atomic::ORDER::RELAXED);
+        pC->atomBytesTotal.store(0, atomic::ORDER::RELAXED);
+    };
+
+    clZero(&m_counters);
+    m_atomBytesPeak.store(0, atomic::ORDER::RELAXED);
+    for (auto& atomBucket : m_aAtomHistogram) atomBucket.store(0, atomic::ORDER::RELAXED);
+
+    for (Site& site : m_aSites)
+    {
+        site.atomKey.store(0, atomic::ORDER::RELAXED);
+        clZero(&site.counters);
+    }
+    m_atomNSitesDropped.store(0, atomic::ORDER::RELAXED);
+}
+
+inline isize
+StatsAllocator::dump(print::Builder* pBuilder) const
+{
+    const Snapshot s = snapshot();
+
+    isize n = pBuilder->pushFmt(
+        "mallocs: {}, reallocs: {}, frees: {}, live: {} B, peak: {} B, total: {} B\n",
+        s.nMallocs, s.nReallocs, s.nFrees, s.bytesLive, s.bytesPeak, s.bytesTotal
+    );
+
+    for (isize i = 0; i < HISTOGRAM_SIZE; ++i)
+    {
+        if (s.aHistogram[i] == 0) continue;
+
+        if (i == HISTOGRAM_SIZE - 1) n += pBuilder->pushFmt("    > {} B: {}\n", usize(1) << (i - 1), s.aHistogram[i]);
+        else n += pBuilder->pushFmt("    <= {} B: {}\n", usize(1) << i, s.aHistogram[i]);
+    }
+
+    for (isize i = 0; i < MAX_SITES; ++i)
+    {
+        const Site& site = m_aSites[i];
+        if (site.atomKey.load(atomic::ORDER::ACQUIRE) == 0) continue;
+
+        const Snapshot ss = siteSnapshot(i);
+        n += pBuilder->pushFmt("    {}:{}: mallocs: {}, reallocs: {}, frees: {}, live: {} B, total: {} B\n",
+            print::shorterSourcePath(site.loc.file_name()), site.loc.line(),
+            ss.nMallocs, ss.nReallocs, ss.nFrees, ss.bytesLive, ss.bytesTotal
+        );
+    }
+
+    if (const isize nDropped = m_atomNSitesDropped.load(atomic::ORDER::RELAXED))
+        n += pBuilder->pushFmt("    (sites table full, {} allocations unattributed)\n", nDropped);
+
+    return n;
+}
+
+inline void
+StatsAllocator::destroy() noexcept
+{
+    m_mtxSites.destroy();
+    *this = {};
+}
+
+inline isize
+StatsAllocator::histogramI(usize nBytes) noexcept
+{
+    return utils::min(isize(std::bit_width(nBytes > 0 ? nBytes - 1 : 0)), HISTOGRAM_SIZE - 1);
+}
+
+inline StatsAllocator::Snapshot
+StatsAllocator::loadCounters(const Counters& c) noexcept
+{
+    return {
+        .nMallocs = c.atomNMallocs.load(atomic::ORDER::RELAXED),
+        .nReallocs = c.atomNReallocs.load(atomic::ORDER::RELAXED),
+        .nFrees = c.atomNFrees.load(atomic::ORDER::RELAXED),
+        .bytesLive = c.atomBytesLive.load(atomic::ORDER::RELAXED),
+        .bytesTotal = c.atomBytesTotal.load(atomic::ORDER::RELAXED),
+    };
+}
+
+inline StatsAllocator::Counters*
+StatsAllocator::siteCounters() noexcept
+{
+    if (!m_bAttribute || !gtl_pSite) return nullptr;
+
+    /* A site is (file pointer, line, column), the key is only its hash. */
+    const std::source_location& loc = *gtl_pSite;
+    const usize mixed = (usize(loc.file_name()) ^ (usize(loc.line()) << 20) ^ loc.column()) * 0x9e3779b97f4a7c15ull;
+    const usize key = mixed != 0 ? mixed : 1;
+
+    auto clSameSite = [&](const Site& site) {
+        return site.loc.file_name() == loc.file_name() && site.loc.line() == loc.line() && site.loc.column() == loc.column();
+    };
+
+    auto clProbe = [&](bool bClaim) -> Counters* {
+        for (isize i = 0; i < MAX_SITES; ++i)
+        {
+            Site& site = m_aSites[((mixed >> 32) + i) & (MAX_SITES - 1)];
+            const usize siteKey = site.atomKey.load(atomic::ORDER::ACQUIRE);
+            if (siteKey == key && clSameSite(site)) return &site.counters;
+            if (siteKey == 0)
+            {
+                if (!bClaim) return nullptr;
+
+                /* Release: loc is visible to whoever sees the key. */
+                site.loc = loc;
+                site.atomKey.store(key, atomic::ORDER::RELEASE);
+                return &site.counters;
+            }
+        }
+
+        return nullptr;
+    };
+
+    /* Sites are never removed: lookups are lock free, only the first allocation from a site locks. */
+    if (Counters* pC = clProbe(false)) return pC;
+
+    LockScope lock {&m_mtxSites};
+    if (Counters* pC = clProbe(true)) return pC;
+
+    m_atomNSitesDropped.fetchAdd(1, atomic::ORDER::RELAXED);
+    return nullptr;
+}
+
+inline void
+StatsAllocator::onMalloc(usize nBytes) noexcept
+{
+    m_aAtomHistogram[histogramI(nBytes)].fetchAdd(1, atomic::ORDER::RELAXED);
+
+    const isize live = m_counters.atomBytesLive.fetchAdd(nBytes, atomic::ORDER::RELAXED) + nBytes;
+    isize peak = m_atomBytesPeak.load(atomic::ORDER::RELAXED);
+    while (live > peak && !m_atomBytesPeak.compareExchangeWeak(&peak, live, atomic::ORDER::RELAXED, atomic::ORDER::RELAXED))
+        ;
+
+    auto clCount = [&](Counters* pC) {
+        pC->atomNMallocs.fetchAdd(1, atomic::ORDER::RELAXED);
+        pC->atomBytesTotal.fetchAdd(nBytes, atomic::ORDER::RELAXED);
+    };
+
+    clCount(&m_counters);
+    if (Counters* pSite = siteCounters())
+    {
+        clCount(pSite);
+        pSite->atomBytesLive.fetchAdd(nBytes, atomic::ORDER::RELAXED);
+    }
+}
+
+inline void
+StatsAllocator::onRealloc(usize oldNBytes, usize newNBytes) noexcept
+{
+    if (newNBytes > oldNBytes) m_aAtomHistogram[histogramI(newNBytes)].fetchAdd(1, atomic::ORDER::RELAXED);
+
+    const isize diff = isize(newNBytes) - isize(oldNBytes);
+    const isize live = m_counters.atomBytesLive.fetchAdd(diff, atomic::ORDER::RELAXED) + diff;
+    isize peak = m_atomBytesPeak.load(atomic::ORDER::RELAXED);
+    while (live > peak && !m_atomBytesPeak.compareExchangeWeak(&peak, live, atomic::ORDER::RELAXED, atomic::ORDER::RELAXED))
+        ;
+
+    auto clCount = [&](Counters* pC) {
+        pC->atomNReallocs.fetchAdd(1, atomic::ORDER::RELAXED);
+        if (diff > 0) pC->atomBytesTotal.fetchAdd(diff, atomic::ORDER::RELAXED);
+    };
+
+    clCount(&m_counters);
+    if (Counters* pSite = siteCounters())
+    {
+        clCount(pSite);
+        pSite->atomBytesLive.fetchAdd(diff, atomic::ORDER::RELAXED);
+    }
+}
+
+inline void
+StatsAllocator::onFree(usize nBytes) noexcept
+{
+    m_counters.atomNFrees.fetchAdd(1, atomic::ORDER::RELAXED);
+    m_counters.atomBytesLive.fetchSub(nBytes, atomic::ORDER::RELAXED);
+
+    /* Attributed to the site that frees, which is usually the one that allocated (container destroy()). */
+    if (Counters* pSite = siteCounters())
+    {
+        pSite->atomNFrees.fetchAdd(1, atomic::ORDER::RELAXED);
+        pSite->atomBytesLive.fetchSub(nBytes, atomic::ORDER::RELAXED);
+    }
+}
+
+} /* namespace adt */
@@ -127,23 +127,31 @@ protected:
     template<typename LAMBDA> StringView& removeNLEnd(LAMBDA clFill);
 };
 
-[[nodiscard]] inline String StringCat(IAllocator* p, const StringView& l, const StringView& r);
+template<IsAllocator ALLOC>
+[[nodiscard]] inline String StringCat(ALLOC* p, const StringView& l, const StringView& r);
 
 struct String : public StringView
 {
     String() = default;
-    String(IAllocator* pAlloc, const char* pChars, isize size);
-    String(IAllocator* pAlloc, const char* nts);
-    String(IAllocator* pAlloc, const Span<const char> spChars);
-    String(IAllocator* pAlloc, const Span<const char> spChars, isize size);
-    String(IAllocator* pAlloc, const StringView sv);
+    template<IsAllocator ALLOC>
+    String(ALLOC* pAlloc, const char* pChars, isize size);
+    template<IsAllocator ALLOC>
+    String(ALLOC* pAlloc, const char* nts);
+    template<IsAllocator ALLOC>
+    String(ALLOC* pAlloc, const Span<const char> spChars);
+    template<IsAllocator ALLOC>
+    String(ALLOC* pAlloc, const Span<const char> spChars, isize size);
+    template<IsAllocator ALLOC>
+    String(ALLOC* pAlloc, const StringView sv);
 
     /* */
 
     String& trimEnd(bool bPadWithZeros);
     String& removeNLEnd(bool bPadWithZeros); /* remove \r\n */
-    void destroy(IAllocator* pAlloc) noexcept;
-    void reallocWith(IAllocator* pAlloc, const StringView svWith);
+    template<IsAllocator ALLOC>
+    void destroy(ALLOC* pAlloc) noexcept;
+    template<IsAllocator ALLOC>
+    void reallocWith(ALLOC* pAlloc, const StringView svWith);
     [[nodiscard]] String release() noexcept; /* return this String resource and set to zero */
 };
 
@@ -234,8 +242,10 @@ struct VString
     /* */
 
     VString() = default;
-    VString(IAllocator* pAlloc, const StringView sv);
-    VString(IAllocator* pAlloc, isize prealloc);
+    template<IsAllocator ALLOC>
+    VString(ALLOC* pAlloc, const StringView sv);
+    template<IsAllocator ALLOC>
+    VString(ALLOC* pAlloc, isize prealloc);
 
     operator StringView() noexcept { return StringView(data(), size()); }
     operator const StringView() const noexcept { return StringView(const_cast<char*>(data()), size()); }
@@ -247,7 +257,8 @@ struct VString
 
     /* */
 
-    void destroy(IAllocator* pAlloc) noexcept;
+    template<IsAllocator ALLOC>
+    void destroy(ALLOC* pAlloc) noexcept;
     bool steal(String* pStr) noexcept;
 
     char* data() noexcept;
@@ -257,15 +268,20 @@ struct VString
     isize size() const noexcept;
     isize cap() const noexcept;
 
-    isize push(IAllocator* pAlloc, char c);
-    isize push(IAllocator* pAlloc, const StringView sv);
-    isize pushN(IAllocator* pAlloc, char c, isize nTimes);
+    template<IsAllocator ALLOC>
+    isize push(ALLOC* pAlloc, char c);
+    template<IsAllocator ALLOC>
+    isize push(ALLOC* pAlloc, const StringView sv);
+    template<IsAllocator ALLOC>
+    isize pushN(ALLOC* pAlloc, char c, isize nTimes);
 
-    void reallocWith(IAllocator* pAlloc, const StringView sv);
+    template<IsAllocator ALLOC>
+    void reallocWith(ALLOC* pAlloc, const StringView sv);
     void removeNLEnd(bool bDestructive) noexcept;
 
 protected:
-    void grow(IAllocator* pAlloc, isize newCap);
+    template<IsAllocator ALLOC>
+    void grow(ALLOC* pAlloc, isize newCap);
 };
 
 static_assert(sizeof(VString) == 24);
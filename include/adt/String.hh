@@ -575,12 +575,13 @@ StringView::removeNLEnd(LAMBDA clFill)
     return *this;
 }
 
+template<IsAllocator ALLOC>
 inline
-String::String(IAllocator* pAlloc, const char* pChars, isize size)
+String::String(ALLOC* pAlloc, const char* pChars, isize size)
 {
     if (pChars == nullptr || size <= 0) return;
 
-    char* pNewData = pAlloc->mallocV<char>(size + 1);
+    char* pNewData = pAlloc->template mallocV<char>(size + 1);
     memcpy(pNewData, pChars, size);
     pNewData[size] = '\0';
 
@@ -588,20 +589,24 @@ String::String(IAllocator* pAlloc, const char* pChars, isize size)
     m_size = size;
 }
 
+template<IsAllocator ALLOC>
 inline
-String::String(IAllocator* pAlloc, const char* nts)
+String::String(ALLOC* pAlloc, const char* nts)
     : String(pAlloc, nts, ntsSize(nts)) {}
 
+template<IsAllocator ALLOC>
 inline
-String::String(IAllocator* pAlloc, const Span<const char> spChars)
+String::String(ALLOC* pAlloc, const Span<const char> spChars)
     : String(pAlloc, spChars.m_pData, spChars.m_size) {}
 
+template<IsAllocator ALLOC>
 inline
-String::String(IAllocator* pAlloc, const Span<const char> spChars, isize size)
+String::String(ALLOC* pAlloc, const Span<const char> spChars, isize size)
     : String(pAlloc, spChars.m_pData, size) {}
 
+template<IsAllocator ALLOC>
 inline
-String::String(IAllocator* pAlloc, const StringView sv)
+String::String(ALLOC* pAlloc, const StringView sv)
     : String(pAlloc, sv.m_pData, sv.m_size) {}
 
 inline String&
@@ -622,15 +627,17 @@ String::removeNLEnd(bool bPadWithZeros)
     return *this;
 }
 
+template<IsAllocator ALLOC>
 inline void
-String::destroy(IAllocator* pAlloc) noexcept
+String::destroy(ALLOC* pAlloc) noexcept
 {
     pAlloc->free(m_pData, m_size + 1);
     *this = {};
 }
 
+template<IsAllocator ALLOC>
 inline void
-String::reallocWith(IAllocator* pAlloc, const StringView svWith)
+String::reallocWith(ALLOC* pAlloc, const StringView svWith)
 {
     if (svWith.empty())
     {
@@ -639,7 +646,7 @@ String::reallocWith(IAllocator* pAlloc, const StringView svWith)
     }
 
     if (size() < svWith.size() + 1)
-        m_pData = pAlloc->reallocV<char>(m_pData, 0, svWith.m_size + 1);
+        m_pData = pAlloc->template reallocV<char>(m_pData, 0, svWith.m_size + 1);
 
     strncpy(m_pData, svWith.m_pData, svWith.m_size);
     m_size = svWith.m_size;
@@ -718,11 +725,12 @@ StringFixed<SIZE>::operator==(const StringFixed<SIZE_R>& r) const noexcept
     return StringView(*this) == StringView(r);
 }
 
+template<IsAllocator ALLOC>
 inline String
-StringCat(IAllocator* p, const StringView& l, const StringView& r)
+StringCat(ALLOC* p, const StringView& l, const StringView& r)
 {
     isize len = l.size() + r.size();
-    char* ret = p->mallocV<char>(len + 1);
+    char* ret = p->template mallocV<char>(len + 1);
 
     strncpy(ret, l.m_pData, l.m_size);
     strncpy(ret + l.m_size, r.m_pData, r.m_size);
@@ -748,8 +756,9 @@ VString::operator[](isize i) noexcept
     return data()[i];
 }
 
+template<IsAllocator ALLOC>
 inline void
-VString::destroy(IAllocator* pAlloc) noexcept
+VString::destroy(ALLOC* pAlloc) noexcept
 {
     if (m_cap >= 17) pAlloc->free(m_allocated.pData, m_cap);
     m_cap = 16;
@@ -809,8 +818,9 @@ VString::cap() const noexcept
     return m_cap;
 }
 
+template<IsAllocator ALLOC>
 inline
-VString::VString(IAllocator* pAlloc, const StringView sv)
+VString::VString(ALLOC* pAlloc, const StringView sv)
 {
     if (sv.empty()) return;
 
@@ -821,7 +831,7 @@ VString::VString(IAllocator* pAlloc, const StringView sv)
     }
     else
     {
-        m_allocated.pData = pAlloc->mallocV<char>(sv.m_size + 1);
+        m_allocated.pData = pAlloc->template mallocV<char>(sv.m_size + 1);
         ::memcpy(m_allocated.pData, sv.m_pData, sv.m_size);
         m_allocated.pData[sv.m_size] = '\0';
         m_cap = sv.m_size + 1;
@@ -829,17 +839,19 @@ VString::VString(IAllocator* pAlloc, const StringView sv)
     }
 }
 
+template<IsAllocator ALLOC>
 inline
-VString::VString(IAllocator* pAlloc, isize prealloc)
+VString::VString(ALLOC* pAlloc, isize prealloc)
 {
     const isize newCap = utils::max(17ll, prealloc);
-    m_allocated.pData = pAlloc->zallocV<char>(newCap);
+    m_allocated.pData = pAlloc->template zallocV<char>(newCap);
     m_allocated.size = 0;
     m_cap = newCap;
 }
 
+template<IsAllocator ALLOC>
 inline isize
-VString::push(IAllocator* pAlloc, char c)
+VString::push(ALLOC* pAlloc, char c)
 {
     ADT_ASSERT(m_cap >= 16, "{}", m_cap);
     if (m_cap == 16)
@@ -848,7 +860,7 @@ VString::push(IAllocator* pAlloc, char c)
         if (firstSize + 1 >= 16)
         {
             const isize newCap = m_cap * 2;
-            char* pNew = pAlloc->zallocV<char>(newCap);
+            char* pNew = pAlloc->template zallocV<char>(newCap);
             ::memcpy(pNew, m_aBuff, firstSize);
             pNew[firstSize] = c;
 
@@ -874,8 +886,9 @@ VString::push(IAllocator* pAlloc, char c)
     }
 }
 
+template<IsAllocator ALLOC>
 inline isize
-VString::push(IAllocator* pAlloc, const StringView sv)
+VString::push(ALLOC* pAlloc, const StringView sv)
 {
     ADT_ASSERT(m_cap >= 16, "{}", m_cap);
     if (m_cap == 16)
@@ -884,7 +897,7 @@ VString::push(IAllocator* pAlloc, const StringView sv)
         if (sv.m_size + firstSize + 1 > 16)
         {
             const isize newCap = (sv.m_size + firstSize + 1) * 2;
-            char* pNew = pAlloc->zallocV<char>(newCap);
+            char* pNew = pAlloc->template zallocV<char>(newCap);
             ::memcpy(pNew, m_aBuff, firstSize);
             ::memcpy(pNew + firstSize, sv.m_pData, sv.m_size);
 
@@ -915,8 +928,9 @@ VString::push(IAllocator* pAlloc, const StringView sv)
     }
 }
 
+template<IsAllocator ALLOC>
 inline isize
-VString::pushN(IAllocator* pAlloc, char c, isize nTimes)
+VString::pushN(ALLOC* pAlloc, char c, isize nTimes)
 {
     ADT_ASSERT(m_cap >= 16, "{}", m_cap);
     if (m_cap == 16)
@@ -925,7 +939,7 @@ VString::pushN(IAllocator* pAlloc, char c, isize nTimes)
         if (nTimes + firstSize + 1 > 16)
         {
             const isize newCap = (nTimes + firstSize + 1) * 2;
-            char* pNew = pAlloc->zallocV<char>(newCap);
+            char* pNew = pAlloc->template zallocV<char>(newCap);
             ::memcpy(pNew, m_aBuff, firstSize);
             ::memset(pNew + firstSize, c, nTimes);
 
@@ -956,8 +970,9 @@ VString::pushN(IAllocator* pAlloc, char c, isize nTimes)
     }
 }
 
+template<IsAllocator ALLOC>
 inline void
-VString::reallocWith(IAllocator* pAlloc, const StringView sv)
+VString::reallocWith(ALLOC* pAlloc, const StringView sv)
 {
     ADT_ASSERT(m_cap >= 16, "{}", m_cap);
 
@@ -966,7 +981,7 @@ VString::reallocWith(IAllocator* pAlloc, const StringView sv)
         if (sv.m_size > 15)
         {
             const isize newCap = sv.m_size + 1;
-            char* pNew = pAlloc->mallocV<char>(newCap);
+            char* pNew = pAlloc->template mallocV<char>(newCap);
             ::memcpy(pNew, sv.m_pData, sv.m_size);
             pNew[sv.m_size] = '\0';
             m_allocated.pData = pNew;
@@ -1016,11 +1031,12 @@ VString::removeNLEnd(bool bDestructive) noexcept
     if (m_cap > 16) m_allocated.size = size;
 }
 
+template<IsAllocator ALLOC>
 inline void
-VString::grow(IAllocator* pAlloc, isize newCap)
+VString::grow(ALLOC* pAlloc, isize newCap)
 {
     ADT_ASSERT(m_cap >= 17, "{}", m_cap);
-    m_allocated.pData = pAlloc->reallocV<char>(m_allocated.pData, m_allocated.size, newCap);
+    m_allocated.pData = pAlloc->template reallocV<char>(m_allocated.pData, m_allocated.size, newCap);
     m_cap = newCap;
 }
 
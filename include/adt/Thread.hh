@@ -2,6 +2,7 @@
 
 #include "types.hh"
 #include "assert.hh"
+#include "atomic.hh"
 
 #include <cstring>
 #include <emmintrin.h>
@@ -18,6 +19,11 @@
 
 #ifdef __linux__
     #include <sys/sysinfo.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+    #include <unistd.h>
+
+    #define ADT_USE_LINUX_FUTEX
 
     #define ADT_GET_NPROCS() get_nprocs()
 
@@ -454,6 +460,125 @@ Mutex::destroy()
 #endif
 }
 
+/* Many readers or one writer. */
+struct RWLock
+{
+#ifdef ADT_USE_PTHREAD
+
+    pthread_rwlock_t m_lock {};
+
+#elif defined ADT_USE_WIN32THREAD
+
+    SRWLOCK m_lock {};
+
+#endif
+
+    /* */
+
+    RWLock() = default;
+    explicit RWLock(InitFlag) noexcept;
+
+    /* */
+
+    void lock(); /* Exclusive. */
+    void unlock();
+    void lockShared();
+    void unlockShared();
+    void destroy();
+};
+
+inline
+RWLock::RWLock(InitFlag) noexcept
+{
+#ifdef ADT_USE_PTHREAD
+
+    [[maybe_unused]] int err = pthread_rwlock_init(&m_lock, nullptr);
+    ADT_ASSERT(err == 0, "err: {}, ({})", err, strerror(err));
+
+#elif defined ADT_USE_WIN32THREAD
+
+    InitializeSRWLock(&m_lock);
+
+#endif
+}
+
+inline void
+RWLock::lock()
+{
+#ifdef ADT_USE_PTHREAD
+
+    [[maybe_unused]] int err = pthread_rwlock_wrlock(&m_lock);
+    ADT_ASSERT(err == 0, "err: {}, ({})", err, strerror(err));
+
+#elif defined ADT_USE_WIN32THREAD
+
+    AcquireSRWLockExclusive(&m_lock);
+
+#endif
+}
+
+inline void
+RWLock::unlock()
+{
+#ifdef ADT_USE_PTHREAD
+
+    [[maybe_unused]] int err = pthread_rwlock_unlock(&m_lock);
+    ADT_ASSERT(err == 0, "err: {}, ({})", err, strerror(err));
+
+#elif defined ADT_USE_WIN32THREAD
+
+    ReleaseSRWLockExclusive(&m_lock);
+
+#endif
+}
+
+inline void
+RWLock::lockShared()
+{
+#ifdef ADT_USE_PTHREAD
+
+    [[maybe_unused]] int err = pthread_rwlock_rdlock(&m_lock);
+    ADT_ASSERT(err == 0, "err: {}, ({})", err, strerror(err));
+
+#elif defined ADT_USE_WIN32THREAD
+
+    AcquireSRWLockShared(&m_lock);
+
+#endif
+}
+
+inline void
+RWLock::unlockShared()
+{
+#ifdef ADT_USE_PTHREAD
+
+    [[maybe_unused]] int err = pthread_rwlock_unlock(&m_lock);
+    ADT_ASSERT(err == 0, "err: {}, ({})", err, strerror(err));
+
+#elif defined ADT_USE_WIN32THREAD
+
+    ReleaseSRWLockShared(&m_lock);
+
+#endif
+}
+
+inline void
+RWLock::destroy()
+{
+#ifdef ADT_USE_PTHREAD
+
+    [[maybe_unused]] int err = pthread_rwlock_destroy(&m_lock);
+    ADT_ASSERT(err == 0, "err: {}, ({})", err, strerror(err));
+    *this = {};
+
+#elif defined ADT_USE_WIN32THREAD
+
+    /* SRW locks don't need to be destroyed. */
+    *this = {};
+
+#endif
+}
+
 struct CndVar
 {
 #ifdef ADT_USE_PTHREAD
@@ -648,6 +773,68 @@ CallOnce::exec(void (*pfn)())
 #endif
 }
 
+/* Sleep/wake on the address of a 32-bit word.
+ * futex(2) on linux, WaitOnAddress() on windows, falls back to yielding elsewhere. */
+namespace futex
+{
+
+/* Sleeps while *pWord == expected, can wake up spuriously. */
+inline void
+wait(const atomic::Int* pWord, i32 expected) noexcept
+{
+#ifdef ADT_USE_LINUX_FUTEX
+
+    syscall(SYS_futex, &pWord->m_volInt, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+
+#elif defined ADT_USE_WIN32THREAD
+
+    WaitOnAddress((volatile void*)&pWord->m_volInt, &expected, sizeof(expected), INFINITE);
+
+#else
+
+    if (pWord->load(atomic::ORDER::ACQUIRE) == expected) Thread::yield();
+
+#endif
+}
+
+inline void
+wakeOne(atomic::Int* pWord) noexcept
+{
+#ifdef ADT_USE_LINUX_FUTEX
+
+    syscall(SYS_futex, &pWord->m_volInt, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+
+#elif defined ADT_USE_WIN32THREAD
+
+    WakeByAddressSingle((void*)&pWord->m_volInt);
+
+#else
+
+    (void)pWord;
+
+#endif
+}
+
+inline void
+wakeAll(atomic::Int* pWord) noexcept
+{
+#ifdef ADT_USE_LINUX_FUTEX
+
+    syscall(SYS_futex, &pWord->m_volInt, FUTEX_WAKE_PRIVATE, 0x7fffffff, nullptr, nullptr, 0);
+
+#elif defined ADT_USE_WIN32THREAD
+
+    WakeByAddressAll((void*)&pWord->m_volInt);
+
+#else
+
+    (void)pWord;
+
+#endif
+}
+
+} /* namespace futex */
+
 template<typename T>
 struct LockScope
 {
@@ -662,26 +849,115 @@ protected:
     T* pMtx {};
 };
 
+template<typename T>
+struct LockSharedScope
+{
+    using LockType = T;
+
+    /* */
+
+    LockSharedScope(T* _pLock) : pLock(_pLock) { pLock->lockShared(); }
+    ~LockSharedScope() { pLock->unlockShared(); }
+
+protected:
+    T* pLock {};
+};
+
+/* Mutex-free sleeping until some condition becomes true.
+ * Waiter:
+ *     while (true)
+ *     {
+ *         const i32 key = ec.prepareWait();
+ *         if (condition()) { ec.cancelWait(); break; }
+ *         ec.wait(key);
+ *     }
+ * Notifier: make condition() true, then ec.notifyOne() / ec.notifyAll() (no syscalls if nobody waits). */
+struct EventCount
+{
+    atomic::Int m_atomEpoch {}; /* Futex word. */
+    atomic::Int m_atomNWaiters {};
+
+    /* */
+
+    [[nodiscard]] i32 prepareWait() noexcept;
+    void cancelWait() noexcept;
+    void wait(i32 key) noexcept;
+    void notifyOne() noexcept;
+    void notifyAll() noexcept;
+};
+
+inline i32
+EventCount::prepareWait() noexcept
+{
+    m_atomNWaiters.fetchAdd(1, atomic::ORDER::SEQ_CST);
+    atomic::fence(atomic::ORDER::SEQ_CST); /* Condition check must not float above the increment. */
+    return m_atomEpoch.load(atomic::ORDER::ACQUIRE);
+}
+
+inline void
+EventCount::cancelWait() noexcept
+{
+    m_atomNWaiters.fetchSub(1, atomic::ORDER::RELAXED);
+}
+
+inline void
+EventCount::wait(i32 key) noexcept
+{
+    /* Any notify after prepareWait() bumps the epoch, so this won't sleep through it. */
+    while (m_atomEpoch.load(atomic::ORDER::ACQUIRE) == key)
+        futex::wait(&m_atomEpoch, key);
+
+    m_atomNWaiters.fetchSub(1, atomic::ORDER::RELAXED);
+}
+
+inline void
+EventCount::notifyOne() noexcept
+{
+    atomic::fence(atomic::ORDER::SEQ_CST); /* Pairs with prepareWait(). */
+    if (m_atomNWaiters.load(atomic::ORDER::RELAXED) > 0)
+    {
+        m_atomEpoch.fetchAdd(1, atomic::ORDER::RELEASE);
+        futex::wakeOne(&m_atomEpoch);
+    }
+}
+
+inline void
+EventCount::notifyAll() noexcept
+{
+    atomic::fence(atomic::ORDER::SEQ_CST);
+    if (m_atomNWaiters.load(atomic::ORDER::RELAXED) > 0)
+    {
+        m_atomEpoch.fetchAdd(1, atomic::ORDER::RELEASE);
+        futex::wakeAll(&m_atomEpoch);
+    }
+}
+
 namespace details
 {
 
+/* One word: signal() is a single exchange, wait() spins first and then sleeps on a futex. */
 struct Future
 {
-    Mutex m_mtx {};
-    CndVar m_cnd {};
-    bool m_bDone {};
+    enum STATE : i32 { EMPTY, WAITING, DONE };
+
+    static constexpr int SPIN_COUNT = 128;
+
+    /* */
+
+    atomic::Int m_atomState {};
 
     /* */
 
     Future() = default;
-    Future(InitFlag);
+    Future(InitFlag) {}
 
     /* */
 
     void wait();
+    bool done() const noexcept { return m_atomState.load(atomic::ORDER::ACQUIRE) == DONE; }
     void signal();
     void reset();
-    void destroy();
+    void destroy() {} /* Nothing to release, kept for compatibility. */
 };
 
 } /* namespace details */
@@ -710,37 +986,41 @@ struct Future<void> : details::Future
     using details::Future::Future;
 };
 
-inline
-details::Future::Future(InitFlag)
-    : m_mtx(Mutex::TYPE::PLAIN), m_cnd(INIT) {}
-
 inline void
 details::Future::wait()
 {
-    LockScope lock {&m_mtx};
-    while (!m_bDone) m_cnd.wait(&m_mtx);
+    for (int i = 0; i < SPIN_COUNT; ++i)
+    {
+        if (m_atomState.load(atomic::ORDER::ACQUIRE) == DONE) return;
+        _mm_pause();
+    }
+
+    i32 state = m_atomState.load(atomic::ORDER::ACQUIRE);
+    while (state != DONE)
+    {
+        if (state == EMPTY &&
+            !m_atomState.compareExchange(&state, WAITING, atomic::ORDER::ACQUIRE, atomic::ORDER::ACQUIRE)
+        )
+        {
+            continue; /* state is reloaded by the failed CAS. */
+        }
+
+        futex::wait(&m_atomState, WAITING);
+        state = m_atomState.load(atomic::ORDER::ACQUIRE);
+    }
 }
 
 inline void
 details::Future::signal()
 {
-    LockScope lock {&m_mtx};
-
-    m_bDone = true;
-    m_cnd.signal();
+    if (m_atomState.exchange(DONE, atomic::ORDER::RELEASE) == WAITING)
+        futex::wakeAll(&m_atomState);
 }
 
 inline void
 details::Future::reset()
 {
-    m_bDone = false;
-}
-
-inline void
-details::Future::destroy()
-{
-    m_mtx.destroy();
-    m_cnd.destroy();
+    m_atomState.store(EMPTY, atomic::ORDER::RELAXED);
 }
 
 } /* namespace adt */
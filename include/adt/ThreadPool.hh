@@ -281,7 +281,7 @@ ThreadPool::destroy() noexcept
 
         ADT_ASSERT(m_atomNActiveTasks.load(atomic::ORDER::ACQUIRE) == 0, "{}", m_atomNActiveTasks.load(atomic::ORDER::RELAXED));
 
-        Gpa::inst()->free(m_spThreads.data());
+        Gpa::inst()->freeV(m_spThreads.data(), m_spThreads.size());
         m_qTasks.destroy();
         m_mtxQ.destroy();
         m_cndQ.destroy();
@@ -407,4 +407,47 @@ parallelFor(IArena* pArena, THREAD_POOL_T* pTp, Span<T> spData, CL_PROC_BATCH cl
     return vFutures;
 }
 
+/* Blocking parallel loop over a VecSOA (anything with size() and column<MEMBER>()).
+ * Calls clProcBatch(off, size) on the pool and on the calling thread, batch bounds are multiples of
+ * CACHE_LINE_ELEMS elements. VecSOA columns start on cache lines, so there batches never split a line of any column
+ * (columns of at least 1 byte elements); containers with unaligned columns get false sharing at the bounds.
+ * Usage example:
+ * parallelForSOA(&tp, vEntities, [&](isize off, isize size) {
+ *     auto spPos = vEntities.column<&Entity::pos>(off, size);
+ *     auto spVel = vEntities.column<&Entity::vel>(off, size);
+ *     for (isize i = 0; i < size; ++i) spPos[i] += spVel[i] * dt;
+ * }); */
+template<typename SOA_T, typename CL_PROC_BATCH>
+inline void
+parallelForSOA(IThreadPool* pTp, SOA_T& soa, CL_PROC_BATCH clProcBatch, isize minBatchSize = 1024)
+{
+    constexpr isize CACHE_LINE_ELEMS = 64;
+
+    const isize size = soa.size();
+    if (size <= 0) return;
+
+    /* The calling thread takes the first batch. */
+    const isize nWorkers = pTp->nThreads() + 1;
+    const isize batchSize = alignUpPO2(
+        utils::max((size + nWorkers - 1) / nWorkers, minBatchSize), CACHE_LINE_ELEMS
+    );
+    const isize nBatches = (size + batchSize - 1) / batchSize;
+
+    atomic::Int atomNLeft {i32(nBatches - 1)};
+    IThreadPool::Future<void> fut {pTp};
+    if (nBatches == 1) fut.signal();
+
+    for (isize i = 1; i < nBatches; ++i)
+    {
+        const isize off = i * batchSize;
+        pTp->addRetry([&, off] {
+            clProcBatch(off, utils::min(batchSize, size - off));
+            if (atomNLeft.fetchSub(1, atomic::ORDER::ACQ_REL) == 1) fut.signal();
+        });
+    }
+
+    clProcBatch(0, utils::min(batchSize, size));
+    fut.wait();
+}
+
 } /* namespace adt */
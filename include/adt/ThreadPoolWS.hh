@@ -0,0 +1,394 @@
+#pragma once
+
+#include "ThreadPool.hh"
+#include "DequeWS.hh"
+#include "QueueMPMC.hh"
+
+namespace adt
+{
+
+/* Work-stealing pool: every worker owns a DequeWS, tasks added from a worker go to its own deque,
+ * tasks added from other threads go to the lock-free global injection queue, idle workers steal from peers.
+ * Idle workers sleep on an EventCount, so adding a task to a busy pool doesn't make a syscall. */
+struct ThreadPoolWS final : IThreadPool
+{
+    static constexpr int SPIN_COUNT = 64; /* Tries to find a task before going to sleep. */
+
+    /* */
+
+    struct Worker
+    {
+        DequeWS<Task> dqTasks {};
+        u32 rngState {};
+        DequeWS<Task>::CacheLinePad pad {};
+    };
+
+    /* */
+
+    Span<Thread> m_spThreads {};
+    Span<Worker> m_spWorkers {};
+    QueueMPMC<Task> m_qTasks {};
+    EventCount m_ecSleep {}; /* Idle workers. */
+    EventCount m_ecIdle {}; /* wait() callers. */
+    void (*m_pfnLoopStart)(void*) {};
+    void* m_pLoopStartArg {};
+    void (*m_pfnLoopEnd)(void*) {};
+    void* m_pLoopEndArg {};
+    atomic::Int m_atomNActiveTasks {};
+    atomic::Int m_atomNQueued {}; /* Tasks in all deques and in m_qTasks. */
+    atomic::Int m_atomBDone {};
+    atomic::Int m_atomIdCounter {};
+    bool m_bStarted {};
+    isize m_arenaReserved {};
+    ArenaType* (*m_pfnAllocArena)(isize reserve) {};
+
+    /* */
+
+    static inline thread_local int gtl_threadId {};
+    static inline thread_local ArenaType* gtl_pArena {};
+    static inline thread_local ThreadPoolWS* gtl_pOwner {}; /* Pool that owns this worker thread. */
+    static inline thread_local Worker* gtl_pWorker {};
+
+    /* */
+
+    /* NOTE: ARENA_T&& use default constructor to match templalate (like `Arena{}`). */
+
+    template<typename ARENA_T>
+    ThreadPoolWS(ARENA_T&& /* empty */, isize qSize, isize arenaReserve, int nThreads = optimalThreadCount());
+
+    template<typename ARENA_T>
+    ThreadPoolWS(
+        ARENA_T&& /* empty */,
+        void (*pfnOnLoopStart)(void*),
+        void* pLoopStartArg,
+        void (*pfnOnLoopEnd)(void*),
+        void* pLoopEndArg,
+        isize qSize,
+        isize arenaReserve,
+        int nThreads = optimalThreadCount()
+    );
+
+    /* */
+
+    virtual const atomic::Int& nActiveTasks() const noexcept override { return m_atomNActiveTasks; }
+    virtual void wait(bool bHelp) noexcept override;
+    virtual bool addTask(void (*pfn)(void*), void* pArg, isize argSize) noexcept override;
+    virtual int nThreads() const noexcept override { return m_spThreads.size(); }
+    virtual Task tryStealTask() noexcept override;
+    virtual usize threadId() noexcept override;
+    virtual ArenaType* createArenaForThisThread(isize reserve) noexcept override;
+    virtual void destroyArenaForThisThread() noexcept override;
+    virtual ArenaType* arena() noexcept override;
+
+    /* */
+
+    void destroy() noexcept;
+
+protected:
+    void start(isize qSize);
+    THREAD_STATUS loop();
+    Task findTask() noexcept;
+    void runTask(const Task& task) noexcept;
+    void signalIfIdle() noexcept;
+};
+
+template<typename ARENA_T>
+inline
+ThreadPoolWS::ThreadPoolWS(ARENA_T&&, isize qSize, isize arenaReserve, int nThreads)
+    : m_spThreads(Gpa::inst()->zallocV<Thread>(nThreads), nThreads),
+      m_spWorkers(Gpa::inst()->zallocV<Worker>(nThreads), nThreads),
+      m_qTasks(qSize),
+      m_arenaReserved(arenaReserve),
+      m_pfnAllocArena([](isize reserve) { return static_cast<ArenaType*>(Gpa::inst()->alloc<ARENA_T>(reserve)); })
+{
+    start(qSize);
+}
+
+template<typename ARENA_T>
+inline
+ThreadPoolWS::ThreadPoolWS(
+    ARENA_T&&,
+    void (*pfnOnLoopStart)(void*), void* pLoopStartArg,
+    void (*pfnOnLoopEnd)(void*), void* pLoopEndArg,
+    isize qSize,
+    isize arenaReserve,
+    int nThreads
+)
+    : m_spThreads(Gpa::inst()->zallocV<Thread>(nThreads), nThreads),
+      m_spWorkers(Gpa::inst()->zallocV<Worker>(nThreads), nThreads),
+      m_qTasks(qSize),
+      m_pfnLoopStart(pfnOnLoopStart),
+      m_pLoopStartArg(pLoopStartArg),
+      m_pfnLoopEnd(pfnOnLoopEnd),
+      m_pLoopEndArg(pLoopEndArg),
+      m_arenaReserved(arenaReserve),
+      m_pfnAllocArena([](isize reserve) { return static_cast<ArenaType*>(Gpa::inst()->alloc<ARENA_T>(reserve)); })
+{
+    start(qSize);
+}
+
+inline void
+ThreadPoolWS::start(isize qSize)
+{
+    for (isize i = 0; i < m_spWorkers.size(); ++i)
+    {
+        new(&m_spWorkers[i]) Worker {};
+        m_spWorkers[i].dqTasks = DequeWS<Task> {qSize};
+        m_spWorkers[i].rngState = u32(i) * 0x9e3779b9u + 1;
+    }
+
+    m_atomIdCounter.fetchAdd(1, atomic::ORDER::RELAXED); /* Id 0 for the main thread. */
+    for (auto& thread : m_spThreads)
+    {
+        thread = Thread(
+            reinterpret_cast<ThreadFn>(methodPointerNonVirtual(&ThreadPoolWS::loop)),
+            this
+        );
+    }
+
+    ADT_ASSERT(m_pfnAllocArena != nullptr, "");
+    gtl_pArena = m_pfnAllocArena(m_arenaReserved);
+
+    m_bStarted = true;
+
+    while (m_atomIdCounter.load(atomic::ORDER::RELAXED) <= m_spThreads.size())
+        Thread::yield();
+}
+
+inline THREAD_STATUS
+ThreadPoolWS::loop()
+{
+    if (m_pfnLoopStart) m_pfnLoopStart(m_pLoopStartArg);
+    ADT_DEFER( if (m_pfnLoopEnd) m_pfnLoopEnd(m_pLoopEndArg) );
+
+    ADT_ASSERT(m_pfnAllocArena != nullptr, "");
+
+    gtl_pArena = m_pfnAllocArena(m_arenaReserved);
+    ADT_DEFER(
+        gtl_pArena->freeAll();
+        Gpa::inst()->free(gtl_pArena);
+        gtl_pArena = nullptr;
+    );
+
+    gtl_threadId = m_atomIdCounter.fetchAdd(1, atomic::ORDER::RELAXED);
+    gtl_pOwner = this;
+    gtl_pWorker = &m_spWorkers[gtl_threadId - 1];
+    ADT_DEFER(
+        gtl_pOwner = nullptr;
+        gtl_pWorker = nullptr;
+    );
+
+    while (true)
+    {
+        Task task = findTask();
+
+        for (int i = 0; !task && i < SPIN_COUNT; ++i)
+        {
+            _mm_pause();
+            task = findTask();
+        }
+
+        if (task)
+        {
+            runTask(task);
+            continue;
+        }
+
+        const i32 key = m_ecSleep.prepareWait();
+
+        if (m_atomNQueued.load(atomic::ORDER::SEQ_CST) <= 0 && !m_atomBDone.load(atomic::ORDER::ACQUIRE))
+            m_ecSleep.wait(key);
+        else m_ecSleep.cancelWait();
+
+        if (m_atomBDone.load(atomic::ORDER::ACQUIRE))
+            return 0;
+    }
+
+    return THREAD_STATUS(0);
+}
+
+inline IThreadPool::Task
+ThreadPoolWS::findTask() noexcept
+{
+    Worker* pSelf = gtl_pOwner == this ? gtl_pWorker : nullptr;
+
+    if (pSelf)
+    {
+        if (Opt<Task> oTask = pSelf->dqTasks.popBack())
+        {
+            m_atomNActiveTasks.fetchAdd(1, atomic::ORDER::RELAXED);
+            m_atomNQueued.fetchSub(1, atomic::ORDER::RELAXED);
+            return oTask.value();
+        }
+    }
+
+    if (Opt<Task> oTask = m_qTasks.pop())
+    {
+        m_atomNActiveTasks.fetchAdd(1, atomic::ORDER::RELAXED);
+        m_atomNQueued.fetchSub(1, atomic::ORDER::RELAXED);
+        return oTask.value();
+    }
+
+    /* Pick a random victim and walk through the rest. */
+    const isize nWorkers = m_spWorkers.size();
+    isize startI = 0;
+    if (pSelf)
+    {
+        u32 x = pSelf->rngState;
+        x ^= x << 13, x ^= x >> 17, x ^= x << 5;
+        pSelf->rngState = x;
+        startI = x % nWorkers;
+    }
+
+    for (isize i = 0; i < nWorkers; ++i)
+    {
+        Worker* pVictim = &m_spWorkers[(startI + i) % nWorkers];
+        if (pVictim == pSelf) continue;
+
+        if (Opt<Task> oTask = pVictim->dqTasks.steal())
+        {
+            m_atomNActiveTasks.fetchAdd(1, atomic::ORDER::RELAXED);
+            m_atomNQueued.fetchSub(1, atomic::ORDER::RELAXED);
+            return oTask.value();
+        }
+    }
+
+    return {};
+}
+
+inline void
+ThreadPoolWS::runTask(const Task& task) noexcept
+{
+    task();
+    m_atomNActiveTasks.fetchSub(1, atomic::ORDER::ACQ_REL);
+    signalIfIdle();
+}
+
+inline void
+ThreadPoolWS::signalIfIdle() noexcept
+{
+    if (m_atomNActiveTasks.load(atomic::ORDER::ACQUIRE) <= 0 && m_atomNQueued.load(atomic::ORDER::ACQUIRE) <= 0)
+        m_ecIdle.notifyAll();
+}
+
+inline bool
+ThreadPoolWS::addTask(void (*pfn)(void*), void* pArg, isize argSize) noexcept
+{
+    ADT_ASSERT(m_bStarted, "forgot to `start()` this ThreadPoolWS: (m_bStarted: '{}')", m_bStarted);
+
+    /* Count before publishing, so that wait() never sees an empty pool with a pending task. */
+    m_atomNQueued.fetchAdd(1, atomic::ORDER::SEQ_CST);
+
+    bool bPushed = false;
+    if (gtl_pOwner == this)
+        bPushed = gtl_pWorker->dqTasks.pushBack(Task {pfn, pArg, argSize});
+
+    if (!bPushed)
+        bPushed = m_qTasks.emplace(pfn, pArg, argSize);
+
+    if (!bPushed)
+    {
+        m_atomNQueued.fetchSub(1, atomic::ORDER::RELAXED);
+        return false;
+    }
+
+    m_ecSleep.notifyOne();
+    return true;
+}
+
+inline IThreadPool::Task
+ThreadPoolWS::tryStealTask() noexcept
+{
+    Task task = findTask();
+
+    /* Caller runs it, so it's not tracked as active. */
+    if (task)
+    {
+        m_atomNActiveTasks.fetchSub(1, atomic::ORDER::RELEASE);
+        signalIfIdle();
+    }
+
+    return task;
+}
+
+inline void
+ThreadPoolWS::wait(bool bHelp) noexcept
+{
+    if (m_spThreads.size() <= 0) return;
+
+    if (bHelp)
+    {
+        Task task {};
+        while ((task = findTask()))
+            runTask(task);
+    }
+
+    while (true)
+    {
+        const i32 key = m_ecIdle.prepareWait();
+        if (m_atomNQueued.load(atomic::ORDER::ACQUIRE) <= 0 && m_atomNActiveTasks.load(atomic::ORDER::ACQUIRE) <= 0)
+        {
+            m_ecIdle.cancelWait();
+            break;
+        }
+        m_ecIdle.wait(key);
+    }
+}
+
+inline void
+ThreadPoolWS::destroy() noexcept
+{
+    if (!m_spThreads.empty())
+    {
+        wait(true);
+
+        m_atomBDone.store(true, atomic::ORDER::RELEASE);
+        m_ecSleep.notifyAll();
+
+        for (auto& thread : m_spThreads)
+            thread.join();
+
+        ADT_ASSERT(m_atomNActiveTasks.load(atomic::ORDER::ACQUIRE) == 0, "{}", m_atomNActiveTasks.load(atomic::ORDER::RELAXED));
+
+        for (auto& worker : m_spWorkers)
+            worker.dqTasks.destroy();
+
+        Gpa::inst()->freeV(m_spThreads.data(), m_spThreads.size());
+        Gpa::inst()->freeV(m_spWorkers.data(), m_spWorkers.size());
+        m_qTasks.destroy();
+    }
+
+    gtl_pArena->freeAll();
+    Gpa::inst()->free(gtl_pArena);
+    gtl_pArena = nullptr;
+}
+
+inline usize
+ThreadPoolWS::threadId() noexcept
+{
+    return gtl_threadId;
+}
+
+inline ThreadPoolWS::ArenaType*
+ThreadPoolWS::createArenaForThisThread(isize reserve) noexcept
+{
+    ADT_ASSERT(gtl_pArena == nullptr, "arena already exists");
+    return gtl_pArena = m_pfnAllocArena(reserve);
+}
+
+inline void
+ThreadPoolWS::destroyArenaForThisThread() noexcept
+{
+    ADT_ASSERT(gtl_pArena != nullptr, "createArenaForThisThread() was not called before");
+    gtl_pArena->freeAll();
+    Gpa::inst()->free(gtl_pArena);
+    gtl_pArena = nullptr;
+}
+
+inline ThreadPoolWS::ArenaType*
+ThreadPoolWS::arena() noexcept
+{
+    return gtl_pArena;
+}
+
+} /* namespace adt */
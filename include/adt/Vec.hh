@@ -20,12 +20,14 @@ struct Vec
 
     Vec() = default;
 
-    Vec(IAllocator* p, isize prealloc = SIZE_MIN)
-        : m_pData(p->zallocV<T>(prealloc)),
+    template<IsAllocator ALLOC>
+    Vec(ALLOC* p, isize prealloc = SIZE_MIN)
+        : m_pData(p->template zallocV<T>(prealloc)),
           m_size(0),
           m_capacity(prealloc) {}
 
-    Vec(IAllocator* p, isize preallocSize, const T& fillWith);
+    template<IsAllocator ALLOC>
+    Vec(ALLOC* p, isize preallocSize, const T& fillWith);
 
     /* */
 
@@ -43,23 +45,30 @@ struct Vec
 
     [[nodiscard]] bool empty() const noexcept { return m_size <= 0; }
 
-    isize fakePush(IAllocator* p);
+    template<IsAllocator ALLOC>
+    isize fakePush(ALLOC* p);
 
-    isize push(IAllocator* p, const T& data);
-    isize push(IAllocator* p, T&& data);
+    template<IsAllocator ALLOC>
+    isize push(ALLOC* p, const T& data);
+    template<IsAllocator ALLOC>
+    isize push(ALLOC* p, T&& data);
 
-    void pushAt(IAllocator* p, const isize atI, const T& data);
-    void pushAt(IAllocator* p, const isize atI, T&& data);
+    template<IsAllocator ALLOC>
+    void pushAt(ALLOC* p, const isize atI, const T& data);
+    template<IsAllocator ALLOC>
+    void pushAt(ALLOC* p, const isize atI, T&& data);
 
-    isize pushSpan(IAllocator* p, const Span<const T> sp);
+    template<IsAllocator ALLOC>
+    isize pushSpan(ALLOC* p, const Span<const T> sp);
 
-    void pushSpanAt(IAllocator* p, const isize atI, const Span<const T> sp);
+    template<IsAllocator ALLOC>
+    void pushSpanAt(ALLOC* p, const isize atI, const Span<const T> sp);
 
-    template<typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
-    isize emplace(IAllocator* p, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
+    isize emplace(ALLOC* p, ARGS&&... args);
 
-    template<typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
-    void emplaceAt(IAllocator* p, const isize atI, ARGS&&... args);
+    template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
+    void emplaceAt(ALLOC* p, const isize atI, ARGS&&... args);
 
     [[nodiscard]] T& last() noexcept;
 
@@ -71,9 +80,11 @@ struct Vec
 
     T pop() noexcept;
 
-    void setSize(IAllocator* p, isize size);
+    template<IsAllocator ALLOC>
+    void setSize(ALLOC* p, isize size);
 
-    void setCap(IAllocator* p, isize cap);
+    template<IsAllocator ALLOC>
+    void setCap(ALLOC* p, isize cap);
 
     void swapWithLast(isize i) noexcept;
 
@@ -85,7 +96,8 @@ struct Vec
 
     [[nodiscard]] isize lastI() const noexcept;
 
-    void destroy(IAllocator* p) noexcept;
+    template<IsAllocator ALLOC>
+    void destroy(ALLOC* p) noexcept;
 
     [[nodiscard]] Vec<T> release() noexcept;
 
@@ -99,17 +111,21 @@ struct Vec
 
     void zeroOut() noexcept; /* set size to zero and memset */
 
-    [[nodiscard]] Vec<T> clone(IAllocator* pAlloc) const;
+    template<IsAllocator ALLOC>
+    [[nodiscard]] Vec<T> clone(ALLOC* pAlloc) const;
 
     [[nodiscard]] bool search(const T& x) const;
 
     /* */
 
 private:
-    void grow(IAllocator* p, isize newCapacity);
+    template<IsAllocator ALLOC>
+    void grow(ALLOC* p, isize newCapacity);
 
-    void growIfNeeded(IAllocator* p);
-    void growOnSpanPush(IAllocator* p, const isize spanSize);
+    template<IsAllocator ALLOC>
+    void growIfNeeded(ALLOC* p);
+    template<IsAllocator ALLOC>
+    void growOnSpanPush(ALLOC* p, const isize spanSize);
 
 public:
 
@@ -127,8 +143,9 @@ public:
 };
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline
-Vec<T>::Vec(IAllocator* p, isize prealloc, const T& defaultVal)
+Vec<T>::Vec(ALLOC* p, isize prealloc, const T& defaultVal)
     : Vec(p, prealloc)
 {
     setSize(p, prealloc);
@@ -137,16 +154,18 @@ Vec<T>::Vec(IAllocator* p, isize prealloc, const T& defaultVal)
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline isize
-Vec<T>::fakePush(IAllocator* p)
+Vec<T>::fakePush(ALLOC* p)
 {
     growIfNeeded(p);
     return ++m_size - 1;
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline isize
-Vec<T>::push(IAllocator* p, const T& data)
+Vec<T>::push(ALLOC* p, const T& data)
 {
     growIfNeeded(p);
     new(m_pData + m_size++) T(data);
@@ -154,8 +173,9 @@ Vec<T>::push(IAllocator* p, const T& data)
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline isize
-Vec<T>::push(IAllocator* p, T&& data)
+Vec<T>::push(ALLOC* p, T&& data)
 {
     growIfNeeded(p);
     new(m_pData + m_size++) T {std::move(data)};
@@ -163,22 +183,25 @@ Vec<T>::push(IAllocator* p, T&& data)
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::pushAt(IAllocator* p, const isize atI, const T& data)
+Vec<T>::pushAt(ALLOC* p, const isize atI, const T& data)
 {
     emplaceAt(p, atI, data);
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::pushAt(IAllocator* p, const isize atI, T&& data)
+Vec<T>::pushAt(ALLOC* p, const isize atI, T&& data)
 {
     emplaceAt(p, atI, std::move(data));
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline isize
-Vec<T>::pushSpan(IAllocator* p, const Span<const T> sp)
+Vec<T>::pushSpan(ALLOC* p, const Span<const T> sp)
 {
     growOnSpanPush(p, sp.size());
     utils::memCopy(m_pData + m_size, sp.data(), sp.size());
@@ -190,8 +213,9 @@ Vec<T>::pushSpan(IAllocator* p, const Span<const T> sp)
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::pushSpanAt(IAllocator* p, const isize atI, const Span<const T> sp)
+Vec<T>::pushSpanAt(ALLOC* p, const isize atI, const Span<const T> sp)
 {
     growOnSpanPush(p, sp.size());
     m_size += sp.size();
@@ -202,9 +226,9 @@ Vec<T>::pushSpanAt(IAllocator* p, const isize atI, const Span<const T> sp)
 }
 
 template<typename T>
-template<typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
+template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
 inline isize
-Vec<T>::emplace(IAllocator* p, ARGS&&... args)
+Vec<T>::emplace(ALLOC* p, ARGS&&... args)
 {
     growIfNeeded(p);
     new(m_pData + m_size++) T(std::forward<ARGS>(args)...);
@@ -212,9 +236,9 @@ Vec<T>::emplace(IAllocator* p, ARGS&&... args)
 }
 
 template<typename T>
-template<typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
+template<IsAllocator ALLOC, typename ...ARGS> requires(std::is_constructible_v<T, ARGS...>)
 inline void
-Vec<T>::emplaceAt(IAllocator* p, const isize atI, ARGS&&... args)
+Vec<T>::emplaceAt(ALLOC* p, const isize atI, ARGS&&... args)
 {
     growIfNeeded(p);
     ADT_ASSERT(atI >= 0 && atI < size() + 1, "atI: {}, size + 1: {}", atI, size() + 1);
@@ -267,8 +291,9 @@ Vec<T>::pop() noexcept
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::setSize(IAllocator* p, isize size)
+Vec<T>::setSize(ALLOC* p, isize size)
 {
     if (m_capacity < size) grow(p, size);
 
@@ -276,8 +301,9 @@ Vec<T>::setSize(IAllocator* p, isize size)
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::setCap(IAllocator* p, isize cap)
+Vec<T>::setCap(ALLOC* p, isize cap)
 {
     if (cap == 0)
     {
@@ -285,7 +311,7 @@ Vec<T>::setCap(IAllocator* p, isize cap)
         return;
     }
 
-    m_pData = p->relocate<T>(m_pData, m_capacity, cap);
+    m_pData = p->template relocate<T>(m_pData, m_capacity, cap);
     m_capacity = cap;
 
     if (m_size > cap) m_size = cap;
@@ -342,10 +368,15 @@ Vec<T>::lastI() const noexcept
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::destroy(IAllocator* p) noexcept
+Vec<T>::destroy(ALLOC* p) noexcept
 {
-    p->dealloc(m_pData, m_size);
+    if constexpr (!std::is_trivially_destructible_v<T>)
+        for (isize i = 0; i < m_size; ++i) m_pData[i].~T();
+
+    /* The whole capacity, size aware allocators (StatsAllocator, Arena's last allocation) get the real size. */
+    p->freeV(m_pData, m_capacity);
     *this = {};
 }
 
@@ -392,8 +423,9 @@ Vec<T>::zeroOut() noexcept
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline Vec<T>
-Vec<T>::clone(IAllocator* pAlloc) const
+Vec<T>::clone(ALLOC* pAlloc) const
 {
     auto nVec = Vec<T>(pAlloc, m_capacity);
     utils::memCopy(nVec.data(), m_pData, m_size);
@@ -413,16 +445,18 @@ Vec<T>::search(const T& x) const
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::grow(IAllocator* p, isize newCapacity)
+Vec<T>::grow(ALLOC* p, isize newCapacity)
 {
-    m_pData = p->relocate<T>(m_pData, m_capacity, newCapacity);
+    m_pData = p->template relocate<T>(m_pData, m_capacity, newCapacity);
     m_capacity = newCapacity;
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::growIfNeeded(IAllocator* p)
+Vec<T>::growIfNeeded(ALLOC* p)
 {
     if (m_size >= m_capacity)
     {
@@ -433,8 +467,9 @@ Vec<T>::growIfNeeded(IAllocator* p)
 }
 
 template<typename T>
+template<IsAllocator ALLOC>
 inline void
-Vec<T>::growOnSpanPush(IAllocator* p, const isize spanSize)
+Vec<T>::growOnSpanPush(ALLOC* p, const isize spanSize)
 {
     ADT_ASSERT(spanSize > 0, "pushing empty span");
     ADT_ASSERT(m_size + spanSize >= m_size, "overflow");
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "IAllocator.hh"
+#include "Span.hh"
 #include "utils.hh"
 
 namespace adt
@@ -48,11 +49,34 @@ namespace adt
  *
  * Works with regular vector syntax:
  * for (auto bind : vec) bind.vel = {};
- * vec[3].index = 2; */
+ * vec[3].index = 2;
+ *
+ * Or a column at a time (contiguous, each starts on a cache line, for SIMD kernels and parallelForSOA()):
+ * for (auto& vel : vec.column<&Entity::vel>()) vel = {}; */
+
+namespace details
+{
+
+/* Column bytes padded so the next column starts on a cache line too. */
+template<typename T>
+inline constexpr isize
+VecSOAColumnBytes(const isize cap) noexcept
+{
+    return isize(alignUpPO2(usize(cap) * sizeof(T), CACHELINE_SIZE));
+}
+
+} /* namespace details */
 
 template<typename STRUCT, typename BIND, auto ...MEMBERS>
 struct VecSOA
 {
+    template<auto MEMBER>
+    using MemberType = std::remove_reference_t<decltype(std::declval<STRUCT>().*MEMBER)>;
+
+    static constexpr isize COLUMN_ALIGNMENT = CACHELINE_SIZE;
+
+    /* */
+
     u8* m_pData {};
     isize m_size {};
     isize m_capacity {};
@@ -80,8 +104,26 @@ struct VecSOA
     void setSize(IAllocator* pAlloc, const isize newSize);
     void zeroOut() noexcept;
     isize totalByteCap() const noexcept;
+    static isize byteCap(isize cap) noexcept { return (details::VecSOAColumnBytes<MemberType<MEMBERS>>(cap) + ... + 0); }
+
+    template<auto MEMBER>
+    [[nodiscard]] Span<MemberType<MEMBER>> column() noexcept { return {columnData<MEMBER>(), m_size}; }
+
+    template<auto MEMBER>
+    [[nodiscard]] Span<const MemberType<MEMBER>> column() const noexcept { return {columnData<MEMBER>(), m_size}; }
+
+    template<auto MEMBER>
+    [[nodiscard]] Span<MemberType<MEMBER>>
+    column(isize off, isize size) noexcept
+    {
+        ADT_ASSERT(off >= 0 && size >= 0 && off + size <= m_size, "off: {}, size: {}, m_size: {}", off, size, m_size);
+        return {columnData<MEMBER>() + off, size};
+    }
 
 protected:
+    template<auto MEMBER>
+    MemberType<MEMBER>* columnData() const noexcept;
+
     BIND bind(const isize i) const noexcept;
     void set(isize i, const STRUCT& x);
     void growIfNeeded(IAllocator* pAlloc);
@@ -119,7 +161,7 @@ public:
 template<typename STRUCT, typename BIND, auto ...MEMBERS>
 inline
 VecSOA<STRUCT, BIND, MEMBERS...>::VecSOA(IAllocator* pAlloc, isize prealloc)
-    : m_pData {pAlloc->zallocV<u8>(prealloc * sizeof(STRUCT))}, m_capacity(prealloc) {}
+    : m_pData {static_cast<u8*>(pAlloc->zallocAligned(byteCap(prealloc), COLUMN_ALIGNMENT))}, m_capacity(prealloc) {}
 
 namespace details
 {
@@ -137,7 +179,7 @@ VecSOASetHelper(u8* pData, const isize cap, const isize i, HEAD&& head, TAIL&&..
     new( (void*)(pPlacement) ) HeadType(head);
 
     details::VecSOASetHelper<STRUCT, BIND>(
-        (u8*)((reinterpret_cast<HeadType*>(pData)) + cap), cap, i, std::forward<TAIL>(tail)...
+        pData + details::VecSOAColumnBytes<HeadType>(cap), cap, i, std::forward<TAIL>(tail)...
     );
 }
 
@@ -180,7 +222,7 @@ template<typename STRUCT, typename BIND, auto ...MEMBERS>
 inline isize
 VecSOA<STRUCT, BIND, MEMBERS...>::totalByteCap() const noexcept
 {
-    return cap() * sizeof(STRUCT);
+    return byteCap(cap());
 }
 
 template<typename STRUCT, typename BIND, auto ...MEMBERS>
@@ -205,8 +247,8 @@ VecSOAReallocHelper(const u8* const pOld, u8* pData, const isize oldCap, const i
 
     memcpy(pData, pOld, oldCap * sizeof(HeadType));
 
-    u8* pNextOld = (u8*)(reinterpret_cast<const HeadType*>(pOld) + oldCap);
-    u8* pNextData = (u8*)(reinterpret_cast<const HeadType*>(pData) + newCap);
+    const u8* pNextOld = pOld + details::VecSOAColumnBytes<HeadType>(oldCap);
+    u8* pNextData = pData + details::VecSOAColumnBytes<HeadType>(newCap);
 
     VecSOAReallocHelper<STRUCT, BIND, TAIL...>(
         pNextOld, pNextData, oldCap, newCap
@@ -217,13 +259,13 @@ template<typename STRUCT, typename BIND, auto ...MEMBERS>
 inline void
 VecSOA<STRUCT, BIND, MEMBERS...>::grow(IAllocator* p, isize newCapacity)
 {
-    u8* pNewData = p->zallocV<u8>(newCapacity * sizeof(STRUCT));
+    u8* pNewData = static_cast<u8*>(p->zallocAligned(byteCap(newCapacity), COLUMN_ALIGNMENT));
 
     VecSOAReallocHelper<STRUCT, BIND, decltype(std::declval<STRUCT>().*MEMBERS)...>(
         m_pData, pNewData, m_capacity, newCapacity
     );
 
-    p->free(m_pData, m_capacity);
+    p->freeAligned(m_pData, byteCap(m_capacity), COLUMN_ALIGNMENT);
     m_pData = pNewData;
     m_capacity = newCapacity;
 }
@@ -232,7 +274,7 @@ template<typename STRUCT, typename BIND, auto ...MEMBERS>
 inline void
 VecSOA<STRUCT, BIND, MEMBERS...>::destroy(IAllocator* pAlloc) noexcept
 {
-    pAlloc->dealloc(m_pData, m_size);
+    pAlloc->freeAligned(m_pData, byteCap(m_capacity), COLUMN_ALIGNMENT);
     *this = {};
 }
 
@@ -253,13 +295,43 @@ VecSOA<STRUCT, BIND, MEMBERS...>::bind(const isize i) const noexcept
 
                 auto& ref = reinterpret_cast<FieldType*>(p + off)[i];
 
-                off += cap() * sizeof(FieldType);
+                off += details::VecSOAColumnBytes<FieldType>(cap());
                 return ref;
             }()
         )...
     };
 }
 
+template<typename STRUCT, typename BIND, auto ...MEMBERS>
+template<auto MEMBER>
+inline VecSOA<STRUCT, BIND, MEMBERS...>::MemberType<MEMBER>*
+VecSOA<STRUCT, BIND, MEMBERS...>::columnData() const noexcept
+{
+    /* Columns are laid out in MEMBERS order, each m_capacity long and padded to COLUMN_ALIGNMENT. */
+    isize off = 0;
+    bool bFound = false;
+    (
+        [&]
+        {
+            if (bFound) return;
+
+            if constexpr (std::is_same_v<decltype(MEMBERS), decltype(MEMBER)>)
+            {
+                if (MEMBERS == MEMBER)
+                {
+                    bFound = true;
+                    return;
+                }
+            }
+
+            off += details::VecSOAColumnBytes<MemberType<MEMBERS>>(cap());
+        }(), ...
+    );
+
+    ADT_ASSERT(bFound, "MEMBER is not one of MEMBERS");
+    return reinterpret_cast<MemberType<MEMBER>*>(m_pData + off);
+}
+
 template<typename ALLOC_T, typename STRUCT, typename BIND, auto ...MEMBERS>
 struct VecSOAManaged : VecSOA<STRUCT, BIND, MEMBERS...>
 {
@@ -80,7 +80,7 @@ struct Num
     /* */
 
     Num() : m_volInt(0) {}
-    explicit Num(const int val) : m_volInt(val) {}
+    explicit Num(const Type val) : m_volInt(val) {}
 
     /* */
 
@@ -102,7 +102,7 @@ struct Num
     }
 
     ADT_ALWAYS_INLINE void
-    store(const int val, const ORDER eOrder) noexcept
+    store(const Type val, const ORDER eOrder) noexcept
     {
 #ifdef ADT_USE_LINUX_ATOMICS
 
@@ -120,7 +120,7 @@ struct Num
     }
 
     ADT_ALWAYS_INLINE Type
-    fetchAdd(const int val, const ORDER eOrder) noexcept
+    fetchAdd(const Type val, const ORDER eOrder) noexcept
     {
 #ifdef ADT_USE_LINUX_ATOMICS
 
@@ -138,7 +138,7 @@ struct Num
     }
 
     ADT_ALWAYS_INLINE Type
-    fetchSub(const int val, const ORDER eOrder) noexcept
+    fetchSub(const Type val, const ORDER eOrder) noexcept
     {
 #ifdef ADT_USE_LINUX_ATOMICS
 
@@ -152,6 +152,24 @@ struct Num
             (std::memory_order)eOrder
         );
 
+#endif
+    }
+
+    ADT_ALWAYS_INLINE Type
+    exchange(const Type val, const ORDER eOrder) noexcept
+    {
+#ifdef ADT_USE_LINUX_ATOMICS
+
+        return __atomic_exchange_n(&m_volInt, val, int(eOrder));
+
+#elif defined ADT_USE_WIN32_ATOMICS
+
+        return std::atomic_exchange_explicit(
+            (volatile std::atomic<Type>*)&m_volInt,
+            (std::_Identity_t<Type>)val,
+            (std::memory_order)eOrder
+        );
+
 #endif
     }
 
@@ -198,6 +216,7 @@ struct Num
 };
 
 using Int = Num<i32>;
+using Long = Num<i64>;
 using Bool = Num<bool>;
 
 } /* namespace adt::atomic */
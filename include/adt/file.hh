@@ -296,6 +296,7 @@ store(const StringView svData, const char* ntsPath, bool bAppend = false) noexce
     else
     {
         size_t r = fwrite(svData.m_pData, 1, svData.m_size, pFile);
+        fclose(pFile);
         if ((isize)r != svData.m_size)
         {
             LogError{"fwrite failed r: {}, size: {}, (error: '{}')\n",
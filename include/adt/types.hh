@@ -71,6 +71,9 @@ using null = decltype(nullptr);
 
 static const inline null g_null = nullptr;
 
+/* Padding between data written by different threads, so they don't invalidate each other's lines. */
+constexpr isize CACHELINE_SIZE = 64;
+
 struct InitFlag {};
 constexpr InitFlag INIT {};
 
@@ -101,6 +104,14 @@ constexpr UninitFlag UNINIT {};
     #define ADT_ALWAYS_INLINE inline
 #endif
 
+#if defined __clang__ || __GNUC__
+    #define ADT_NO_INLINE __attribute__((__noinline__))
+#elif defined _MSC_VER
+    #define ADT_NO_INLINE __declspec(noinline)
+#else
+    #define ADT_NO_INLINE
+#endif
+
 #if defined _MSC_VER
     #define ADT_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
 #else
@@ -209,6 +220,11 @@ template<typename T>
 concept IsIndexable = requires(const T& c)
 { c[0]; };
 
+/* IAllocator, its implementations or a non virtual allocator type (ArenaNV). */
+template<typename T>
+concept IsAllocator = requires(T* p, void* ptr, usize n)
+{ p->malloc(n); p->realloc(ptr, n, n); p->free(ptr, n); };
+
 } /* namespace adt */
 
 #if defined ADT_USING_NAMESPACE
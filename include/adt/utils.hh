@@ -7,6 +7,10 @@
 #include "Pair.hh"
 #include "assert.hh"
 
+#if defined _MSC_VER && !defined __clang__
+    #include <xmmintrin.h>
+#endif
+
 #include <cstring>
 #include <utility>
 #include <ctime>
@@ -312,6 +316,17 @@ addNSToTimespec(timespec* const pTs, const isize nsec)
     else pTs->tv_nsec += nsec;
 }
 
+/* Hint to start loading the cache line of p, doesn't fault on bad addresses. */
+ADT_ALWAYS_INLINE void
+prefetch([[maybe_unused]] const void* p) noexcept
+{
+#if defined __clang__ || __GNUC__
+    __builtin_prefetch(p);
+#elif defined _MSC_VER
+    _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#endif
+}
+
 template<std::floating_point F>
 inline bool
 floatEq(F l, F r) noexcept
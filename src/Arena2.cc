@@ -64,6 +64,178 @@ lilBenchmark()
     LogInfo{"lil bench finished\n"};
 }
 
+static void
+reservationModes()
+{
+    constexpr isize TOUCH = SIZE_1M * 256;
+    constexpr isize STEP = SIZE_1K * 64;
+
+    struct Mode { ARENA_FLAGS eFlags; const char* ntsName; };
+    const Mode aModes[] {
+        {ARENA_FLAGS::NONE, "NONE"},
+        {ARENA_FLAGS::POPULATE, "POPULATE"},
+        {ARENA_FLAGS::HUGE_PAGES, "HUGE_PAGES"},
+        {ARENA_FLAGS::HUGE_PAGES | ARENA_FLAGS::POPULATE, "HUGE_PAGES | POPULATE"},
+        {ARENA_FLAGS::HUGETLB | ARENA_FLAGS::NUMA_LOCAL, "HUGETLB | NUMA_LOCAL"},
+        {ARENA_FLAGS::NORESERVE, "NORESERVE"},
+        {ARENA_FLAGS::HUGE_PAGES | ARENA_FLAGS::NORESERVE, "HUGE_PAGES | NORESERVE"},
+    };
+
+    LogInfo{"reservation modes (touching {} MB in {} KB allocations)...\n", TOUCH / SIZE_1M, STEP / SIZE_1K};
+    for (const Mode& mode : aModes)
+    {
+        time::Type t0 = time::now();
+
+        Arena arena {SIZE_1G * 4, SIZE_1M, mode.eFlags};
+        defer( arena.freeAll() );
+
+        for (isize off = 0; off < TOUCH; off += STEP)
+        {
+            u8* p = arena.mallocV<u8>(STEP);
+            for (isize i = 0; i < STEP; i += SIZE_1K) p[i] = u8(off + i);
+        }
+
+        ADT_ASSERT_ALWAYS(isize((usize)arena.m_pData % arena.commitGranularity()) == 0, "");
+        ADT_ASSERT_ALWAYS(arena.memoryCommited() % arena.commitGranularity() == 0, "");
+        for (isize off = 0; off < TOUCH; off += SIZE_1K)
+            ADT_ASSERT_ALWAYS(((u8*)arena.m_pData)[off] == u8(off), "off: {}", off);
+
+        LogInfo{"  {}: (flags: {:#x}, commit granularity: {} KB): {:.3} ms\n",
+            mode.ntsName, int(arena.m_eFlags), arena.commitGranularity() / SIZE_1K, time::diffMSec(time::now(), t0)
+        };
+    }
+}
+
+static void
+growthAndTrim()
+{
+    {
+        Arena arena {SIZE_1G, SIZE_1M};
+        defer( arena.freeAll() );
+
+        arena.setGrowth(ARENA_GROWTH::FIXED, SIZE_1M);
+        (void)arena.malloc(SIZE_1M * 2 + 8);
+        ADT_ASSERT_ALWAYS(arena.memoryCommited() == isize(alignUpPO2(SIZE_1M * 2 + 8, getPageSize())), "{}", arena.memoryCommited());
+        isize commited = arena.memoryCommited();
+        (void)arena.malloc(commited - arena.memoryUsed() + 8);
+        ADT_ASSERT_ALWAYS(arena.memoryCommited() == commited + SIZE_1M, "{}", arena.memoryCommited());
+
+        arena.setGrowth(ARENA_GROWTH::CAPPED_DOUBLE, SIZE_1M * 4);
+        commited = arena.memoryCommited();
+        (void)arena.malloc(commited - arena.memoryUsed() + 8);
+        ADT_ASSERT_ALWAYS(arena.memoryCommited() == commited * 2, "{}", arena.memoryCommited());
+        (void)arena.malloc(arena.memoryCommited() - arena.memoryUsed() + 8);
+        ADT_ASSERT_ALWAYS(arena.memoryCommited() == commited * 2 + SIZE_1M * 4, "{}", arena.memoryCommited());
+    }
+
+    /* One big frame, then small ones: the big commit survives its window and goes away after the next one. */
+    {
+        Arena arena {SIZE_1G, SIZE_1M};
+        defer( arena.freeAll() );
+        arena.setTrim(4);
+
+        (void)arena.malloc(SIZE_1M * 64);
+        arena.reset();
+        for (int i = 0; i < 3; ++i) { (void)arena.malloc(SIZE_1M); arena.reset(); }
+        ADT_ASSERT_ALWAYS(arena.memoryCommited() >= SIZE_1M * 64, "{}", arena.memoryCommited());
+
+        for (int i = 0; i < 4; ++i) { (void)arena.malloc(SIZE_1M); arena.reset(); }
+        ADT_ASSERT_ALWAYS(arena.memoryCommited() == SIZE_1M, "{}", arena.memoryCommited());
+    }
+
+    /* Per frame usage with a burst of spikes at the start and small frames after. */
+    constexpr int NFRAMES = 512;
+    enum MODE { RESET, RESET_DECOMMIT, RESET_TRIM };
+    const char* aNames[] {"reset()", "resetDecommit()", "reset() + setTrim(16)"};
+
+    LogInfo{"oscillating frames ({} frames of 1 MB, 32 MB every 4th of the first 128)...\n", NFRAMES};
+    for (int eMode : {RESET, RESET_DECOMMIT, RESET_TRIM})
+    {
+        Arena arena {SIZE_1G, SIZE_1M};
+        defer( arena.freeAll() );
+        if (eMode == RESET_TRIM) arena.setTrim(16);
+
+        isize sumCommited = 0;
+        const time::Type t0 = time::now();
+        for (int frame = 0; frame < NFRAMES; ++frame)
+        {
+            const isize size = frame < 128 && frame % 4 == 0 ? SIZE_1M * 32 : SIZE_1M;
+            u8* p = arena.mallocV<u8>(size);
+            for (isize i = 0; i < size; i += getPageSize()) p[i] = u8(frame);
+
+            sumCommited += arena.memoryCommited();
+            if (eMode == RESET_DECOMMIT) arena.resetDecommit();
+            else arena.reset();
+        }
+
+        LogInfo{"  {}: {:.3} ms, average commited: {} MB\n",
+            aNames[eMode], time::diffMSec(time::now(), t0), sumCommited / NFRAMES / SIZE_1M
+        };
+    }
+}
+
+/* Short lived per task arenas growing in small steps: mprotect() on every commit against lazy faulting. */
+static void
+lazyCommitChurn()
+{
+    constexpr int NTHREADS = 4;
+    constexpr int NARENAS = 16; /* Per thread. */
+    constexpr int NCYCLES = 8;
+    constexpr isize TOUCH = SIZE_1M * 4;
+
+    struct Job { ARENA_FLAGS eFlags; int t; };
+    auto pfnChurn = +[](void* pArg) -> THREAD_STATUS {
+        const Job& job = *static_cast<Job*>(pArg);
+
+        for (int a = 0; a < NARENAS; ++a)
+        {
+            Arena arena {SIZE_1G, SIZE_1K * 64, job.eFlags};
+            defer( arena.freeAll() );
+            arena.setGrowth(ARENA_GROWTH::FIXED, SIZE_1K * 64);
+
+            for (int cycle = 0; cycle < NCYCLES; ++cycle)
+            {
+                const u8 tag = u8(job.t + a + cycle);
+                for (isize off = 0; off < TOUCH; off += getPageSize())
+                {
+                    u8* p = arena.mallocV<u8>(getPageSize());
+                    p[0] = tag;
+                }
+
+                ADT_ASSERT_ALWAYS(((u8*)arena.m_pData)[0] == tag, "");
+                arena.resetDecommit();
+            }
+        }
+
+        return 0;
+    };
+
+    struct Mode { ARENA_FLAGS eFlags; const char* ntsName; };
+    const Mode aModes[] {
+        {ARENA_FLAGS::NONE, "NONE"},
+        {ARENA_FLAGS::NORESERVE, "NORESERVE"},
+    };
+
+    LogInfo{"lazy commit churn ({} threads x {} arenas, {} x {} MB in 64 KB commit steps)...\n",
+        NTHREADS, NARENAS, NCYCLES, TOUCH / SIZE_1M
+    };
+    for (const Mode& mode : aModes)
+    {
+        const time::Type t0 = time::now();
+
+        Job aJobs[NTHREADS];
+        Thread aThreads[NTHREADS];
+        for (int t = 0; t < NTHREADS; ++t)
+        {
+            aJobs[t] = {mode.eFlags, t};
+            aThreads[t] = Thread {pfnChurn, &aJobs[t]};
+        }
+        for (Thread& thread : aThreads) thread.join();
+
+        LogInfo{"  {}: {:.3} ms\n", mode.ntsName, time::diffMSec(time::now(), t0)};
+    }
+}
+
 int
 main()
 {
@@ -83,6 +255,10 @@ main()
         lilBenchmark();
         arena.reset();
 
+        reservationModes();
+        growthAndTrim();
+        lazyCommitChurn();
+
         {
             IArena::IScope topScope = arena.restoreAfterScope();
 
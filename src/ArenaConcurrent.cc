@@ -0,0 +1,170 @@
+#include "adt/ArenaConcurrent.hh"
+#include "adt/Logger.hh"
+#include "adt/ThreadPool.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr int NTASKS = 64;
+static constexpr int NRECORDS = 1 << 13;
+
+/* Variable sized record: header and payload, payload bytes are derived from the id. */
+struct Record
+{
+    u32 id {};
+    u32 size {};
+
+    /* */
+
+    u8* pPayload() noexcept { return reinterpret_cast<u8*>(this + 1); }
+};
+
+static Record*
+appendRecord(IAllocator* pAlloc, u32 id)
+{
+    const u32 size = 1 + (id * 2654435761u) % 120;
+    auto* pRec = static_cast<Record*>(pAlloc->malloc(sizeof(Record) + size));
+    pRec->id = id;
+    pRec->size = size;
+    for (u32 i = 0; i < size; ++i) pRec->pPayload()[i] = u8(id + i);
+
+    return pRec;
+}
+
+static bool
+checkRecord(Record* pRec)
+{
+    for (u32 i = 0; i < pRec->size; ++i)
+        if (pRec->pPayload()[i] != u8(pRec->id + i)) return false;
+
+    return pRec->size == 1 + (pRec->id * 2654435761u) % 120;
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("ArenaConcurrent test...\n");
+
+    ThreadPool tp {Arena{}, SIZE_1K, SIZE_1M};
+    defer( tp.destroy() );
+
+    ArenaConcurrent arena {SIZE_1G};
+    defer( arena.freeAll() );
+
+    /* Producers append into one region, every record has to come out intact. */
+    {
+        Vec<Record*> vRecords {Gpa::inst(), NTASKS * NRECORDS};
+        defer( vRecords.destroy(Gpa::inst()) );
+        vRecords.setSize(Gpa::inst(), NTASKS * NRECORDS);
+
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                for (int i = 0; i < NRECORDS; ++i)
+                {
+                    const u32 id = u32(t * NRECORDS + i);
+                    vRecords[id] = appendRecord(&arena, id);
+                }
+            });
+        }
+        tp.wait(true);
+
+        for (Record* pRec : vRecords)
+            ADT_ASSERT_ALWAYS(checkRecord(pRec), "id: {}", pRec->id);
+
+        LogInfo("{} records, used: {} KB, commited: {} KB\n",
+            vRecords.size(), arena.memoryUsed() / SIZE_1K, arena.memoryCommited() / SIZE_1K
+        );
+    }
+
+    /* Scope restore and in place realloc from the owning thread. */
+    {
+        const isize posBefore = arena.memoryUsed();
+        {
+            IArena::Scope<ArenaConcurrent> scope {&arena};
+
+            u8* p = static_cast<u8*>(arena.malloc(16));
+            u8* p2 = static_cast<u8*>(arena.realloc(p, 16, SIZE_1K));
+            ADT_ASSERT_ALWAYS(p == p2, "last allocation must grow in place");
+
+            [[maybe_unused]] void* pOther = arena.malloc(8);
+            u8* p3 = static_cast<u8*>(arena.realloc(p2, SIZE_1K, SIZE_1K * 2));
+            ADT_ASSERT_ALWAYS(p3 != p2, "not the last allocation anymore");
+
+            void* pAligned = arena.mallocAligned(100, 256);
+            ADT_ASSERT_ALWAYS(usize(pAligned) % 256 == 0, "{}", pAligned);
+        }
+        ADT_ASSERT_ALWAYS(arena.memoryUsed() == usize(posBefore), "{}, {}", arena.memoryUsed(), posBefore);
+    }
+
+    /* Failed oversized allocations give their bytes back. */
+    {
+        const usize posBefore = arena.memoryUsed();
+        for (usize nBytes : {usize(SIZE_1G * 2), usize(SIZE_1G)})
+        {
+            bool bThrew = false;
+            try { [[maybe_unused]] void* p = arena.malloc(nBytes); }
+            catch (const AllocException&) { bThrew = true; }
+            ADT_ASSERT_ALWAYS(bThrew, "nBytes: {}", nBytes);
+
+            bThrew = false;
+            try { [[maybe_unused]] void* p = arena.mallocAligned(nBytes, 64); }
+            catch (const AllocException&) { bThrew = true; }
+            ADT_ASSERT_ALWAYS(bThrew, "nBytes: {}", nBytes);
+        }
+        ADT_ASSERT_ALWAYS(arena.memoryUsed() == posBefore, "{}, {}", arena.memoryUsed(), posBefore);
+
+        u8* p = static_cast<u8*>(arena.malloc(64));
+        bool bThrew = false;
+        try { [[maybe_unused]] void* p2 = arena.realloc(p, 64, SIZE_1G * 2); }
+        catch (const AllocException&) { bThrew = true; }
+        ADT_ASSERT_ALWAYS(bThrew, "");
+
+        /* Still the last block: grows in place. */
+        ADT_ASSERT_ALWAYS(arena.realloc(p, 64, 128) == p, "");
+        ADT_ASSERT_ALWAYS(arena.memoryUsed() == posBefore + 128, "{}, {}", arena.memoryUsed(), posBefore);
+    }
+
+    /* One shared region: fetch-add against an Arena behind a Mutex. */
+    {
+        arena.reset();
+
+        Arena arenaLocked {SIZE_1G};
+        Mutex mtx {Mutex::TYPE::PLAIN};
+        defer( arenaLocked.freeAll(); mtx.destroy() );
+
+        auto t0 = time::now();
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                for (int i = 0; i < NRECORDS; ++i) appendRecord(&arena, u32(t * NRECORDS + i));
+            });
+        }
+        tp.wait(true);
+        const f64 concurrentMS = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                for (int i = 0; i < NRECORDS; ++i)
+                {
+                    LockScope lock {&mtx};
+                    appendRecord(&arenaLocked, u32(t * NRECORDS + i));
+                }
+            });
+        }
+        tp.wait(true);
+        const f64 lockedMS = time::diffMSec(time::now(), t0);
+
+        LogInfo{"{} records on {} threads: ArenaConcurrent: {:.3} ms, Arena + Mutex: {:.3} ms\n",
+            NTASKS * NRECORDS, tp.nThreads(), concurrentMS, lockedMS
+        };
+    }
+
+    LogInfo("ArenaConcurrent test passed\n");
+}
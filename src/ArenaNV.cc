@@ -0,0 +1,142 @@
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/Map.hh"
+#include "adt/Queue.hh"
+#include "adt/String.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr isize NROUNDS = 4;
+static constexpr isize NBATCHES = 256;
+static constexpr isize NSMALL = 1 << 12;
+
+/* Lots of short lived containers, so most pushes end up in the allocator (realloc/malloc) instead of a spare capacity.
+ * ADT_NO_INLINE keeps the compiler from seeing the dynamic type behind IAllocator* and devirtualizing it on its own. */
+template<typename ALLOC>
+ADT_NO_INLINE static u64
+pushVec(ALLOC* pAlloc)
+{
+    u64 sum = 0;
+    for (isize i = 0; i < NSMALL; ++i)
+    {
+        Vec<u32> v {pAlloc, 1};
+        for (u32 j = 0; j < 4; ++j) v.push(pAlloc, j + u32(i));
+        sum += v.last();
+    }
+    return sum;
+}
+
+template<typename ALLOC>
+ADT_NO_INLINE static u64
+insertMap(ALLOC* pAlloc)
+{
+    u64 sum = 0;
+    for (isize i = 0; i < NSMALL / 16; ++i)
+    {
+        Map<u32, u32> map {pAlloc, 2};
+        for (u32 j = 0; j < 16; ++j) map.insert(pAlloc, j * 7 + u32(i), j);
+        sum += map.size();
+    }
+    return sum;
+}
+
+template<typename ALLOC>
+ADT_NO_INLINE static u64
+pushBackQueue(ALLOC* pAlloc)
+{
+    u64 sum = 0;
+    for (isize i = 0; i < NSMALL / 4; ++i)
+    {
+        Queue<u64> q {pAlloc, 2};
+        for (u64 j = 0; j < 8; ++j) q.pushBack(pAlloc, j + i);
+        sum += q.popFront();
+    }
+    return sum;
+}
+
+template<typename ALLOC>
+ADT_NO_INLINE static u64
+pushString(ALLOC* pAlloc)
+{
+    u64 sum = 0;
+    for (isize i = 0; i < NSMALL / 4; ++i)
+    {
+        VString s {};
+        for (int j = 0; j < 8; ++j) s.push(pAlloc, "push");
+        sum += s.size();
+    }
+    return sum;
+}
+
+/* Same loops through IAllocator* (virtual) and ArenaNV* (inlined).
+ * Resetting after every batch keeps the arena in cache, so the allocator calls are what's measured, not page faults. */
+template<u64 (*PFN_IALLOC)(IAllocator*), u64 (*PFN_NV)(ArenaNV*)>
+static void
+bench(const char* ntsName, ArenaNV* pArena)
+{
+    auto clRun = [&](auto pfn, auto* pAlloc, u64* pSum) {
+        const auto t0 = time::now();
+        for (isize r = 0; r < NBATCHES; ++r)
+        {
+            *pSum += pfn(pAlloc);
+            pArena->reset();
+        }
+        return time::diffMSec(time::now(), t0);
+    };
+
+    u64 sum0 = 0, sum1 = 0;
+    f64 bestVirtual = 1e9, bestNV = 1e9;
+    for (isize r = 0; r < NROUNDS; ++r)
+    {
+        bestVirtual = utils::min(bestVirtual, clRun(PFN_IALLOC, static_cast<IAllocator*>(pArena), &sum0));
+        bestNV = utils::min(bestNV, clRun(PFN_NV, pArena, &sum1));
+    }
+    ADT_ASSERT_ALWAYS(sum0 == sum1, "{}: {} != {}", ntsName, sum0, sum1);
+
+    LogInfo{"{}: IAllocator*: {:.3} ms, ArenaNV*: {:.3} ms\n", ntsName, bestVirtual, bestNV};
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("ArenaNV test...\n");
+
+    static_assert(IsAllocator<IAllocator>);
+    static_assert(IsAllocator<ArenaNV>);
+
+    {
+        ArenaNV arena {SIZE_1G};
+        defer( arena.freeAll() );
+
+        /* Same containers work with either pointer type. */
+        Vec<int> v {&arena};
+        for (int i = 0; i < 100; ++i) v.push(&arena, i);
+        IAllocator* pIAlloc = &arena;
+        v.push(pIAlloc, 100);
+        ADT_ASSERT_ALWAYS(v.size() == 101 && v[100] == 100 && v[50] == 50, "");
+
+        {
+            IArena::Scope arenaScope {&arena};
+            VString s = VString(&arena, "hello");
+            s.push(&arena, " world");
+            ADT_ASSERT_ALWAYS(s == StringView{"hello world"}, "'{}'", s);
+        }
+    }
+
+    {
+        ArenaNV arena {SIZE_1G};
+        defer( arena.freeAll() );
+
+        bench<pushVec<IAllocator>, pushVec<ArenaNV>>("Vec::push()", &arena);
+        bench<insertMap<IAllocator>, insertMap<ArenaNV>>("Map::insert()", &arena);
+        bench<pushBackQueue<IAllocator>, pushBackQueue<ArenaNV>>("Queue::pushBack()", &arena);
+        bench<pushString<IAllocator>, pushString<ArenaNV>>("VString::push()", &arena);
+    }
+
+    LogInfo("ArenaNV test passed\n");
+}
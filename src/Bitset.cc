@@ -0,0 +1,162 @@
+#include "adt/Bitset.hh"
+#include "adt/Logger.hh"
+#include "adt/Pool.hh"
+#include "adt/PoolSOA.hh"
+#include "adt/Vec.hh"
+#include "adt/rng.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr isize CAP = SIZE_1K * 64;
+
+struct Particle
+{
+    f32 x {};
+    f32 v {};
+};
+
+struct ParticleBind
+{
+    f32& x;
+    f32& v;
+};
+
+/* Against a plain bool array walk, for random sets of various density. */
+static void
+bitsetVsBools()
+{
+    static Bitset<CAP> s_bitset {};
+    static bool s_aBools[CAP] {};
+
+    rng::PCG32 rng {7};
+    for (int round = 0; round < 64; ++round)
+    {
+        s_bitset = {};
+        memset(s_aBools, 0, sizeof(s_aBools));
+
+        const u32 density = rng.nextInRange(0, 100);
+        for (isize i = 0; i < CAP; ++i)
+        {
+            if (rng.nextInRange(0, 100) < density || (i >= 60 && i < 200 && round & 1))
+            {
+                s_bitset.set(i);
+                s_aBools[i] = true;
+            }
+        }
+
+        isize expected = -1;
+        for (isize i = 0; i < CAP; ++i)
+        {
+            if (!s_aBools[i]) continue;
+
+            ADT_ASSERT_ALWAYS(s_bitset.next(expected + 1) == i, "round: {}, i: {}", round, i);
+            ADT_ASSERT_ALWAYS(s_bitset.prev(i) == i && s_bitset.prev(i - 1) == expected, "round: {}, i: {}", round, i);
+            expected = i;
+        }
+        ADT_ASSERT_ALWAYS(s_bitset.next(expected + 1) == -1, "");
+        ADT_ASSERT_ALWAYS(s_bitset.prev(CAP - 1) == expected, "");
+
+        /* Runs cover every set bit once and are separated by a clear bit. */
+        isize nSet = 0, prevEnd = -1;
+        s_bitset.forEachRun([&](isize firstI, isize count) {
+            ADT_ASSERT_ALWAYS(firstI > prevEnd && count > 0, "firstI: {}, prevEnd: {}", firstI, prevEnd);
+            ADT_ASSERT_ALWAYS(firstI == 0 || !s_aBools[firstI - 1], "firstI: {}", firstI);
+            ADT_ASSERT_ALWAYS(firstI + count == CAP || !s_aBools[firstI + count], "end: {}", firstI + count);
+            for (isize i = firstI; i < firstI + count; ++i) ADT_ASSERT_ALWAYS(s_aBools[i], "i: {}", i);
+            nSet += count;
+            prevEnd = firstI + count;
+        });
+        ADT_ASSERT_ALWAYS(nSet == s_bitset.count(), "{}, {}", nSet, s_bitset.count());
+    }
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("Bitset test...\n");
+
+    bitsetVsBools();
+
+    /* Sparse 64K Pool: iteration cost against the live work. */
+    {
+        static Pool<int, CAP> s_pool {INIT};
+        static bool s_aOccupied[CAP] {};
+
+        Vec<Pool<int, CAP>::Handle> vHandles {Gpa::inst(), CAP};
+        defer( vHandles.destroy(Gpa::inst()) );
+        for (isize i = 0; i < CAP; ++i) vHandles.push(Gpa::inst(), s_pool.insert(int(i)));
+
+        /* Keep about 1%. */
+        rng::PCG32 rng {1};
+        for (auto h : vHandles)
+        {
+            if (rng.nextInRange(0, 100) == 0) s_aOccupied[h.i] = true;
+            else s_pool.remove(h);
+        }
+
+        constexpr int NITERS = 200;
+        i64 sumBools = 0, sumIt = 0, sumRuns = 0;
+
+        auto t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+            for (isize i = 0; i < CAP; ++i)
+                if (s_aOccupied[i]) sumBools += s_pool.m_aSlots[i];
+        const f64 msBools = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+            for (int x : s_pool) sumIt += x;
+        const f64 msIt = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+        {
+            s_pool.forEachOccupied([&](int* pFirst, isize, isize count) {
+                for (isize i = 0; i < count; ++i) sumRuns += pFirst[i];
+            });
+        }
+        const f64 msRuns = time::diffMSec(time::now(), t0);
+
+        ADT_ASSERT_ALWAYS(sumBools == sumIt && sumIt == sumRuns, "{}, {}, {}", sumBools, sumIt, sumRuns);
+        LogInfo{"Pool<int, {}> with {} live, {}x: bool walk: {:.3} ms, iterator: {:.3} ms, forEachOccupied: {:.3} ms\n",
+            CAP, s_pool.size(), NITERS, msBools, msIt, msRuns
+        };
+
+        isize nReverse = 0;
+        for (isize i = s_pool.lastI(); i != -1; i = s_pool.prevI(i)) ++nReverse;
+        ADT_ASSERT_ALWAYS(nReverse == s_pool.size(), "{}, {}", nReverse, s_pool.size());
+    }
+
+    /* PoolSOA runs: a column kernel over each run. */
+    {
+        using PoolParticles = PoolSOA<Particle, ParticleBind, 1024, &Particle::x, &Particle::v>;
+        static PoolParticles s_pool {};
+
+        PoolSOAHandle<Particle> aHandles[1000] {};
+        for (int i = 0; i < 1000; ++i) aHandles[i] = s_pool.insert({.x = f32(i), .v = 1.0f});
+        for (int i = 0; i < 1000; i += 3) s_pool.remove(aHandles[i]);
+
+        s_pool.forEachOccupied([&](isize firstI, isize count) {
+            f32* pX = &s_pool.bindMember<&Particle::x>({int(firstI)});
+            const f32* pV = &s_pool.bindMember<&Particle::v>({int(firstI)});
+            for (isize i = 0; i < count; ++i) pX[i] += pV[i] * 2.0f;
+        });
+
+        isize n = 0;
+        for ([[maybe_unused]] auto p : s_pool) ++n;
+        ADT_ASSERT_ALWAYS(n == 1000 - 334, "{}", n);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            if (i % 3 == 0) continue;
+            ADT_ASSERT_ALWAYS(s_pool[aHandles[i]].x == f32(i) + 2.0f, "i: {}, x: {}", i, s_pool[aHandles[i]].x);
+        }
+    }
+
+    LogInfo("Bitset test passed\n");
+}
@@ -0,0 +1,176 @@
+#include "json/Indexer.hh"
+#include "json/Parser.hh"
+
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/rng.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static void
+append(Vec<char>* pv, StringView sv)
+{
+    for (char c : sv) pv->push(Gpa::inst(), c);
+}
+
+/* Random valid json with escapes, long strings and backslash runs that cross block boundaries.
+ * Parser doesn't take arrays directly inside of arrays, bInArray avoids them. */
+static void
+genValue(Vec<char>* pv, rng::PCG32* pRng, int depth, bool bInArray = false)
+{
+    constexpr StringView aWs[] {"", " ", "\n", "  \t", "\r\n    "};
+    auto ws = [&] { append(pv, aWs[pRng->nextInRange(0, 4)]); };
+
+    auto genString = [&] {
+        pv->push(Gpa::inst(), '"');
+        const u32 len = pRng->nextInRange(0, 100) < 10 ? pRng->nextInRange(50, 200) : pRng->nextInRange(0, 12);
+        for (u32 i = 0; i < len; ++i)
+        {
+            switch (pRng->nextInRange(0, 12))
+            {
+                case 0: append(pv, "\\\""); break;
+                case 1: for (u32 j = pRng->nextInRange(1, 70); j > 0; --j) append(pv, "\\\\"); break;
+                case 2: append(pv, "{[:,]}"); break;
+                case 3: append(pv, " \n"); break;
+                default: pv->push(Gpa::inst(), char('a' + pRng->nextInRange(0, 25))); break;
+            }
+        }
+        pv->push(Gpa::inst(), '"');
+    };
+
+    u32 kind = depth > 5 ? pRng->nextInRange(2, 7) : pRng->nextInRange(0, 7);
+    if (kind == 1 && bInArray) kind = 0;
+
+    switch (kind)
+    {
+        case 0:
+        case 1:
+        {
+            const bool bObj = kind == 0;
+            pv->push(Gpa::inst(), bObj ? '{' : '[');
+            const u32 n = pRng->nextInRange(0, 8);
+            for (u32 i = 0; i < n; ++i)
+            {
+                ws();
+                if (bObj)
+                {
+                    genString();
+                    ws();
+                    pv->push(Gpa::inst(), ':');
+                    ws();
+                }
+                genValue(pv, pRng, depth + 1, !bObj);
+                ws();
+                if (i + 1 < n) pv->push(Gpa::inst(), ',');
+            }
+            pv->push(Gpa::inst(), bObj ? '}' : ']');
+        }
+        break;
+
+        case 2: genString(); break;
+        case 3: append(pv, "-1234567"); break;
+        case 4: append(pv, "3.14159"); break;
+        case 5: append(pv, "true"); break;
+        case 6: append(pv, "false"); break;
+        case 7: append(pv, "null"); break;
+    }
+}
+
+static isize
+tokenize(json::Lexer lex)
+{
+    isize n = 0;
+    for (json::Token tok = lex.next(); tok.eType != json::TOKEN_TYPE::NONE; tok = lex.next()) ++n;
+    return n;
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("JSONIndex test...\n");
+
+    Arena arena {SIZE_1G};
+    defer( arena.freeAll() );
+
+    /* Indexed token stream matches the character by character one. */
+    rng::PCG32 rng {3};
+    for (int round = 0; round < 2000; ++round)
+    {
+        Vec<char> v {Gpa::inst()};
+        defer( v.destroy(Gpa::inst()) );
+
+        append(&v, "{\"root\": ");
+        genValue(&v, &rng, 0);
+        append(&v, "}\n");
+
+        const StringView sv {v.data(), v.size()};
+        Vec<u32> vIdx = json::buildIndex(&arena, sv);
+
+        json::Lexer lexPlain {sv};
+        json::Lexer lexIdx {sv, {vIdx.data(), vIdx.size()}};
+        for (isize i = 0;; ++i)
+        {
+            const json::Token t0 = lexPlain.next();
+            const json::Token t1 = lexIdx.next();
+            ADT_ASSERT_ALWAYS(t0.eType == t1.eType && t0.svLiteral == t1.svLiteral && t0.svLiteral.data() == t1.svLiteral.data(),
+                "round: {}, token: {}, '{}' vs '{}'", round, i, t0.svLiteral, t1.svLiteral
+            );
+
+            if (t0.eType == json::TOKEN_TYPE::NONE) break;
+
+            /* Plain lexer reports strings at their closing quote row. */
+            if (t0.eType == json::TOKEN_TYPE::QUOTED_STRING) continue;
+
+            const json::Token tAt = lexIdx.locate(t1);
+            ADT_ASSERT_ALWAYS(tAt.row == t0.row, "round: {}, token: {}, row: {} vs {}", round, i, t0.row, tAt.row);
+        }
+
+        arena.reset();
+    }
+
+    /* Big document: lexing and parsing with and without the index. */
+    {
+        Vec<char> v {Gpa::inst()};
+        defer( v.destroy(Gpa::inst()) );
+
+        append(&v, "[");
+        for (int i = 0; i < 3000; ++i)
+        {
+            if (i > 0) append(&v, ",\n");
+            genValue(&v, &rng, 0, true);
+        }
+        append(&v, "]");
+
+        const StringView sv {v.data(), v.size()};
+
+        auto t0 = time::now();
+        const isize nPlain = tokenize(json::Lexer {sv});
+        const f64 msPlain = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        Vec<u32> vIdx = json::buildIndex(&arena, sv);
+        const f64 msIndex = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        const isize nIdx = tokenize(json::Lexer {sv, {vIdx.data(), vIdx.size()}});
+        const f64 msIdx = time::diffMSec(time::now(), t0);
+
+        ADT_ASSERT_ALWAYS(nPlain == nIdx, "{} vs {}", nPlain, nIdx);
+
+        t0 = time::now();
+        json::Parser p {};
+        ADT_ASSERT_ALWAYS(p.parse(&arena, sv), "");
+        const f64 msParse = time::diffMSec(time::now(), t0);
+
+        LogInfo{"{} KB, {} tokens: plain lexer: {:.3} ms, buildIndex: {:.3} ms + indexed lexer: {:.3} ms, parse: {:.3} ms\n",
+            sv.size() / 1024, nPlain, msPlain, msIndex, msIdx, msParse
+        };
+    }
+
+    LogInfo("JSONIndex test passed\n");
+}
@@ -0,0 +1,151 @@
+#include "json/ObjectIndex.hh"
+
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/rng.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr isize N_KEYS = 5000;
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("JSONObjectIndex test...\n");
+
+    Arena arena {SIZE_1G};
+    defer( arena.freeAll() );
+
+    /* {"small": {...}, "big": {"key0": 0, ..., "key4999": 4999, "key7": -1}} */
+    Vec<char> vJson {&arena};
+    auto clAppend = [&](StringView sv) { for (char c : sv) vJson.push(&arena, c); };
+
+    clAppend(R"({"small": {"a": 1, "b": 2, "c": 3}, "big": {)");
+    for (isize i = 0; i < N_KEYS; ++i)
+    {
+        char aBuff[64] {};
+        print::toBuffer(aBuff, sizeof(aBuff) - 1, "\"key{}\": {}, ", i, i);
+        clAppend(aBuff);
+    }
+    clAppend(R"("key7": -1}})");
+
+    json::Parser p {};
+    ADT_ASSERT_ALWAYS(p.parse(&arena, {vJson.data(), vJson.size()}), "");
+
+    Vec<json::Node>& aSmall = json::getObject(json::searchNode(p.getRoot(), "small"));
+    Vec<json::Node>& aBig = json::getObject(json::searchNode(p.getRoot(), "big"));
+    ADT_ASSERT_ALWAYS(aBig.size() == N_KEYS + 1, "{}", aBig.size());
+
+    json::ObjectIndex idx {&arena};
+    defer( idx.destroy() );
+
+    /* Agrees with the linear search, including the duplicate and missing keys. */
+    Vec<String> vKeys {&arena};
+    for (isize i = 0; i < N_KEYS + 100; ++i)
+    {
+        char aBuff[64] {};
+        const isize n = print::toBuffer(aBuff, sizeof(aBuff) - 1, "key{}", i);
+        vKeys.push(&arena, String {&arena, aBuff, n});
+    }
+
+    for (const String& sKey : vKeys)
+        ADT_ASSERT_ALWAYS(idx.search(aBig, sKey) == json::searchNode(aBig, sKey), "key: {}", sKey);
+    ADT_ASSERT_ALWAYS(json::getInteger(idx.search(aBig, "key7")) == 7, "first duplicate wins");
+
+    ADT_ASSERT_ALWAYS(idx.search(aSmall, "b") == &aSmall[1] && !idx.search(aSmall, "d"), "");
+
+    /* Batch forms against one by one. */
+    {
+        Vec<StringView> vQuery {&arena};
+        rng::PCG32 rng {9};
+        for (isize i = 0; i < 1000; ++i) vQuery.push(&arena, vKeys[rng.nextInRange(0, u32(vKeys.size() - 1))]);
+
+        Vec<json::Node*> vRes0 {&arena, vQuery.size()};
+        Vec<json::Node*> vRes1 {&arena, vQuery.size()};
+        vRes0.setSize(&arena, vQuery.size());
+        vRes1.setSize(&arena, vQuery.size());
+
+        const isize nFound0 = json::searchNodes(aBig, {vQuery.data(), vQuery.size()}, {vRes0.data(), vRes0.size()});
+        const isize nFound1 = idx.searchNodes(aBig, {vQuery.data(), vQuery.size()}, {vRes1.data(), vRes1.size()});
+        ADT_ASSERT_ALWAYS(nFound0 == nFound1, "{}, {}", nFound0, nFound1);
+
+        isize nExpected = 0;
+        for (isize i = 0; i < vQuery.size(); ++i)
+        {
+            json::Node* pNode = json::searchNode(aBig, vQuery[i]);
+            nExpected += pNode != nullptr;
+            ADT_ASSERT_ALWAYS(vRes0[i] == pNode && vRes1[i] == pNode, "i: {}", i);
+        }
+        ADT_ASSERT_ALWAYS(nFound0 == nExpected, "{}, {}", nFound0, nExpected);
+
+        StringView aSmallKeys[] {"c", "x", "a"};
+        json::Node* aSmallRes[3] {};
+        ADT_ASSERT_ALWAYS(idx.searchNodes(aSmall, aSmallKeys, aSmallRes) == 2, "");
+        ADT_ASSERT_ALWAYS(aSmallRes[0] == &aSmall[2] && !aSmallRes[1] && aSmallRes[2] == &aSmall[0], "");
+
+        /* Timing: repeated queries against the 5000 key object. */
+        constexpr int NITERS = 20;
+        isize n0 = 0, n1 = 0, n2 = 0;
+
+        auto t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+            for (StringView sv : vQuery) n0 += json::searchNode(aBig, sv) != nullptr;
+        const f64 msLinear = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+            for (StringView sv : vQuery) n1 += idx.search(aBig, sv) != nullptr;
+        const f64 msIndexed = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+            n2 += idx.searchNodes(aBig, {vQuery.data(), vQuery.size()}, {vRes1.data(), vRes1.size()});
+        const f64 msBatch = time::diffMSec(time::now(), t0);
+
+        ADT_ASSERT_ALWAYS(n0 == n1 && n1 == n2, "{}, {}, {}", n0, n1, n2);
+        LogInfo{"{}x{} lookups in a {} key object: searchNode: {:.3} ms, ObjectIndex::search: {:.3} ms, ObjectIndex::searchNodes: {:.3} ms\n",
+            NITERS, vQuery.size(), aBig.size(), msLinear, msIndexed, msBatch
+        };
+    }
+
+    /* Pushing to the object rebuilds its map, invalidate() drops it. */
+    {
+        aBig.push(&arena, json::makeNumber("added", 42));
+        ADT_ASSERT_ALWAYS(idx.search(aBig, "added") == &aBig.last(), "");
+
+        idx.invalidate(aBig);
+        ADT_ASSERT_ALWAYS(json::getInteger(idx.search(aBig, "added")) == 42, "");
+    }
+
+    /* Same storage and size, different contents (what an arena reset and reparse looks like). */
+    {
+        ADT_ASSERT_ALWAYS(idx.search(aBig, "key10") == &aBig[10] && idx.search(aBig, "key20") == &aBig[20], "");
+
+        /* First and last keys unchanged: caught by the key check on the hit. */
+        utils::swap(&aBig[10], &aBig[20]);
+        ADT_ASSERT_ALWAYS(idx.search(aBig, "key10") == &aBig[20] && idx.search(aBig, "key20") == &aBig[10], "");
+
+        StringView aKeys[] {"key20", "key10", "key30"};
+        json::Node* aRes[3] {};
+        ADT_ASSERT_ALWAYS(idx.searchNodes(aBig, aKeys, aRes) == 3, "");
+        ADT_ASSERT_ALWAYS(aRes[0] == &aBig[10] && aRes[1] == &aBig[20] && aRes[2] == &aBig[30], "");
+
+        /* Every key replaced. */
+        Vec<String> vNewKeys {&arena};
+        for (isize i = 0; i < aBig.size(); ++i)
+        {
+            char aBuff[64] {};
+            const isize n = print::toBuffer(aBuff, sizeof(aBuff) - 1, "new{}", i);
+            vNewKeys.push(&arena, String {&arena, aBuff, n});
+            aBig[i].svKey = vNewKeys.last();
+        }
+        ADT_ASSERT_ALWAYS(!idx.search(aBig, "key10") && idx.search(aBig, "new77") == &aBig[77], "");
+    }
+
+    LogInfo("JSONObjectIndex test passed\n");
+}
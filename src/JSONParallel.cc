@@ -0,0 +1,159 @@
+#include "json/ParallelParser.hh"
+
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/ThreadPool.hh"
+#include "adt/rng.hh"
+#include "adt/time.hh"
+
+#include <unistd.h>
+
+using namespace adt;
+
+static constexpr isize N_RECORDS = 200000;
+
+static void
+append(Vec<char>* pv, StringView sv)
+{
+    for (char c : sv) pv->push(Gpa::inst(), c);
+}
+
+/* One object per line, some lines are much longer than others, a few blank lines. */
+static void
+genRecords(Vec<char>* pv, isize nRecords, u64 seed)
+{
+    rng::PCG32 rng {seed};
+
+    for (isize i = 0; i < nRecords; ++i)
+    {
+        char aBuff[128] {};
+        print::toBuffer(aBuff, sizeof(aBuff) - 1, "{{\"id\": {}, \"score\": {}.5, \"ok\": {}, \"tags\": [",
+            i, rng.nextInRange(0, 1000), rng.nextInRange(0, 1) ? "true" : "false"
+        );
+        append(pv, aBuff);
+
+        const u32 nTags = rng.nextInRange(0, 100) < 2 ? rng.nextInRange(100, 500) : rng.nextInRange(0, 5);
+        for (u32 j = 0; j < nTags; ++j)
+        {
+            print::toBuffer(aBuff, sizeof(aBuff) - 1, "{}\"t\\\"{}\"", j > 0 ? ", " : "", rng.nextInRange(0, 99));
+            append(pv, aBuff);
+        }
+
+        append(pv, "], \"user\": {\"name\": \"somebody\", \"nested\": {\"a\": null}}}\n");
+        if (rng.nextInRange(0, 1000) == 0) append(pv, "\n");
+    }
+}
+
+static void
+checkRoots(const Vec<json::Node>& vRoots, const Vec<json::Node>& vRef)
+{
+    ADT_ASSERT_ALWAYS(vRoots.size() == N_RECORDS && vRef.size() == N_RECORDS, "{}, {}", vRoots.size(), vRef.size());
+
+    for (isize i = 0; i < vRoots.size(); ++i)
+    {
+        const Vec<json::Node>& aObj = json::getObject(&vRoots[i]);
+        const Vec<json::Node>& aRef = json::getObject(&vRef[i]);
+        ADT_ASSERT_ALWAYS(aObj.size() == aRef.size(), "i: {}", i);
+
+        ADT_ASSERT_ALWAYS(json::getInteger(json::searchNode(aObj, "id")) == i, "i: {}", i);
+        ADT_ASSERT_ALWAYS(json::getFloat(json::searchNode(aObj, "score")) == json::getFloat(json::searchNode(aRef, "score")), "i: {}", i);
+
+        const Vec<json::Node>& aTags = json::getArray(json::searchNode(aObj, "tags"));
+        const Vec<json::Node>& aRefTags = json::getArray(json::searchNode(aRef, "tags"));
+        ADT_ASSERT_ALWAYS(aTags.size() == aRefTags.size(), "i: {}", i);
+        for (isize j = 0; j < aTags.size(); ++j)
+            ADT_ASSERT_ALWAYS(json::getString(&aTags[j]) == json::getString(&aRefTags[j]), "i: {}, j: {}", i, j);
+    }
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("JSONParallel test...\n");
+
+    Vec<char> vJson {Gpa::inst()};
+    defer( vJson.destroy(Gpa::inst()) );
+    genRecords(&vJson, N_RECORDS, 1);
+
+    char ntsPath[] = "/tmp/adtJSONParallelXXXXXX";
+    const int fdTmp = mkstemp(ntsPath);
+    ADT_ASSERT_ALWAYS(fdTmp != -1, "");
+    close(fdTmp);
+    defer( unlink(ntsPath) );
+    ADT_ASSERT_ALWAYS(file::store({vJson.data(), vJson.size()}, ntsPath) == vJson.size(), "");
+
+    /* Reference: one Parser over the whole file. */
+    Arena arena {SIZE_1G*4};
+    defer( arena.freeAll() );
+
+    auto t0 = time::now();
+    json::Parser pRef {};
+    ADT_ASSERT_ALWAYS(pRef.parse(&arena, {vJson.data(), vJson.size()}), "");
+    const f64 msSerial = time::diffMSec(time::now(), t0);
+
+    LogInfo{"{} records, {} MB, {} hardware threads, Parser: {:.3} ms\n",
+        N_RECORDS, vJson.size() / SIZE_1M, IThreadPool::optimalThreadCount(), msSerial
+    };
+
+    for (int nThreads : {1, 2, 4, 8})
+    {
+        ThreadPool tp {Arena{}, SIZE_1K, SIZE_1G*2, nThreads};
+        defer( tp.destroy() );
+
+        json::ParallelParser pp {};
+        defer( pp.destroy() );
+
+        t0 = time::now();
+        ADT_ASSERT_ALWAYS(pp.parseFile(Gpa::inst(), &tp, ntsPath), "");
+        const f64 ms = time::diffMSec(time::now(), t0);
+
+        checkRoots(pp.roots(), pRef.getRoots());
+        LogInfo("ParallelParser, {} pool threads + caller: {:.3} ms\n", nThreads, ms);
+    }
+
+    /* Small batches, and a broken record fails the whole parse. */
+    {
+        ThreadPool tp {Arena{}, SIZE_1K, SIZE_1G, 2};
+        defer( tp.destroy() );
+
+        json::ParallelParser pp {};
+        defer( pp.destroy() );
+        ADT_ASSERT_ALWAYS(pp.parse(Gpa::inst(), &tp, {vJson.data(), vJson.size()}, SIZE_1K), "");
+        checkRoots(pp.roots(), pRef.getRoots());
+
+        json::ParallelParser ppBad {};
+        defer( ppBad.destroy() );
+        StringView svBad = "{\"id\": 0}\n{\"id\": 1}\n\n{\"id\": }\n{\"id\": 3}\n";
+        ADT_ASSERT_ALWAYS(!ppBad.parse(Gpa::inst(), &tp, svBad, 1), "");
+
+        /* From a thread that has no pool arena: its batches go to pAlloc. */
+        {
+            Arena arenaCaller {SIZE_1G};
+            json::ParallelParser ppThread {};
+            bool bOk = false;
+
+            auto clParse = [&]
+            {
+                bOk = ppThread.parse(&arenaCaller, &tp, {vJson.data(), vJson.size()});
+                return THREAD_STATUS(0);
+            };
+            Thread thrd {clParse};
+            thrd.join();
+
+            ADT_ASSERT_ALWAYS(bOk, "");
+            checkRoots(ppThread.roots(), pRef.getRoots());
+            ppThread.destroy();
+            arenaCaller.freeAll();
+        }
+
+        json::ParallelParser ppEmpty {};
+        defer( ppEmpty.destroy() );
+        ADT_ASSERT_ALWAYS(ppEmpty.parse(Gpa::inst(), &tp, "\n\n", 1) && ppEmpty.roots().empty(), "");
+    }
+
+    LogInfo("JSONParallel test passed\n");
+}
@@ -0,0 +1,215 @@
+#include "json/Reader.hh"
+#include "json/Tape.hh"
+
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/file.hh"
+#include "adt/rng.hh"
+#include "adt/time.hh"
+
+#include <unistd.h>
+
+using namespace adt;
+
+static void
+append(Vec<char>* pv, StringView sv)
+{
+    for (char c : sv) pv->push(Gpa::inst(), c);
+}
+
+/* One record per line, with escapes, nested arrays and strings longer than small chunks. */
+static void
+genRecords(Vec<char>* pv, isize nRecords, u64 seed)
+{
+    rng::PCG32 rng {seed};
+
+    for (isize i = 0; i < nRecords; ++i)
+    {
+        char aBuff[128] {};
+        print::toBuffer(aBuff, sizeof(aBuff) - 1, "{{\"id\": {}, \"score\": {}.25, \"ok\": {}, \"none\": null, ",
+            i, rng.nextInRange(0, 1000), rng.nextInRange(0, 1) ? "true" : "false"
+        );
+        append(pv, aBuff);
+
+        append(pv, "\"msg\": \"");
+        const u32 len = rng.nextInRange(0, 100) < 5 ? rng.nextInRange(200, 3000) : rng.nextInRange(0, 20);
+        for (u32 j = 0; j < len; ++j)
+        {
+            switch (rng.nextInRange(0, 10))
+            {
+                case 0: append(pv, "\\\""); break;
+                case 1: append(pv, "\\\\"); break;
+                case 2: append(pv, "{[,:]}"); break;
+                default: pv->push(Gpa::inst(), char('a' + rng.nextInRange(0, 25))); break;
+            }
+        }
+        append(pv, "\", ");
+
+        append(pv, "\"payload\": {\"m\": [[1, 2], [3, -4e3]], \"s\": [\"x\", {}], \"e\": []}}\n");
+    }
+}
+
+/* Event stream as text, to compare runs with different chunk sizes. */
+static isize
+eventsToString(json::Reader* pReader, Vec<char>* pvOut)
+{
+    isize nEvents = 0;
+    for (json::Event e = pReader->next(); ; e = pReader->next(), ++nEvents)
+    {
+        char aBuff[64] {};
+        print::toBuffer(aBuff, sizeof(aBuff) - 1, "{} {} ", getEVENTString(e.eType), pReader->depth());
+        append(pvOut, aBuff);
+        append(pvOut, e.sv);
+        if (e.eType == json::EVENT::LONG || e.eType == json::EVENT::DOUBLE)
+        {
+            print::toBuffer(aBuff, sizeof(aBuff) - 1, " {}", e.eType == json::EVENT::LONG ? f64(e.val.l) : e.val.d);
+            append(pvOut, aBuff);
+        }
+        pvOut->push(Gpa::inst(), '\n');
+
+        if (e.eType == json::EVENT::END || e.eType == json::EVENT::ERROR) break;
+    }
+
+    return nEvents;
+}
+
+/* Sum of the depth 1 "id" fields, payloads skipped. */
+static i64
+sumIds(json::Reader* pReader, isize* pNRecords)
+{
+    i64 sum = 0;
+    for (json::Event e = pReader->next(); e.eType != json::EVENT::END; e = pReader->next())
+    {
+        ADT_ASSERT_ALWAYS(e.eType != json::EVENT::ERROR, "");
+
+        if (e.eType == json::EVENT::KEY && pReader->depth() == 1)
+        {
+            if (e.sv == "id")
+            {
+                e = pReader->next();
+                sum += e.val.l;
+                ++*pNRecords;
+            }
+            else if (e.sv == "payload")
+            {
+                e = pReader->next();
+                ADT_ASSERT_ALWAYS(e.eType == json::EVENT::OBJECT_BEGIN, "");
+                ADT_ASSERT_ALWAYS(pReader->skip() && pReader->depth() == 1, "");
+            }
+        }
+    }
+
+    return sum;
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("JSONReader test...\n");
+
+    Arena arena {SIZE_1G};
+    defer( arena.freeAll() );
+
+    /* Same events whatever the chunk size. */
+    {
+        Vec<char> vJson {Gpa::inst()};
+        defer( vJson.destroy(Gpa::inst()) );
+        genRecords(&vJson, 300, 1);
+
+        Vec<char> vRef {Gpa::inst()};
+        defer( vRef.destroy(Gpa::inst()) );
+
+        StringView svIn {vJson.data(), vJson.size()};
+        json::Reader rRef {&arena, json::readFromView, &svIn, vJson.size()};
+        const isize nEvents = eventsToString(&rRef, &vRef);
+        rRef.destroy();
+
+        ADT_ASSERT_ALWAYS(StringView(vRef.data(), vRef.size()).contains("END 0"), "");
+
+        for (isize chunkSize : {1, 2, 3, 7, 64, 4096})
+        {
+            Vec<char> v {Gpa::inst()};
+            defer( v.destroy(Gpa::inst()) );
+
+            svIn = {vJson.data(), vJson.size()};
+            json::Reader r {&arena, json::readFromView, &svIn, chunkSize};
+            const isize n = eventsToString(&r, &v);
+            r.destroy();
+
+            ADT_ASSERT_ALWAYS(n == nEvents && StringView(v.data(), v.size()) == StringView(vRef.data(), vRef.size()),
+                "chunkSize: {}, {} vs {} events", chunkSize, n, nEvents
+            );
+        }
+
+        LogInfo("{} events, same for all chunk sizes\n", nEvents);
+    }
+
+    /* Malformed input ends with ERROR and stays there. */
+    for (StringView sv : {StringView(R"({"a": [1, 2})"), StringView(R"({"a": "unterminated)"), StringView(R"({"a" 1})"), StringView("[tru]")})
+    {
+        json::Reader r {&arena, json::readFromView, &sv, 4};
+        json::EVENT e;
+        do e = r.next().eType;
+        while (e != json::EVENT::ERROR && e != json::EVENT::END);
+
+        ADT_ASSERT_ALWAYS(e == json::EVENT::ERROR && r.next().eType == json::EVENT::ERROR, "");
+        r.destroy();
+    }
+
+    /* NDJSON file through a descriptor, against the Tape of the whole file. */
+    {
+        constexpr isize N_RECORDS = 100000;
+
+        Vec<char> vJson {Gpa::inst()};
+        defer( vJson.destroy(Gpa::inst()) );
+        genRecords(&vJson, N_RECORDS, 2);
+
+        char ntsPath[] = "/tmp/adtJSONReaderXXXXXX";
+        const int fdTmp = mkstemp(ntsPath);
+        ADT_ASSERT_ALWAYS(fdTmp != -1, "");
+        close(fdTmp);
+        defer( unlink(ntsPath) );
+        ADT_ASSERT_ALWAYS(file::store({vJson.data(), vJson.size()}, ntsPath) == vJson.size(), "");
+
+        isize nRecords = 0;
+        auto t0 = time::now();
+        i64 sumReader = 0;
+        {
+            const int fd = open(ntsPath, O_RDONLY);
+            ADT_ASSERT_ALWAYS(fd != -1, "");
+            defer( close(fd) );
+
+            json::Reader r {&arena, json::readFromFd, (void*)isize(fd)};
+            defer( r.destroy() );
+            sumReader = sumIds(&r, &nRecords);
+        }
+        const f64 msReader = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        i64 sumTape = 0;
+        {
+            file::Mapped mapped = file::map(ntsPath);
+            defer( mapped.unmap() );
+
+            json::Tape tape {};
+            ADT_ASSERT_ALWAYS(tape.parse(&arena, mapped), "");
+            for (u32 i = 0; i < tape.size(); i = tape.nextSibling(i))
+                sumTape += tape[tape.search(i, "id")].val.l;
+        }
+        const f64 msTape = time::diffMSec(time::now(), t0);
+
+        ADT_ASSERT_ALWAYS(nRecords == N_RECORDS && sumReader == sumTape && sumTape == N_RECORDS * (N_RECORDS - 1) / 2,
+            "{}, {}, {}", nRecords, sumReader, sumTape
+        );
+
+        LogInfo{"{} records, {} MB: Reader from fd (64K chunks): {:.3} ms, file::map + Tape: {:.3} ms\n",
+            nRecords, vJson.size() / SIZE_1M, msReader, msTape
+        };
+    }
+
+    LogInfo("JSONReader test passed\n");
+}
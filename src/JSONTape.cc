@@ -0,0 +1,181 @@
+#include "json/Tape.hh"
+
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/rng.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static void
+append(Vec<char>* pv, StringView sv)
+{
+    for (char c : sv) pv->push(Gpa::inst(), c);
+}
+
+/* Random json the Parser can take too (no arrays directly inside of arrays). */
+static void
+genValue(Vec<char>* pv, rng::PCG32* pRng, int depth, bool bInArray = false)
+{
+    u32 kind = depth > 4 ? pRng->nextInRange(2, 6) : pRng->nextInRange(0, 6);
+    if (kind == 1 && bInArray) kind = 0;
+
+    switch (kind)
+    {
+        case 0:
+        case 1:
+        {
+            const bool bObj = kind == 0;
+            pv->push(Gpa::inst(), bObj ? '{' : '[');
+            const u32 n = pRng->nextInRange(0, 6);
+            for (u32 i = 0; i < n; ++i)
+            {
+                if (bObj)
+                {
+                    char aBuff[32] {};
+                    const isize nKey = print::toBuffer(aBuff, sizeof(aBuff) - 1, "\"k{}\": ", i);
+                    append(pv, {aBuff, nKey});
+                }
+                genValue(pv, pRng, depth + 1, !bObj);
+                if (i + 1 < n) append(pv, ", ");
+            }
+            pv->push(Gpa::inst(), bObj ? '}' : ']');
+        }
+        break;
+
+        case 2: append(pv, "\"str\\\"ing\""); break;
+        case 3: append(pv, "-1234567"); break;
+        case 4: append(pv, "3.5"); break;
+        case 5: append(pv, pRng->nextInRange(0, 1) ? "true" : "false"); break;
+        case 6: append(pv, "null"); break;
+    }
+}
+
+static StringView
+printed(Arena* pArena, auto* pDoc)
+{
+    FILE* fp = tmpfile();
+    ADT_ASSERT_ALWAYS(fp, "");
+    defer( fclose(fp) );
+
+    pDoc->print(Gpa::inst(), fp);
+
+    const isize size = ftell(fp);
+    rewind(fp);
+    char* pData = pArena->mallocV<char>(size);
+    ADT_ASSERT_ALWAYS(isize(fread(pData, 1, size, fp)) == size, "");
+    return {pData, size};
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("JSONTape test...\n");
+
+    Arena arena {SIZE_1G};
+    defer( arena.freeAll() );
+
+    /* Same document as the Node tree. */
+    rng::PCG32 rng {11};
+    for (int round = 0; round < 300; ++round)
+    {
+        Vec<char> v {Gpa::inst()};
+        defer( v.destroy(Gpa::inst()) );
+
+        append(&v, "{\"root\": ");
+        genValue(&v, &rng, 0);
+        append(&v, "}\n");
+        const StringView sv {v.data(), v.size()};
+
+        json::Parser p {};
+        ADT_ASSERT_ALWAYS(p.parse(&arena, sv), "round: {}", round);
+        json::Tape tape {};
+        ADT_ASSERT_ALWAYS(tape.parse(&arena, sv), "round: {}", round);
+
+        const StringView s0 = printed(&arena, &p);
+        const StringView s1 = printed(&arena, &tape);
+        ADT_ASSERT_ALWAYS(s0 == s1, "round: {}\n{}\n{}", round, s0, s1);
+
+        arena.reset();
+    }
+
+    /* Nested arrays, skipping and search. */
+    {
+        json::Tape tape {};
+        ADT_ASSERT_ALWAYS(tape.parse(&arena, R"([[1, 2], [3, [4, {"a": 5}]], {"x": [], "y": {}, "z": "zz"}])"), "");
+        defer( tape.destroy(&arena) );
+
+        ADT_ASSERT_ALWAYS(tape[0].eTag == json::TAG::ARRAY && tape[0].val.nChildren == 3 && tape[0].next == tape.size(), "");
+
+        u32 aChildren[3] {};
+        isize n = 0;
+        tape.forEachChild(0, [&](u32 childI) { aChildren[n++] = childI; });
+        ADT_ASSERT_ALWAYS(n == 3, "{}", n);
+        ADT_ASSERT_ALWAYS(tape[aChildren[0]].val.nChildren == 2 && tape[aChildren[1]].val.nChildren == 2, "");
+
+        const u32 lastI = aChildren[2];
+        ADT_ASSERT_ALWAYS(tape[lastI].eTag == json::TAG::OBJECT && tape[lastI].val.nChildren == 3, "");
+
+        const u32 zI = tape.search(lastI, "z");
+        ADT_ASSERT_ALWAYS(zI != NPOS32 && tape[zI].val.s == "zz", "");
+        ADT_ASSERT_ALWAYS(tape.search(lastI, "a") == NPOS32, "only direct children");
+
+        const u32 xI = tape.search(lastI, "x");
+        ADT_ASSERT_ALWAYS(tape[xI].eTag == json::TAG::ARRAY && tape[xI].val.nChildren == 0 && tape[xI].next == xI + 1, "");
+    }
+
+    /* Records: tree vs tape. */
+    {
+        constexpr int N_RECORDS = 50000;
+
+        Vec<char> v {Gpa::inst()};
+        defer( v.destroy(Gpa::inst()) );
+
+        append(&v, "{\"records\": [\n");
+        for (int i = 0; i < N_RECORDS; ++i)
+        {
+            char aBuff[256] {};
+            print::toBuffer(aBuff, sizeof(aBuff) - 1,
+                "  {{\"id\": {}, \"name\": \"record{}\", \"tags\": [\"a\", \"b\", \"c\"], \"pos\": {{\"x\": 1.5, \"y\": 2.5}, \"active\": true}{}\n",
+                i, i, i + 1 < N_RECORDS ? "," : ""
+            );
+            append(&v, aBuff); /* toBuffer() doesn't count escaped braces. */
+        }
+        append(&v, "]}");
+        const StringView sv {v.data(), v.size()};
+
+        i64 sumTree = 0, sumTape = 0;
+
+        auto t0 = time::now();
+        json::Parser p {};
+        ADT_ASSERT_ALWAYS(p.parse(&arena, sv), "");
+        const f64 msParseTree = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (const json::Node& rec : json::getArray(json::searchNode(p.getRoot(), "records")))
+            sumTree += json::getInteger(json::searchNode(json::getObject(&rec), "id"));
+        const f64 msWalkTree = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        json::Tape tape {};
+        ADT_ASSERT_ALWAYS(tape.parse(&arena, sv), "");
+        const f64 msParseTape = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        tape.forEachChild(tape.search(0, "records"), [&](u32 recI) {
+            sumTape += tape[tape.search(recI, "id")].val.l;
+        });
+        const f64 msWalkTape = time::diffMSec(time::now(), t0);
+
+        ADT_ASSERT_ALWAYS(sumTree == sumTape && sumTree == i64(N_RECORDS) * (N_RECORDS - 1) / 2, "{}, {}", sumTree, sumTape);
+        LogInfo{"{} records ({} KB, {} tape entries): Node tree: parse {:.3} ms, walk {:.3} ms; Tape: parse {:.3} ms, walk {:.3} ms\n",
+            N_RECORDS, sv.size() / 1024, tape.size(), msParseTree, msWalkTree, msParseTape, msWalkTape
+        };
+    }
+
+    LogInfo("JSONTape test passed\n");
+}
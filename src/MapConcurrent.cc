@@ -0,0 +1,121 @@
+#include "adt/MapConcurrent.hh"
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr int NKEYS = 1 << 16;
+static constexpr int NTASKS = 64;
+static constexpr int NLOOKUPS = 1 << 15;
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("MapConcurrent test...\n");
+
+    ThreadPool tp {Arena{}, SIZE_1K, SIZE_1M};
+    defer( tp.destroy() );
+
+    Gpa* pGpa = Gpa::inst();
+
+    MapConcurrent<int, int> map {pGpa, NKEYS};
+    defer( map.destroy(pGpa) );
+
+    /* Overlapping inserts from every task: only one of them wins for each key. */
+    atomic::Int atomNInserted {};
+    for (int t = 0; t < NTASKS; ++t)
+    {
+        tp.addRetry([&, t] {
+            for (int i = t; i < NKEYS; i += NTASKS / 4)
+            {
+                if (map.tryEmplace(pGpa, i, i * 2) == MAP_RESULT_STATUS::INSERTED)
+                    atomNInserted.fetchAdd(1, atomic::ORDER::RELAXED);
+            }
+        });
+    }
+    tp.wait(true);
+
+    ADT_ASSERT_ALWAYS(atomNInserted.load(atomic::ORDER::RELAXED) == NKEYS, "{}", atomNInserted.load(atomic::ORDER::RELAXED));
+    ADT_ASSERT_ALWAYS(map.size() == NKEYS, "{}", map.size());
+
+    for (int i = 0; i < NKEYS; ++i)
+        ADT_ASSERT_ALWAYS(map.search(i).valueOr(-1) == i * 2, "i: {}, got: {}", i, map.search(i).valueOr(-1));
+    ADT_ASSERT_ALWAYS(!map.contains(NKEYS), "");
+
+    /* Writers remove odd keys while readers look up even ones. */
+    for (int t = 0; t < NTASKS; ++t)
+    {
+        tp.addRetry([&, t] {
+            if (t % 2 == 0)
+            {
+                for (int i = t / 2 * 2 + 1; i < NKEYS; i += NTASKS)
+                    ADT_ASSERT_ALWAYS(map.tryRemove(i), "i: {}", i);
+            }
+            else
+            {
+                for (int i = 0; i < NKEYS; i += 2)
+                    ADT_ASSERT_ALWAYS(map.search(i), "i: {}", i);
+            }
+        });
+    }
+    tp.wait(true);
+
+    ADT_ASSERT_ALWAYS(map.size() == NKEYS / 2, "{}", map.size());
+
+    atomic::Long atomSum {};
+    map.forEach(&tp, [&](KeyVal<int, int>& kv) {
+        kv.val += 1;
+        atomSum.fetchAdd(kv.val, atomic::ORDER::RELAXED);
+    });
+
+    i64 expectedSum = 0;
+    for (int i = 0; i < NKEYS; i += 2) expectedSum += i * 2 + 1;
+    ADT_ASSERT_ALWAYS(atomSum.load(atomic::ORDER::RELAXED) == expectedSum,
+        "expected: {}, got: {}", expectedSum, atomSum.load(atomic::ORDER::RELAXED)
+    );
+
+    /* Read-mostly lookups: sharded RWLocks against one Mutex around a Map. */
+    {
+        Mutex mtx {Mutex::TYPE::PLAIN};
+        Map<int, int> mapLocked {pGpa, NKEYS};
+        defer( mtx.destroy(); mapLocked.destroy(pGpa) );
+
+        for (int i = 0; i < NKEYS; i += 2) mapLocked.insert(pGpa, i, i * 2 + 1);
+
+        auto t0 = time::now();
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                for (int i = 0; i < NLOOKUPS; ++i)
+                    [[maybe_unused]] auto o = map.search((i * 2 + t) % NKEYS);
+            });
+        }
+        tp.wait(true);
+        const f64 shardedMS = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                for (int i = 0; i < NLOOKUPS; ++i)
+                {
+                    LockScope lock {&mtx};
+                    [[maybe_unused]] auto f = mapLocked.search((i * 2 + t) % NKEYS);
+                }
+            });
+        }
+        tp.wait(true);
+        const f64 lockedMS = time::diffMSec(time::now(), t0);
+
+        LogInfo{"{} lookups on {} threads: MapConcurrent({} shards): {:.3} ms, Map + Mutex: {:.3} ms\n",
+            NTASKS * NLOOKUPS, tp.nThreads(), map.nShards(), shardedMS, lockedMS
+        };
+    }
+
+    LogInfo("MapConcurrent test passed\n");
+}
@@ -1,6 +1,8 @@
 #include "adt/Gpa.hh" /* IWYU pragma: keep */
 #include "adt/defer.hh"
 #include "adt/Map.hh"
+#include "adt/MapSwiss.hh"
+#include "adt/Set.hh"
 #include "adt/Span.hh" /* IWYU pragma: keep */
 #include "adt/rng.hh"
 #include "adt/time.hh"
@@ -82,6 +84,127 @@ genRandomString(IAllocator* pAlloc)
     return s;
 }
 
+template<typename MAP_T>
+static void
+benchSearch(const char* ntsName, Span<String> spStrings)
+{
+    MAP_T map {};
+    defer( map.destroy() );
+
+    auto timer = time::now();
+    for (isize i = 0; i < spStrings.size(); ++i)
+        map.tryInsert(spStrings[i], i);
+    const f64 insertMS = time::diffMSec(time::now(), timer);
+
+    timer = time::now();
+    isize nFound = 0;
+    for (const auto& s : spStrings)
+        nFound += bool(map.search(s));
+    const f64 searchMS = time::diffMSec(time::now(), timer);
+
+    ADT_ASSERT_ALWAYS(nFound == spStrings.size(), "nFound: {}, size: {}", nFound, spStrings.size());
+
+    /* Misses walk the whole probe sequence. */
+    timer = time::now();
+    isize nMissed = 0;
+    for (const auto& s : spStrings)
+        nMissed += !map.search(s.subString(0, s.size() - 1));
+    const f64 missMS = time::diffMSec(time::now(), timer);
+
+    isize nIterated = 0;
+    timer = time::now();
+    for ([[maybe_unused]] auto& kv : map) ++nIterated;
+    const f64 iterMS = time::diffMSec(time::now(), timer);
+
+    ADT_ASSERT_ALWAYS(nIterated == map.size(), "nIterated: {}, size: {}", nIterated, map.size());
+
+    LogDebug("({}) tryInsert: {:.3} ms, search: {:.3} ms, search misses({}): {:.3} ms, iterate: {:.3} ms\n",
+        ntsName, insertMS, searchMS, nMissed, missMS, iterMS
+    );
+}
+
+/* Constant size, lots of removals: probe sequences must not degrade. */
+template<typename MAP_T>
+static void
+benchChurn(const char* ntsName)
+{
+    constexpr int SIZE = 100000;
+    constexpr int NROUNDS = 20;
+
+    MAP_T map {SIZE};
+    defer( map.destroy() );
+
+    for (int i = 0; i < SIZE; ++i) map.insert(i, i);
+
+    const isize cap0 = map.cap();
+    auto timer = time::now();
+
+    for (int round = 0; round < NROUNDS; ++round)
+    {
+        for (int i = 0; i < SIZE; ++i)
+        {
+            const int key = round*SIZE + i;
+            map.remove(key);
+            map.insert(key + SIZE, i);
+        }
+    }
+
+    const f64 churnMS = time::diffMSec(time::now(), timer);
+
+    timer = time::now();
+    for (int i = 0; i < SIZE; ++i)
+        ADT_ASSERT_ALWAYS(map.search(NROUNDS*SIZE + i), "i: {}", i);
+    const f64 searchMS = time::diffMSec(time::now(), timer);
+
+    LogDebug("({}) churn {} remove+insert: {:.3} ms, then search {}: {:.3} ms, cap: {} -> {}\n",
+        ntsName, SIZE*NROUNDS, churnMS, SIZE, searchMS, cap0, map.cap()
+    );
+}
+
+/* Map that doesn't fit in cache: every search() is a dependent cache miss, searchBatch() overlaps them. */
+static void
+benchSearchBatch()
+{
+    constexpr isize BIG = 1 << 24;
+    constexpr isize NLOOKUPS = 1 << 22;
+    constexpr isize CHUNK = 1024;
+
+    auto clKey = [](isize i) { return u32(i) * 2654435761u; }; /* Odd multiplier: unique keys. */
+
+    MapM<u32, u32> map {BIG};
+    VecM<u32> vLookups {NLOOKUPS};
+    VecM<MapResult<u32, u32>> vResults {CHUNK};
+    defer( map.destroy(); vLookups.destroy(); vResults.destroy() );
+
+    for (isize i = 0; i < BIG; ++i) map.insert(clKey(i), u32(i));
+
+    rng::PCG32 rng {2};
+    for (isize i = 0; i < NLOOKUPS; ++i)
+        vLookups.push(clKey(rng.next() % (BIG + BIG/4))); /* ~20% misses. */
+    vResults.setSize(CHUNK);
+
+    auto timer = time::now();
+    isize nFoundLoop = 0;
+    for (const u32 key : vLookups) nFoundLoop += bool(map.search(key));
+    const f64 loopMS = time::diffMSec(time::now(), timer);
+
+    timer = time::now();
+    isize nFoundBatch = 0;
+    for (isize off = 0; off < NLOOKUPS; off += CHUNK)
+    {
+        nFoundBatch += map.searchBatch(
+            Span<const u32> {vLookups.data() + off, CHUNK}, Span<MapResult<u32, u32>> {vResults}
+        );
+    }
+    const f64 batchMS = time::diffMSec(time::now(), timer);
+
+    ADT_ASSERT_ALWAYS(nFoundLoop == nFoundBatch, "loop: {}, batch: {}", nFoundLoop, nFoundBatch);
+
+    LogDebug("Map<u32, u32> ({} entries, cap: {}): {} lookups: search() loop: {:.3} ms, searchBatch(): {:.3} ms ({:.2}x), found: {}\n",
+        map.size(), map.cap(), NLOOKUPS, loopMS, batchMS, loopMS / batchMS, nFoundBatch
+    );
+}
+
 static void
 microBench()
 {
@@ -161,6 +284,16 @@ microBench()
 
     LogDebug("\n");
 
+    benchSearch<MapManaged<StringView, int>>("Map", Span<String> {vStrings});
+    benchSearch<MapSwissManaged<StringView, int>>("MapSwiss", Span<String> {vStrings});
+
+    benchChurn<MapM<int, int>>("Map");
+    benchChurn<MapSwissM<int, int>>("MapSwiss");
+
+    benchSearchBatch();
+
+    LogDebug("\n");
+
     {
         struct StringViewHash
         {
@@ -424,6 +557,146 @@ main()
         LogDebug("two: {}\n", two.data());
     }
 
+    {
+        /* Map and MapSwiss against std::unordered_map with random inserts and removals. */
+        std::unordered_map<int, int> mapStd {};
+        MapM<int, int> map {};
+        MapSwissM<int, int> mapSwiss {};
+        defer( map.destroy(); mapSwiss.destroy() );
+
+        rng::PCG32 rng {1};
+        for (int i = 0; i < 200000; ++i)
+        {
+            const int key = rng.next() % 5000;
+            if (rng.next() % 3 == 0)
+            {
+                const bool bErased = mapStd.erase(key) == 1;
+                ADT_ASSERT_ALWAYS(bErased == map.tryRemove(key), "key: {}", key);
+                ADT_ASSERT_ALWAYS(bErased == mapSwiss.tryRemove(key), "key: {}", key);
+            }
+            else
+            {
+                mapStd[key] = i;
+                map.insert(key, i);
+                mapSwiss.insert(key, i);
+            }
+        }
+
+        ADT_ASSERT_ALWAYS(isize(mapStd.size()) == map.size(), "{} vs {}", mapStd.size(), map.size());
+        ADT_ASSERT_ALWAYS(isize(mapStd.size()) == mapSwiss.size(), "{} vs {}", mapStd.size(), mapSwiss.size());
+
+        isize n = 0;
+        for (auto& [k, v] : map)
+        {
+            ADT_ASSERT_ALWAYS(mapStd.at(k) == v, "k: {}, v: {}", k, v);
+            ++n;
+        }
+        ADT_ASSERT_ALWAYS(n == map.size(), "n: {}, size: {}", n, map.size());
+
+        n = 0;
+        for (auto& [k, v] : mapSwiss)
+        {
+            ADT_ASSERT_ALWAYS(mapStd.at(k) == v, "k: {}, v: {}", k, v);
+            ++n;
+        }
+        ADT_ASSERT_ALWAYS(n == mapSwiss.size(), "n: {}, size: {}", n, mapSwiss.size());
+
+        for (int key = 0; key < 5000; ++key)
+        {
+            ADT_ASSERT_ALWAYS(mapStd.contains(key) == bool(map.search(key)), "key: {}", key);
+            ADT_ASSERT_ALWAYS(mapStd.contains(key) == bool(mapSwiss.search(key)), "key: {}", key);
+        }
+    }
+
+    {
+        /* Constant size churn at high load: tombstones are cleaned up in place, nothing is allocated. */
+        IArena::IScope arenaScope = arena.restoreAfterScope();
+
+        constexpr int SIZE = 1500;
+        MapSwiss<int, String> mapSwiss {&arena, SIZE};
+        for (int i = 0; i < SIZE; ++i)
+        {
+            char aBuff[32] {};
+            mapSwiss.insert(&arena, i, String {&arena, aBuff, print::toSpan(aBuff, "v{}", i)});
+        }
+
+        const isize cap0 = mapSwiss.cap();
+        const usize used0 = arena.memoryUsed();
+        for (int i = 0; i < 100000; ++i)
+        {
+            const String s = mapSwiss.search(i).value();
+            mapSwiss.remove(i);
+            mapSwiss.insert(&arena, i + SIZE, s);
+        }
+
+        ADT_ASSERT_ALWAYS(mapSwiss.cap() == cap0 && arena.memoryUsed() == used0,
+            "cap: {} -> {}, used: {} -> {}", cap0, mapSwiss.cap(), used0, arena.memoryUsed()
+        );
+        ADT_ASSERT_ALWAYS(mapSwiss.size() == SIZE, "{}", mapSwiss.size());
+        for (int i = 100000; i < 100000 + SIZE; ++i)
+        {
+            char aBuff[32] {};
+            const StringView sv {aBuff, print::toSpan(aBuff, "v{}", i % SIZE)};
+            ADT_ASSERT_ALWAYS(mapSwiss.search(i).value() == sv, "i: {}", i);
+        }
+    }
+
+    {
+        /* Heterogeneous lookup and cached hashes with String keys. */
+        IArena::IScope arenaScope = arena.restoreAfterScope();
+
+        static_assert(MapBucket<String, int>::STORE_HASH && !MapBucket<int, int>::STORE_HASH);
+        static_assert(Map<String, int>::HETEROGENEOUS && !Map<StringView, int>::HETEROGENEOUS);
+
+        Map<String, int> mapStrings {&arena};
+        for (int i = 0; i < 1000; ++i)
+        {
+            char aBuff[64] {};
+            const isize n = print::toSpan(aBuff, "some/long/common/prefix/key{}", i);
+            mapStrings.insert(&arena, String {&arena, aBuff, n}, i);
+        }
+
+        for (int i = 0; i < 1000; i += 2)
+        {
+            char aBuff[64] {};
+            const isize n = print::toSpan(aBuff, "some/long/common/prefix/key{}", i);
+            mapStrings.remove(mapStrings.idx(mapStrings.search(StringView {aBuff, n})));
+        }
+
+        ADT_ASSERT_ALWAYS(mapStrings.search("some/long/common/prefix/key1").value() == 1, "");
+        ADT_ASSERT_ALWAYS(!mapStrings.search("some/long/common/prefix/key2"), "");
+        ADT_ASSERT_ALWAYS(mapStrings.search(StringView {"some/long/common/prefix/key999"}).value() == 999, "");
+        ADT_ASSERT_ALWAYS(mapStrings.size() == 500, "{}", mapStrings.size());
+
+        for (auto& [k, v] : mapStrings)
+            ADT_ASSERT_ALWAYS(mapStrings.search(k).value() == v, "k: '{}', v: {}", k, v);
+    }
+
+    {
+        /* searchBatch() against search(). */
+        IArena::IScope arenaScope = arena.restoreAfterScope();
+
+        Map<int, int> mapInts {&arena};
+        Set<int> setInts {&arena};
+        for (int i = 0; i < 100; i += 3) mapInts.insert(&arena, i, i * 10), setInts.insert(&arena, i);
+
+        int aKeys[100] {};
+        for (int i = 0; i < 100; ++i) aKeys[i] = i;
+
+        MapResult<int, int> aResults[100] {};
+        SetResult<int> aSetResults[100] {};
+        const isize nFound = mapInts.searchBatch(Span<const int> {aKeys}, Span<MapResult<int, int>> {aResults});
+        const isize nFoundSet = setInts.searchBatch(Span<const int> {aKeys}, Span<SetResult<int>> {aSetResults});
+
+        ADT_ASSERT_ALWAYS(nFound == mapInts.size() && nFoundSet == setInts.size(), "{}, {}", nFound, nFoundSet);
+        for (int i = 0; i < 100; ++i)
+        {
+            ADT_ASSERT_ALWAYS(bool(aResults[i]) == (i % 3 == 0), "i: {}", i);
+            ADT_ASSERT_ALWAYS(bool(aSetResults[i]) == (i % 3 == 0), "i: {}", i);
+            if (aResults[i]) ADT_ASSERT_ALWAYS(aResults[i].value() == i * 10, "i: {}", i);
+        }
+    }
+
     int buff[123] {};
     Span sp(buff);
     hash::func(sp);
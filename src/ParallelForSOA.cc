@@ -0,0 +1,151 @@
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/PoolSOA.hh"
+#include "adt/ThreadPool.hh"
+#include "adt/VecSOA.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+struct Body
+{
+    struct Bind
+    {
+        f32& x;
+        f32& y;
+        f32& vx;
+        f32& vy;
+        u8& flags;
+    };
+
+    f32 x {};
+    f32 y {};
+    f32 vx {};
+    f32 vy {};
+    u8 flags {};
+};
+
+using VecBodies = VecSOA<Body, Body::Bind, &Body::x, &Body::y, &Body::vx, &Body::vy, &Body::flags>;
+
+static constexpr isize N = SIZE_1M;
+static constexpr f32 DT = 0.5f;
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("ParallelForSOA test...\n");
+
+    ThreadPool tp {Arena{}, SIZE_1K, SIZE_1M};
+    defer( tp.destroy() );
+
+    VecBodies v {Gpa::inst(), N};
+    defer( v.destroy(Gpa::inst()) );
+
+    for (isize i = 0; i < N; ++i)
+        v.push(Gpa::inst(), {.x = f32(i), .y = -f32(i), .vx = 1.0f, .vy = 2.0f, .flags = u8(i)});
+
+    /* Columns see the same data as the Bind view. */
+    {
+        auto spX = v.column<&Body::x>();
+        auto spFlags = v.column<&Body::flags>();
+        ADT_ASSERT_ALWAYS(spX.size() == N && spFlags.size() == N, "");
+        for (isize i = 0; i < N; i += 997)
+        {
+            ADT_ASSERT_ALWAYS(&spX[i] == &v[i].x && &spFlags[i] == &v[i].flags, "i: {}", i);
+            ADT_ASSERT_ALWAYS(v.column<&Body::vy>(i, 1)[0] == 2.0f, "i: {}", i);
+        }
+    }
+
+    /* Every element is visited once, batches start on a cache line in every column. */
+    {
+        atomic::Num<isize> atomNVisited {};
+        parallelForSOA(&tp, v, [&](isize off, isize size) {
+            auto spX = v.column<&Body::x>(off, size);
+            auto spY = v.column<&Body::y>(off, size);
+            const auto spVX = v.column<&Body::vx>(off, size);
+            const auto spVY = v.column<&Body::vy>(off, size);
+            const auto spFlags = v.column<&Body::flags>(off, size);
+
+            for (usize p : {usize(spX.data()), usize(spY.data()), usize(spVX.data()), usize(spVY.data()), usize(spFlags.data())})
+                ADT_ASSERT_ALWAYS(p % 64 == 0, "off: {}, p: {}", off, p);
+            for (isize i = 0; i < size; ++i)
+            {
+                spX[i] += spVX[i] * DT;
+                spY[i] += spVY[i] * DT;
+            }
+            atomNVisited.fetchAdd(size, atomic::ORDER::RELAXED);
+        });
+
+        ADT_ASSERT_ALWAYS(atomNVisited.load(atomic::ORDER::RELAXED) == N, "{}", atomNVisited.load(atomic::ORDER::RELAXED));
+        for (isize i = 0; i < N; ++i)
+            ADT_ASSERT_ALWAYS(v[i].x == f32(i) + DT && v[i].y == -f32(i) + 2.0f * DT, "i: {}", i);
+
+        /* Less than one batch: everything on the calling thread. */
+        isize nCalls = 0;
+        VecBodies vSmall {Gpa::inst()};
+        defer( vSmall.destroy(Gpa::inst()) );
+        for (int i = 0; i < 10; ++i) vSmall.push(Gpa::inst(), {});
+        parallelForSOA(&tp, vSmall, [&](isize off, isize size) { ++nCalls; ADT_ASSERT_ALWAYS(off == 0 && size == 10, ""); });
+        ADT_ASSERT_ALWAYS(nCalls == 1, "{}", nCalls);
+    }
+
+    /* Bind iterator against column kernels. */
+    {
+        constexpr int NITERS = 20;
+
+        auto t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+            for (auto b : v) b.x += b.vx * DT;
+        const f64 msBind = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+        {
+            auto spX = v.column<&Body::x>();
+            const auto spVX = v.column<&Body::vx>();
+            for (isize i = 0; i < N; ++i) spX[i] += spVX[i] * DT;
+        }
+        const f64 msColumn = time::diffMSec(time::now(), t0);
+
+        t0 = time::now();
+        for (int j = 0; j < NITERS; ++j)
+        {
+            parallelForSOA(&tp, v, [&](isize off, isize size) {
+                auto spX = v.column<&Body::x>(off, size);
+                const auto spVX = v.column<&Body::vx>(off, size);
+                for (isize i = 0; i < size; ++i) spX[i] += spVX[i] * DT;
+            });
+        }
+        const f64 msParallel = time::diffMSec(time::now(), t0);
+
+        LogInfo{"{} bodies x{}: Bind iterator: {:.3} ms, column: {:.3} ms, parallelForSOA ({} threads): {:.3} ms\n",
+            N, NITERS, msBind, msColumn, tp.nThreads(), msParallel
+        };
+    }
+
+    /* PoolSOA columns with forEachOccupied(). */
+    {
+        static PoolSOA<Body, Body::Bind, 256, &Body::x, &Body::y, &Body::vx, &Body::vy, &Body::flags> s_pool {};
+
+        PoolSOAHandle<Body> aHandles[200] {};
+        for (int i = 0; i < 200; ++i) aHandles[i] = s_pool.insert({.x = f32(i), .vx = 1.0f});
+        for (int i = 0; i < 200; i += 2) s_pool.remove(aHandles[i]);
+
+        auto spX = s_pool.column<&Body::x>();
+        const auto spVX = s_pool.column<&Body::vx>();
+        ADT_ASSERT_ALWAYS(spX.size() == 200, "{}", spX.size());
+
+        s_pool.forEachOccupied([&](isize firstI, isize count) {
+            for (isize i = firstI; i < firstI + count; ++i) spX[i] += spVX[i];
+        });
+
+        for (int i = 1; i < 200; i += 2)
+            ADT_ASSERT_ALWAYS(s_pool[aHandles[i]].x == f32(i) + 1.0f, "i: {}", i);
+    }
+
+    LogInfo("ParallelForSOA test passed\n");
+}
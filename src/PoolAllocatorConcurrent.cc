@@ -0,0 +1,142 @@
+#include "adt/PoolAllocatorConcurrent.hh"
+#include "adt/PoolAllocator.hh"
+#include "adt/List.hh"
+#include "adt/Arena.hh"
+#include "adt/ThreadPool.hh"
+#include "adt/Logger.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr int NTASKS = 64;
+static constexpr int NNODES = 1 << 12;
+static constexpr int NROUNDS = 8;
+
+/* What we had to do before: PoolAllocator behind a Mutex. */
+struct PoolAllocatorLocked final : IAllocator
+{
+    PoolAllocator m_pool {};
+    Mutex m_mtx {};
+
+    /* */
+
+    PoolAllocatorLocked(usize chunkSize, usize blockSize) : m_pool {chunkSize, blockSize}, m_mtx {Mutex::TYPE::PLAIN} {}
+
+    /* */
+
+    virtual void* malloc(usize nBytes) override final { LockScope lock {&m_mtx}; return m_pool.malloc(nBytes); }
+    virtual void* zalloc(usize nBytes) override final { LockScope lock {&m_mtx}; return m_pool.zalloc(nBytes); }
+    virtual void* realloc(void*, usize, usize) override final { ADT_ASSERT_ALWAYS(false, ""); return nullptr; }
+    virtual void free(void* p, usize nBytes) noexcept override final { LockScope lock {&m_mtx}; m_pool.free(p, nBytes); }
+    virtual bool doesFree() const noexcept override final { return true; }
+    virtual bool doesRealloc() const noexcept override final { return false; }
+
+    void destroy() noexcept { m_pool.freeAll(); m_mtx.destroy(); }
+};
+
+static f64
+benchLists(ThreadPool* pTp, IAllocator* pAlloc)
+{
+    auto t0 = time::now();
+    for (int t = 0; t < NTASKS; ++t)
+    {
+        pTp->addRetry([pAlloc, t] {
+            for (int r = 0; r < NROUNDS; ++r)
+            {
+                List<int> list {};
+                for (int i = 0; i < NNODES; ++i) list.pushBack(pAlloc, t + i);
+                list.destroy(pAlloc);
+            }
+        });
+    }
+    pTp->wait(true);
+
+    return time::diffMSec(time::now(), t0);
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("PoolAllocatorConcurrent test...\n");
+
+    ThreadPool tp {Arena{}, SIZE_1K, SIZE_1M};
+    defer( tp.destroy() );
+
+    PoolAllocatorConcurrent pool {sizeof(List<int>::Node), SIZE_1K * 64};
+    defer( pool.freeAll() );
+
+    /* Every task stamps its chunks, nobody else may hand out the same chunk while they're alive. */
+    {
+        atomic::Int atomNBad {};
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                for (int r = 0; r < NROUNDS; ++r)
+                {
+                    List<int> list {};
+                    for (int i = 0; i < NNODES; ++i) list.pushBack(&pool, t * NNODES + i);
+
+                    int i = 0;
+                    for (const int x : list)
+                        if (x != t * NNODES + i++) atomNBad.fetchAdd(1, atomic::ORDER::RELAXED);
+
+                    list.destroy(&pool);
+                }
+            });
+        }
+        tp.wait(true);
+
+        ADT_ASSERT_ALWAYS(atomNBad.load(atomic::ORDER::RELAXED) == 0, "{}", atomNBad.load(atomic::ORDER::RELAXED));
+    }
+
+    /* Allocated on one thread, freed on another. */
+    {
+        constexpr int N = NTASKS * NNODES;
+        Vec<int*> vPtrs {Gpa::inst(), N};
+        defer( vPtrs.destroy(Gpa::inst()) );
+        vPtrs.setSize(Gpa::inst(), N);
+
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                for (int i = t; i < N; i += NTASKS)
+                {
+                    vPtrs[i] = static_cast<int*>(pool.malloc(sizeof(int)));
+                    *vPtrs[i] = i;
+                }
+            });
+        }
+        tp.wait(true);
+
+        for (int t = 0; t < NTASKS; ++t)
+        {
+            tp.addRetry([&, t] {
+                /* Different stride: frees mostly chunks of other threads. */
+                for (int i = (t * 7) % NTASKS; i < N; i += NTASKS)
+                {
+                    ADT_ASSERT_ALWAYS(*vPtrs[i] == i, "i: {}, got: {}", i, *vPtrs[i]);
+                    pool.free(vPtrs[i], sizeof(int));
+                }
+            });
+        }
+        tp.wait(true);
+    }
+
+    {
+        PoolAllocatorLocked locked {sizeof(List<int>::Node), SIZE_1K * 64};
+        defer( locked.destroy() );
+
+        const f64 concurrentMS = benchLists(&tp, &pool);
+        const f64 lockedMS = benchLists(&tp, &locked);
+
+        LogInfo{"{} list nodes on {} threads: PoolAllocatorConcurrent: {:.3} ms, PoolAllocator + Mutex: {:.3} ms\n",
+            NTASKS * NROUNDS * NNODES, tp.nThreads(), concurrentMS, lockedMS
+        };
+    }
+
+    LogInfo("PoolAllocatorConcurrent test passed\n");
+}
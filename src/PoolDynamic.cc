@@ -0,0 +1,134 @@
+#include "adt/PoolDynamic.hh"
+#include "adt/Logger.hh"
+#include "adt/Arena.hh"
+#include "adt/rng.hh"
+
+using namespace adt;
+
+static int s_nAlive = 0;
+
+struct Counted
+{
+    int v {};
+
+    Counted(int _v) : v {_v} { ++s_nAlive; }
+    Counted(const Counted& r) : v {r.v} { ++s_nAlive; }
+    ~Counted() { --s_nAlive; }
+};
+
+struct alignas(32) Aligned32
+{
+    f32 a[8] {};
+};
+
+/* Takes the default IAllocator::mallocAligned() path: over-aligned chunks must come back through freeV(). */
+struct MallocAllocator final : IAllocator
+{
+    [[nodiscard]] virtual void* malloc(usize nBytes) noexcept(false) override final { return ::malloc(nBytes); }
+    [[nodiscard]] virtual void* zalloc(usize nBytes) noexcept(false) override final { return ::calloc(1, nBytes); }
+    [[nodiscard]] virtual void* realloc(void* p, usize, usize newNBytes) noexcept(false) override final { return ::realloc(p, newNBytes); }
+    virtual void free(void* p, usize) noexcept override final { ::free(p); }
+    [[nodiscard]] virtual bool doesFree() const noexcept override final { return true; }
+    [[nodiscard]] virtual bool doesRealloc() const noexcept override final { return true; }
+};
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("PoolDynamic test...\n");
+
+    /* Stale handles, reuse and stable addresses. */
+    {
+        PoolDynamic<int, 64> pool {Gpa::inst()};
+        defer( pool.destroy(Gpa::inst()) );
+
+        auto h0 = pool.insert(Gpa::inst(), 0);
+        int* p0 = &pool[h0];
+        auto h1 = pool.insert(Gpa::inst(), 1);
+
+        Vec<PoolDynamic<int, 64>::Handle> vHandles {Gpa::inst()};
+        defer( vHandles.destroy(Gpa::inst()) );
+        for (int i = 2; i < 1000; ++i) vHandles.push(Gpa::inst(), pool.insert(Gpa::inst(), i));
+
+        ADT_ASSERT_ALWAYS(pool.size() == 1000 && pool.cap() == 1024, "size: {}, cap: {}", pool.size(), pool.cap());
+        ADT_ASSERT_ALWAYS(&pool[h0] == p0 && *p0 == 0, "");
+
+        pool.remove(h1);
+        ADT_ASSERT_ALWAYS(!pool.isValid(h1) && !pool.tryGet(h1), "");
+
+        auto h2 = pool.insert(Gpa::inst(), 2);
+        ADT_ASSERT_ALWAYS(h2.i == h1.i && h2.gen != h1.gen, "same slot, new generation");
+        ADT_ASSERT_ALWAYS(!pool.isValid(h1) && pool.isValid(h2) && pool[h2] == 2, "");
+
+        pool.remove(&pool[h0]);
+        ADT_ASSERT_ALWAYS(!pool.isValid(h0), "");
+        ADT_ASSERT_ALWAYS(!pool.isValid({}), "");
+    }
+
+    /* Iteration through the bitmap sees exactly the occupied slots. */
+    {
+        Arena arena {SIZE_1G};
+        defer( arena.freeAll() );
+
+        PoolDynamic<Counted> pool {&arena};
+        Vec<PoolDynamic<Counted>::Handle> vHandles {&arena};
+
+        rng::PCG32 rng {5};
+        for (int i = 0; i < 100000; ++i)
+        {
+            if (vHandles.empty() || rng.nextInRange(0, 100) < 60)
+            {
+                vHandles.push(&arena, pool.emplace(&arena, i));
+            }
+            else
+            {
+                const isize j = rng.nextInRange(0, u32(vHandles.size() - 1));
+                pool.remove(vHandles[j]);
+                vHandles.swapWithLast(j);
+                vHandles.pop();
+            }
+        }
+
+        ADT_ASSERT_ALWAYS(pool.size() == vHandles.size() && s_nAlive == pool.size(), "{}, {}, {}", pool.size(), vHandles.size(), s_nAlive);
+
+        i64 sumIt = 0, sumHandles = 0;
+        isize nIt = 0;
+        for (const Counted& c : pool)
+        {
+            sumIt += c.v;
+            ++nIt;
+        }
+        for (auto h : vHandles) sumHandles += pool[h].v;
+
+        ADT_ASSERT_ALWAYS(nIt == pool.size() && sumIt == sumHandles, "{}, {}, {}, {}", nIt, pool.size(), sumIt, sumHandles);
+
+        for (isize i = pool.firstI(); i != -1; i = pool.nextI(i))
+            ADT_ASSERT_ALWAYS(pool.isValid(pool.handle(i)), "i: {}", i);
+
+        LogInfo("{} live of {} slots\n", pool.size(), pool.cap());
+
+        pool.destroy(&arena);
+        ADT_ASSERT_ALWAYS(s_nAlive == 0, "{}", s_nAlive);
+    }
+
+    /* Over-aligned T. */
+    {
+        MallocAllocator alloc {};
+        PoolDynamic<Aligned32, 64> pool {&alloc};
+        defer( pool.destroy(&alloc) );
+
+        for (int i = 0; i < 200; ++i)
+        {
+            auto h = pool.insert(&alloc, {});
+            ADT_ASSERT_ALWAYS(usize(&pool[h]) % alignof(Aligned32) == 0, "i: {}", i);
+            pool[h].a[0] = f32(i);
+        }
+        ADT_ASSERT_ALWAYS(pool.size() == 200, "{}", pool.size());
+    }
+
+    LogInfo("PoolDynamic test passed\n");
+}
@@ -3,7 +3,7 @@
 #include "adt/ThreadPool.hh"
 #include "adt/Logger.hh"
 
-#include "WIP/QueueMPMC.hh"
+#include "adt/QueueMPMC.hh"
 
 using namespace adt;
 
@@ -57,5 +57,48 @@ main()
 
     ADT_ASSERT_ALWAYS(s_atomCounter.load(atomic::ORDER::RELAXED) == BIG, "{}", s_atomCounter.load(atomic::ORDER::RELAXED));
 
+    {
+        constexpr isize BATCH = 8;
+        s_atomCounter.store(0, atomic::ORDER::RELAXED);
+
+        auto clEnqueueBatch = [&]
+        {
+            const int aOnes[BATCH] {1, 1, 1, 1, 1, 1, 1, 1};
+            Span<const int> sp {aOnes};
+            while (!sp.empty())
+            {
+                const isize n = s_q.pushBatch(sp);
+                sp = {sp.data() + n, sp.size() - n};
+            }
+        };
+
+        auto clDequeueBatch = [&]
+        {
+            int aOut[BATCH] {};
+            isize nLeft = BATCH;
+            while (nLeft > 0)
+            {
+                const isize n = s_q.popBatch({aOut, nLeft});
+                for (isize i = 0; i < n; ++i) s_atomCounter.fetchAdd(aOut[i], atomic::ORDER::RELAXED);
+                nLeft -= n;
+            }
+        };
+
+        for (isize i = 0; i < BIG / BATCH; ++i)
+            tp.addRetry(clEnqueueBatch);
+
+        tp.wait(true);
+
+        ADT_ASSERT_ALWAYS(s_q.size() == BIG, "{}", s_q.size());
+
+        for (isize i = 0; i < BIG / BATCH; ++i)
+            tp.addRetry(clDequeueBatch);
+
+        tp.wait(true);
+
+        ADT_ASSERT_ALWAYS(s_q.empty(), "{}", s_q.size());
+        ADT_ASSERT_ALWAYS(s_atomCounter.load(atomic::ORDER::RELAXED) == BIG, "{}", s_atomCounter.load(atomic::ORDER::RELAXED));
+    }
+
     LogInfo("QueueMPMC test passed.\n");
 }
@@ -0,0 +1,221 @@
+#include "adt/SlabAllocator.hh"
+#include "adt/List.hh"
+#include "adt/Logger.hh"
+#include "adt/RBTree.hh"
+#include "adt/String.hh"
+#include "adt/rng.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr int NOPS = 1 << 20;
+
+struct Alloc
+{
+    u8* p {};
+    u32 size {};
+    u32 seed {};
+};
+
+static void
+fill(Alloc* pA)
+{
+    for (u32 i = 0; i < pA->size; ++i) pA->p[i] = u8(pA->seed + i);
+}
+
+static bool
+check(const Alloc& a)
+{
+    for (u32 i = 0; i < a.size; ++i)
+        if (a.p[i] != u8(a.seed + i)) return false;
+
+    return true;
+}
+
+/* Random malloc/realloc/free mix over all classes and the large path, every live block keeps its bytes. */
+static void
+randomMix()
+{
+    SlabAllocator slab {Gpa::inst()};
+    defer( slab.freeAll() );
+
+    rng::PCG32 rng {1234};
+    Vec<Alloc> vLive {Gpa::inst(), SIZE_1K * 4};
+    defer( vLive.destroy(Gpa::inst()) );
+
+    auto clRandomSize = [&] {
+        const u32 r = rng.nextInRange(0, 100);
+        if (r < 80) return rng.nextInRange(1, 256);
+        if (r < 98) return rng.nextInRange(257, SlabAllocator::MAX_SIZE);
+        return rng.nextInRange(SlabAllocator::MAX_SIZE + 1, SIZE_1K * 16);
+    };
+
+    for (int i = 0; i < NOPS / 4; ++i)
+    {
+        const u32 op = rng.nextInRange(0, 100);
+        if (op < 50 || vLive.size() < 64)
+        {
+            Alloc a {.size = clRandomSize(), .seed = u32(i)};
+            a.p = static_cast<u8*>(slab.malloc(a.size));
+            ADT_ASSERT_ALWAYS(usize(a.p) % ALLOC_ALIGNMENT == 0, "{}", (void*)a.p);
+            fill(&a);
+            vLive.push(Gpa::inst(), a);
+        }
+        else if (op < 70)
+        {
+            Alloc& a = vLive[rng.nextInRange(0, u32(vLive.size() - 1))];
+            ADT_ASSERT_ALWAYS(check(a), "size: {}", a.size);
+            const u32 newSize = clRandomSize();
+            a.p = static_cast<u8*>(slab.realloc(a.p, a.size, newSize));
+            a.size = newSize;
+            a.seed = u32(i);
+            fill(&a);
+        }
+        else
+        {
+            const isize idx = rng.nextInRange(0, u32(vLive.size() - 1));
+            Alloc a = vLive[idx];
+            ADT_ASSERT_ALWAYS(check(a), "size: {}", a.size);
+            /* Size doesn't matter for the lookup, pass garbage for small blocks like Vec::destroy() would. */
+            slab.free(a.p, a.size <= SlabAllocator::MAX_SIZE ? 1 : a.size);
+            vLive[idx] = vLive.last();
+            vLive.pop();
+        }
+    }
+
+    for (const Alloc& a : vLive) ADT_ASSERT_ALWAYS(check(a), "size: {}", a.size);
+
+    isize nUsed = 0, nSlabs = 0;
+    for (isize i = 0; i < SlabAllocator::N_CLASSES; ++i)
+    {
+        const SlabClassStats& s = slab.classStats(i);
+        ADT_ASSERT_ALWAYS(s.nUsed <= s.nMaxUsed && s.nMaxUsed <= s.nCapacity, "class: {}", i);
+        nUsed += s.nUsed;
+        nSlabs += s.nSlabs;
+    }
+    ADT_ASSERT_ALWAYS(nUsed + slab.nLarge() == vLive.size(), "{} + {} != {}", nUsed, slab.nLarge(), vLive.size());
+
+    LogInfo("random mix: {} live ({} large), {} slabs\n", vLive.size(), slab.nLarge(), nSlabs);
+
+    for (const Alloc& a : vLive) slab.free(a.p, a.size);
+    ADT_ASSERT_ALWAYS(slab.nLarge() == 0, "{}", slab.nLarge());
+
+    /* Usable after freeAll(), small and large. */
+    slab.freeAll();
+    for (usize size : {usize(8), usize(300), SlabAllocator::MAX_SIZE + 1})
+    {
+        void* p = slab.malloc(size);
+        ADT_ASSERT_ALWAYS(p != nullptr, "size: {}", size);
+        ::memset(p, 0xff, size);
+        slab.free(p, size);
+    }
+    ADT_ASSERT_ALWAYS(slab.classStats(0).chunkSize == 8 && slab.classStats(0).nUsed == 0 && slab.nLarge() == 0, "");
+}
+
+static void
+aligned()
+{
+    SlabAllocator slab {Gpa::inst()};
+    defer( slab.freeAll() );
+
+    for (usize alignment : {16, 32, 64, 128, 512, 4096})
+    {
+        for (usize size : {1, 24, 100, 700, 5000})
+        {
+            u8* p = static_cast<u8*>(slab.mallocAligned(size, alignment));
+            ADT_ASSERT_ALWAYS(usize(p) % alignment == 0, "size: {}, alignment: {}, p: {}", size, alignment, (void*)p);
+            memset(p, 0xff, size);
+
+            p = static_cast<u8*>(slab.reallocAligned(p, size, size * 3, alignment));
+            ADT_ASSERT_ALWAYS(usize(p) % alignment == 0, "size: {}, alignment: {}, p: {}", size * 3, alignment, (void*)p);
+            ADT_ASSERT_ALWAYS(p[size - 1] == 0xff, "");
+
+            slab.freeAligned(p, size * 3, alignment);
+        }
+    }
+
+    ADT_ASSERT_ALWAYS(slab.nLarge() == 0, "{}", slab.nLarge());
+}
+
+/* Node based containers and small strings: the churn the allocator is meant for. */
+static f64
+containerChurn(IAllocator* pAlloc)
+{
+    const auto t0 = time::now();
+
+    List<u64> list {};
+    RBTree<u64> tree {};
+    Map<u64, u64> map {pAlloc};
+    Vec<VString> vStrings {pAlloc};
+
+    rng::PCG32 rng {42};
+    for (int i = 0; i < NOPS; ++i)
+    {
+        const u64 key = rng.nextInRange(0, NOPS / 4);
+        list.pushBack(pAlloc, key);
+        tree.insert(pAlloc, true, u64(key));
+        map.insert(pAlloc, key, u64(i));
+
+        if ((i & 7) == 0)
+        {
+            VString s {};
+            for (int j = 0; j < int(key & 15); ++j) s.push(pAlloc, "abcd");
+            vStrings.push(pAlloc, s);
+        }
+
+        if ((i & 1) && list.m_pFirst)
+        {
+            list.remove(pAlloc, &list.m_pFirst->data);
+            tree.removeAndFree(pAlloc, tree.root());
+        }
+    }
+
+    const f64 ms = time::diffMSec(time::now(), t0);
+
+    for (VString& s : vStrings) s.destroy(pAlloc);
+    vStrings.destroy(pAlloc);
+    map.destroy(pAlloc);
+    tree.destroy(pAlloc);
+    list.destroy(pAlloc);
+
+    return ms;
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("SlabAllocator test...\n");
+
+    static_assert(SlabAllocator::classChunkSize(SlabAllocator::classI(1)) == 8);
+    static_assert(SlabAllocator::classChunkSize(SlabAllocator::classI(256)) == 256);
+    static_assert(SlabAllocator::classChunkSize(SlabAllocator::classI(257)) == 512);
+    static_assert(SlabAllocator::classChunkSize(SlabAllocator::classI(SlabAllocator::MAX_SIZE)) == SlabAllocator::MAX_SIZE);
+    static_assert(SlabAllocator::classI(SlabAllocator::MAX_SIZE) == SlabAllocator::N_CLASSES - 1);
+
+    randomMix();
+    aligned();
+
+    {
+        SlabAllocator slab {Gpa::inst()};
+        defer( slab.freeAll() );
+
+        const f64 gpaMS = containerChurn(Gpa::inst());
+        const f64 slabMS = containerChurn(&slab);
+
+        LogInfo{"container churn ({} ops): Gpa: {:.3} ms, SlabAllocator: {:.3} ms\n", NOPS, gpaMS, slabMS};
+
+        for (isize i = 0; i < SlabAllocator::N_CLASSES; ++i)
+        {
+            const SlabClassStats& s = slab.classStats(i);
+            if (s.nSlabs == 0) continue;
+            ADT_ASSERT_ALWAYS(s.nUsed == 0, "leak in class: {}, nUsed: {}", i, s.nUsed);
+            LogDebug{"class {} ({} bytes): peak {}, capacity {}, slabs {}\n", i, s.chunkSize, s.nMaxUsed, s.nCapacity, s.nSlabs};
+        }
+    }
+
+    LogInfo("SlabAllocator test passed\n");
+}
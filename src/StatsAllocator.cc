@@ -0,0 +1,170 @@
+#include "adt/StatsAllocator.hh"
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/Map.hh"
+#include "adt/ThreadPool.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static constexpr int NTASKS = 32;
+static constexpr int NALLOCS = 1 << 14;
+
+static void
+fillMap(IAllocator* pAlloc, int n)
+{
+    StatsAllocator::SiteScope site {};
+
+    Map<int, int> map {pAlloc};
+    for (int i = 0; i < n; ++i) map.insert(pAlloc, i, i);
+    map.destroy(pAlloc);
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("StatsAllocator test...\n");
+
+    ThreadPool tp {Arena{}, SIZE_1K, SIZE_1M};
+    defer( tp.destroy() );
+
+    /* Counters, peak and histogram. */
+    {
+        StatsAllocator stats {Gpa::inst()};
+        defer( stats.destroy() );
+
+        void* p0 = stats.malloc(8);
+        void* p1 = stats.zalloc(100);
+        p1 = stats.realloc(p1, 100, 1000);
+        void* p2 = stats.mallocAligned(64, 64);
+
+        auto s = stats.snapshot();
+        ADT_ASSERT_ALWAYS(s.nMallocs == 3 && s.nReallocs == 1 && s.nFrees == 0, "{}, {}, {}", s.nMallocs, s.nReallocs, s.nFrees);
+        ADT_ASSERT_ALWAYS(s.bytesLive == 8 + 1000 + 64, "{}", s.bytesLive);
+        ADT_ASSERT_ALWAYS(s.bytesPeak == s.bytesLive, "{}", s.bytesPeak);
+        ADT_ASSERT_ALWAYS(s.aHistogram[3] == 1 && s.aHistogram[6] == 1 && s.aHistogram[7] == 1 && s.aHistogram[10] == 1, "");
+
+        stats.free(p0, 8);
+        stats.free(p1, 1000);
+        stats.freeAligned(p2, 64, 64);
+
+        s = stats.snapshot();
+        ADT_ASSERT_ALWAYS(s.nFrees == 3 && s.bytesLive == 0, "{}, {}", s.nFrees, s.bytesLive);
+        ADT_ASSERT_ALWAYS(s.bytesPeak == 8 + 1000 + 64, "{}", s.bytesPeak);
+        ADT_ASSERT_ALWAYS(s.bytesTotal == 8 + 1000 + 64, "{}", s.bytesTotal);
+
+        stats.reset();
+        ADT_ASSERT_ALWAYS(stats.snapshot().nMallocs == 0, "");
+    }
+
+    /* Containers free their whole capacity: nothing left live after destroy(). */
+    {
+        StatsAllocator stats {Gpa::inst()};
+        defer( stats.destroy() );
+
+        Vec<int> v {&stats, 100};
+        v.push(&stats, 1);
+        v.destroy(&stats);
+
+        Vec<int> v2 {&stats};
+        for (int i = 0; i < 37; ++i) v2.push(&stats, i);
+        v2.destroy(&stats);
+
+        const auto s = stats.snapshot();
+        ADT_ASSERT_ALWAYS(s.bytesLive == 0 && s.nFrees == s.nMallocs, "live: {}, frees: {}, mallocs: {}", s.bytesLive, s.nFrees, s.nMallocs);
+    }
+
+    /* Per site attribution. */
+    {
+        StatsAllocator stats {Gpa::inst(), true};
+        defer( stats.destroy() );
+
+        fillMap(&stats, 1000);
+        fillMap(&stats, 1000);
+        {
+            StatsAllocator::SiteScope site {};
+            void* p = stats.malloc(123);
+            stats.free(p, 123);
+        }
+        void* pUnattributed = stats.malloc(16);
+        stats.free(pUnattributed, 16);
+
+        isize nSites = 0, nSiteMallocs = 0;
+        for (isize i = 0; i < StatsAllocator::MAX_SITES; ++i)
+        {
+            if (stats.m_aSites[i].atomKey.load(atomic::ORDER::RELAXED) == 0) continue;
+
+            auto s = stats.siteSnapshot(i);
+            ADT_ASSERT_ALWAYS(s.bytesLive == 0, "site: {}, live: {}", i, s.bytesLive);
+            ++nSites;
+            nSiteMallocs += s.nMallocs;
+        }
+        ADT_ASSERT_ALWAYS(nSites == 2, "{}", nSites);
+        ADT_ASSERT_ALWAYS(nSiteMallocs + 1 == stats.snapshot().nMallocs, "{}, {}", nSiteMallocs, stats.snapshot().nMallocs);
+
+        /* Same line, different columns: separate sites. */
+        void* p0 {}; void* p1 {};
+        { StatsAllocator::SiteScope s0 {}; p0 = stats.malloc(10); } { StatsAllocator::SiteScope s1 {}; p1 = stats.malloc(20); }
+
+        isize nNewSites = 0;
+        for (isize i = 0; i < StatsAllocator::MAX_SITES; ++i)
+        {
+            if (stats.m_aSites[i].atomKey.load(atomic::ORDER::RELAXED) == 0) continue;
+
+            auto s = stats.siteSnapshot(i);
+            if (s.bytesLive == 0) continue;
+            ADT_ASSERT_ALWAYS(s.nMallocs == 1 && (s.bytesLive == 10 || s.bytesLive == 20), "{}, {}", s.nMallocs, s.bytesLive);
+            ++nNewSites;
+        }
+        ADT_ASSERT_ALWAYS(nNewSites == 2, "{}", nNewSites);
+        stats.free(p0, 10);
+        stats.free(p1, 20);
+
+        print::Builder pb {Gpa::inst()};
+        defer( pb.destroy() );
+        stats.dump(&pb);
+        fwrite(pb.m_pData, pb.m_size, 1, stdout);
+    }
+
+    /* Counters from many threads add up, overhead against the raw allocator. */
+    {
+        StatsAllocator stats {Gpa::inst()};
+        defer( stats.destroy() );
+
+        auto clRun = [&](IAllocator* pAlloc) {
+            const auto t0 = time::now();
+            for (int t = 0; t < NTASKS; ++t)
+            {
+                tp.addRetry([pAlloc, t] {
+                    void* aPtrs[64];
+                    for (int i = 0; i < NALLOCS; ++i)
+                    {
+                        const usize size = 8 + ((i + t) & 255);
+                        if (i >= 64) pAlloc->free(aPtrs[i & 63], 8 + ((i - 64 + t) & 255));
+                        aPtrs[i & 63] = pAlloc->malloc(size);
+                    }
+                    for (int i = NALLOCS - 64; i < NALLOCS; ++i) pAlloc->free(aPtrs[i & 63], 8 + ((i + t) & 255));
+                });
+            }
+            tp.wait(true);
+            return time::diffMSec(time::now(), t0);
+        };
+
+        const f64 rawMS = clRun(Gpa::inst());
+        const f64 statsMS = clRun(&stats);
+
+        auto s = stats.snapshot();
+        ADT_ASSERT_ALWAYS(s.nMallocs == NTASKS * NALLOCS && s.nFrees == NTASKS * NALLOCS, "{}, {}", s.nMallocs, s.nFrees);
+        ADT_ASSERT_ALWAYS(s.bytesLive == 0, "{}", s.bytesLive);
+
+        LogInfo{"{} mallocs on {} threads: Gpa: {:.3} ms, StatsAllocator(Gpa): {:.3} ms\n",
+            NTASKS * NALLOCS, tp.nThreads(), rawMS, statsMS
+        };
+    }
+
+    LogInfo("StatsAllocator test passed\n");
+}
@@ -0,0 +1,119 @@
+#include "adt/ThreadPoolWS.hh"
+#include "adt/Arena.hh"
+#include "adt/Logger.hh"
+#include "adt/rng.hh"
+#include "adt/sort.hh"
+#include "adt/time.hh"
+
+using namespace adt;
+
+static atomic::Int s_atomCounter {};
+
+template<typename THREAD_POOL_T>
+static void
+spawnTree(THREAD_POOL_T* pTp, int depth)
+{
+    s_atomCounter.fetchAdd(1, atomic::ORDER::RELAXED);
+    if (depth <= 0) return;
+
+    IThreadPool::Future<void> futL {pTp};
+    IThreadPool::Future<void> futR {pTp};
+    ADT_DEFER( futL.destroy(); futR.destroy() );
+
+    pTp->addRetry(&futL, [=] { spawnTree(pTp, depth - 1); });
+    pTp->addRetry(&futR, [=] { spawnTree(pTp, depth - 1); });
+
+    futL.wait();
+    futR.wait();
+}
+
+/* Tiny tasks spawned from inside of a worker, that's where the single queue mutex hurts. */
+template<typename THREAD_POOL_T>
+static f64
+fanOut(THREAD_POOL_T* pTp, int nTasks)
+{
+    s_atomCounter.store(0, atomic::ORDER::RELAXED);
+
+    const auto t0 = time::now();
+
+    pTp->addRetry([=] {
+        for (int i = 0; i < nTasks; ++i)
+            pTp->addRetry([] { s_atomCounter.fetchAdd(1, atomic::ORDER::RELAXED); });
+    });
+    pTp->wait(true);
+
+    const f64 elapsed = time::diffMSec(time::now(), t0);
+
+    ADT_ASSERT_ALWAYS(s_atomCounter.load(atomic::ORDER::RELAXED) == nTasks,
+        "expected: {}, got: {}", nTasks, s_atomCounter.load(atomic::ORDER::RELAXED)
+    );
+
+    return elapsed;
+}
+
+int
+main()
+{
+    Logger logger {2, ILogger::LEVEL::DEBUG, SIZE_1K*4};
+    ILogger::setGlobal(&logger);
+    defer( logger.destroy() );
+
+    LogInfo("ThreadPoolWS test...\n");
+
+    constexpr int NTASKS = 1 << 17;
+
+    ThreadPoolWS tp {Arena{}, NTASKS, SIZE_1G};
+    defer( tp.destroy() );
+
+    {
+        s_atomCounter.store(0, atomic::ORDER::RELAXED);
+        spawnTree(&tp, 12);
+        tp.wait(true);
+        ADT_ASSERT_ALWAYS(s_atomCounter.load(atomic::ORDER::RELAXED) == (1 << 13) - 1,
+            "got: {}", s_atomCounter.load(atomic::ORDER::RELAXED)
+        );
+    }
+
+    {
+        VecM<f32> v {SIZE_1K};
+        defer( v.destroy() );
+        for (isize i = 0; i < SIZE_1K; ++i) v.push(i);
+
+        Arena arena {SIZE_1M};
+        defer( arena.freeAll() );
+
+        auto vFutures = parallelFor(&arena, &tp, Span<f32> {v}, [](Span<f32> spBatch, isize) {
+            for (auto& e : spBatch) e *= 2.0f;
+        });
+        for (auto* pF : vFutures) pF->wait(), pF->destroy();
+
+        for (isize i = 0; i < v.size(); ++i)
+            ADT_ASSERT_ALWAYS(v[i] == f32(i) * 2.0f, "v[{}]: {}", i, v[i]);
+    }
+
+    {
+        constexpr isize BIG = 1000000;
+        rng::PCG32 rng {666};
+
+        VecM<i64> v {BIG};
+        defer( v.destroy() );
+        for (isize i = 0; i < BIG; ++i) v.push(rng.next());
+
+        sort::quickParallel(&tp, &v);
+        ADT_ASSERT_ALWAYS(sort::sorted(v), "");
+    }
+
+    const f64 wsMS = fanOut(&tp, NTASKS);
+
+    f64 plainMS {};
+    {
+        ThreadPool tpPlain {Arena{}, NTASKS, SIZE_1G};
+        defer( tpPlain.destroy() );
+
+        plainMS = fanOut(&tpPlain, NTASKS);
+    }
+
+    LogInfo{"{} tiny tasks: ThreadPoolWS: {:.3} ms, ThreadPool: {:.3} ms\n", NTASKS, wsMS, plainMS};
+
+    LogInfo("ThreadPoolWS test passed\n");
+}
@@ -1,10 +1,13 @@
 #include "adt/Arena.hh"
 #include "adt/ArenaList.hh"
+#include "adt/BufferAllocator.hh"
 #include "adt/defer.hh"
 #include "adt/Gpa.hh"
 #include "adt/Logger.hh"
 #include "adt/time.hh"
 #include "adt/ThreadPool.hh"
+#include "adt/PoolAllocator.hh"
+#include "adt/Vec.hh"
 
 #include <vector>
 #include <limits>
@@ -30,6 +33,108 @@ reallocZero()
     LogError("what: {}\n", what);
 }
 
+struct alignas(32) F32x8
+{
+    f32 a[8];
+};
+
+struct alignas(CACHELINE_SIZE) CacheLineCounter
+{
+    i64 n;
+};
+
+/* Interleave small unaligned allocations with overaligned ones and grow vectors of overaligned types. */
+static void
+alignedAllocs(IAllocator* pAlloc, const char* ntsName)
+{
+    Vec<F32x8> v8 {};
+    Vec<CacheLineCounter> v64 {};
+    Vec<int> vInts {};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        vInts.push(pAlloc, i); /* Moves the bump pointer off the alignment between pushes. */
+        v8.push(pAlloc, {{f32(i)}});
+        v64.push(pAlloc, {i});
+
+        ADT_ASSERT_ALWAYS(usize(v8.data()) % alignof(F32x8) == 0, "{}: {}", ntsName, (void*)v8.data());
+        ADT_ASSERT_ALWAYS(usize(v64.data()) % alignof(CacheLineCounter) == 0, "{}: {}", ntsName, (void*)v64.data());
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ADT_ASSERT_ALWAYS(v8[i].a[0] == f32(i) && v64[i].n == i && vInts[i] == i, "{}: i: {}", ntsName, i);
+    }
+
+    for (usize alignment : {16, 128, 4096})
+    {
+        void* p = pAlloc->zallocAligned(100, alignment);
+        ADT_ASSERT_ALWAYS(usize(p) % alignment == 0, "{}: alignment: {}, p: {}", ntsName, alignment, p);
+        ADT_ASSERT_ALWAYS(((u8*)p)[99] == 0, "");
+        pAlloc->freeAligned(p, 100, alignment);
+    }
+
+    v8.destroy(pAlloc);
+    v64.destroy(pAlloc);
+    vInts.destroy(pAlloc);
+
+    LogInfo("{}: aligned allocations ok\n", ntsName);
+}
+
+static void
+alignedAllocs()
+{
+    alignedAllocs(Gpa::inst(), "Gpa");
+
+    {
+        Arena arena {SIZE_1M * 64};
+        defer( arena.freeAll() );
+        alignedAllocs(&arena, "Arena");
+    }
+
+    {
+        ArenaList arena {SIZE_1K};
+        defer( arena.freeAll() );
+        alignedAllocs(&arena, "ArenaList");
+    }
+
+    {
+        static u8 s_aMem[SIZE_1M * 2];
+        BufferAllocator buff {s_aMem};
+        alignedAllocs(&buff, "BufferAllocator");
+    }
+
+    {
+        /* No native path, takes the IAllocator default. */
+        struct GpaWrapper final : IAllocator
+        {
+            virtual void* malloc(usize n) override final { return Gpa::inst()->malloc(n); }
+            virtual void* zalloc(usize n) override final { return Gpa::inst()->zalloc(n); }
+            virtual void* realloc(void* p, usize o, usize n) override final { return Gpa::inst()->realloc(p, o, n); }
+            virtual void free(void* p, usize n) noexcept override final { Gpa::inst()->free(p, n); }
+            virtual bool doesFree() const noexcept override final { return true; }
+            virtual bool doesRealloc() const noexcept override final { return true; }
+        } wrapper {};
+        alignedAllocs(&wrapper, "IAllocator default");
+    }
+
+    {
+        PoolAllocator pool {sizeof(i64), SIZE_1K};
+        defer( pool.freeAll() );
+
+        bool bThrew = false;
+        try { [[maybe_unused]] auto* p = pool.mallocV<CacheLineCounter>(1); pool.free(p, 1); }
+        catch (const AllocException&) { bThrew = true; }
+
+        for (int i = 0; i < 8 && !bThrew; ++i)
+        {
+            try { [[maybe_unused]] auto* p = pool.mallocV<CacheLineCounter>(1); }
+            catch (const AllocException&) { bThrew = true; }
+        }
+        ADT_ASSERT_ALWAYS(bThrew, "PoolAllocator must refuse chunks without requested alignment");
+    }
+}
+
 template<typename T>
 struct ArenaSTD
 {
@@ -83,6 +188,8 @@ main()
         print::err("{}\n", ex.what());
     }
 
+    alignedAllocs();
+
     ArenaList arena(SIZE_1K);
     /*FreeList arena(SIZE_1K);*/
     defer( arena.freeAll() );
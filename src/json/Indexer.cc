@@ -0,0 +1,208 @@
+#include "Indexer.hh"
+
+#include "adt/Logger.hh"
+
+#ifdef ADT_SSE4_2
+    #include <nmmintrin.h>
+#endif
+
+#if defined ADT_AVX2
+    #include <immintrin.h>
+#endif
+
+#include <bit>
+
+using namespace adt;
+
+namespace json
+{
+
+namespace
+{
+
+/* One bit per byte of a 64 byte block. */
+struct BlockMasks
+{
+    u64 quote {};
+    u64 backslash {};
+    u64 whitespace {};
+    u64 structural {};
+};
+
+#if defined ADT_AVX2
+
+ADT_ALWAYS_INLINE u64
+eq32(__m256i v, char c) noexcept
+{
+    return u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+}
+
+inline BlockMasks
+classify(const char* p) noexcept
+{
+    BlockMasks m {};
+
+    for (int i = 0; i < 2; ++i)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i*32));
+        const int sh = i * 32;
+
+        m.quote |= eq32(v, '"') << sh;
+        m.backslash |= eq32(v, '\\') << sh;
+        m.whitespace |= (eq32(v, ' ') | eq32(v, '\n') | eq32(v, '\r') | eq32(v, '\t') | eq32(v, '\v') | eq32(v, '\f')) << sh;
+        m.structural |= (eq32(v, '{') | eq32(v, '}') | eq32(v, '[') | eq32(v, ']') | eq32(v, ':') | eq32(v, ',')) << sh;
+    }
+
+    return m;
+}
+
+#elif defined ADT_SSE4_2
+
+ADT_ALWAYS_INLINE u64
+eq16(__m128i v, char c) noexcept
+{
+    return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+}
+
+inline BlockMasks
+classify(const char* p) noexcept
+{
+    BlockMasks m {};
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i*16));
+        const int sh = i * 16;
+
+        m.quote |= eq16(v, '"') << sh;
+        m.backslash |= eq16(v, '\\') << sh;
+        m.whitespace |= (eq16(v, ' ') | eq16(v, '\n') | eq16(v, '\r') | eq16(v, '\t') | eq16(v, '\v') | eq16(v, '\f')) << sh;
+        m.structural |= (eq16(v, '{') | eq16(v, '}') | eq16(v, '[') | eq16(v, ']') | eq16(v, ':') | eq16(v, ',')) << sh;
+    }
+
+    return m;
+}
+
+#else
+
+inline BlockMasks
+classify(const char* p) noexcept
+{
+    BlockMasks m {};
+
+    for (int i = 0; i < 64; ++i)
+    {
+        const u64 bit = 1llu << i;
+        switch (p[i])
+        {
+            default: break;
+
+            case '"': m.quote |= bit; break;
+            case '\\': m.backslash |= bit; break;
+
+            case ' ': case '\n': case '\r': case '\t': case '\v': case '\f':
+            m.whitespace |= bit;
+            break;
+
+            case '{': case '}': case '[': case ']': case ':': case ',':
+            m.structural |= bit;
+            break;
+        }
+    }
+
+    return m;
+}
+
+#endif
+
+/* Bits of characters preceded by an odd run of backslashes.
+ * pPrevEscaped carries a run that reached the end of the previous block. */
+inline u64
+escapedMask(u64 backslash, u64* pPrevEscaped) noexcept
+{
+    constexpr u64 EVEN_BITS = 0x5555555555555555llu;
+
+    backslash &= ~*pPrevEscaped;
+    const u64 followsEscape = (backslash << 1) | *pPrevEscaped;
+    const u64 oddStarts = backslash & ~EVEN_BITS & ~followsEscape;
+
+    const u64 evenStartSeqs = oddStarts + backslash;
+    *pPrevEscaped = evenStartSeqs < oddStarts; /* Carry out of the block. */
+
+    return (EVEN_BITS ^ (evenStartSeqs << 1)) & followsEscape;
+}
+
+/* Bit i is the xor of bits [0, i]: turns quote bits into inside of string bits. */
+inline u64
+prefixXor(u64 x) noexcept
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+} /* namespace */
+
+Vec<u32>
+buildIndex(IAllocator* pAlloc, StringView svJson)
+{
+    ADT_ASSERT(svJson.size() < NPOS32, "size: {}", svJson.size());
+
+    /* Roughly a token per 8-16 bytes in typical documents, grows on denser input. */
+    Vec<u32> vIdx {pAlloc, utils::max(isize(64), svJson.size() / 16)};
+
+    u64 prevEscaped = 0;
+    u64 prevInString = 0; /* All ones if the previous block ended inside of a string. */
+    u64 prevScalar = 0;
+
+    for (isize off = 0; off < svJson.size(); off += 64)
+    {
+        const isize nLeft = svJson.size() - off;
+
+        BlockMasks m;
+        if (nLeft >= 64)
+        {
+            m = classify(svJson.data() + off);
+        }
+        else
+        {
+            /* Pad the tail with whitespace. */
+            char aTail[64];
+            ::memset(aTail, ' ', sizeof(aTail));
+            ::memcpy(aTail, svJson.data() + off, nLeft);
+            m = classify(aTail);
+        }
+
+        const u64 quote = m.quote & ~escapedMask(m.backslash, &prevEscaped);
+        const u64 inString = prefixXor(quote) ^ prevInString;
+        prevInString = u64(i64(inString) >> 63);
+
+        /* Closing quotes are outside of inString, opening ones are inside. */
+        const u64 structural = m.structural & ~inString;
+        const u64 scalar = ~(structural | m.whitespace | quote | inString);
+        const u64 scalarStart = scalar & ~((scalar << 1) | prevScalar);
+        prevScalar = scalar >> 63;
+
+        u64 bits = structural | quote | scalarStart;
+        if (nLeft < 64) bits &= (1llu << nLeft) - 1;
+
+        if (vIdx.size() + 64 > vIdx.cap())
+            vIdx.setCap(pAlloc, vIdx.cap() * 2);
+
+        u32* pOut = vIdx.data() + vIdx.size();
+        while (bits)
+        {
+            *pOut++ = u32(off + std::countr_zero(bits));
+            bits &= bits - 1;
+        }
+        vIdx.m_size = pOut - vIdx.data();
+    }
+
+    return vIdx;
+}
+
+} /* namespace json */
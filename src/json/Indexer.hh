@@ -0,0 +1,14 @@
+#pragma once
+
+#include "adt/Vec.hh"
+
+namespace json
+{
+
+/* Stage 1 of the parse: positions of every token start, found 64 bytes at a time.
+ * Indexed are structural characters ({}[]:,), both quotes of every string and the first byte of every bare scalar (numbers, true, false, null).
+ * Escaped quotes are dropped by tracking odd backslash runs, string interiors are masked with a prefix xor of the quote bits.
+ * Blocks are classified with AVX2 (ADT_AVX2), SSE (ADT_SSE4_2) or a scalar loop. */
+[[nodiscard]] adt::Vec<adt::u32> buildIndex(adt::IAllocator* pAlloc, adt::StringView svJson);
+
+} /* namespace json */
@@ -1,5 +1,7 @@
 #include "Lexer.hh"
 
+#include "adt/Logger.hh"
+
 #include <cctype>
 
 using namespace adt;
@@ -10,6 +12,8 @@ namespace json
 Token
 Lexer::next()
 {
+    if (m_spIndex.data()) return nextIndexed();
+
     skipWhitespace();
     if (m_pos >= m_svJson.size()) return {};
 
@@ -64,6 +68,84 @@ Lexer::next()
     return tok;
 }
 
+Token
+Lexer::nextIndexed()
+{
+    if (m_indexI >= m_spIndex.size())
+    {
+        m_pos = m_svJson.size();
+        return {};
+    }
+
+    m_pos = m_spIndex[m_indexI++];
+    char* p = m_svJson.data() + m_pos;
+
+    /* Tokens are returned in place, assigning through a temporary stalls on store forwarding. */
+    auto clStructural = [&](TOKEN_TYPE eType) -> Token {
+        ++m_pos;
+        return {.eType = eType, .svLiteral = {p, 1}};
+    };
+
+    switch (*p)
+    {
+        case '{': return clStructural(TOKEN_TYPE::L_BRACE);
+        case '}': return clStructural(TOKEN_TYPE::R_BRACE);
+        case '[': return clStructural(TOKEN_TYPE::L_BRACKET);
+        case ']': return clStructural(TOKEN_TYPE::R_BRACKET);
+        case ':': return clStructural(TOKEN_TYPE::COLON);
+        case ',': return clStructural(TOKEN_TYPE::COMMA);
+
+        case '"':
+        {
+            /* Closing quote is the next entry, unterminated strings run to the end. */
+            const u32 endPos = m_indexI < m_spIndex.size() ? m_spIndex[m_indexI++] : u32(m_svJson.size());
+            const u32 fPos = m_pos + 1;
+            m_pos = endPos + 1;
+            return {.eType = TOKEN_TYPE::QUOTED_STRING, .svLiteral = {m_svJson.data() + fPos, endPos - fPos}};
+        }
+
+        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9': case '-': case '+':
+        {
+            Token tok = nextNumber();
+            tok.row = tok.column = 0;
+            return tok;
+        }
+
+        default:
+        {
+            Token tok = nextStringNoQuotes();
+            tok.row = tok.column = 0;
+            return tok;
+        }
+    }
+}
+
+Token
+Lexer::locate(Token tok) const
+{
+    if (tok.row != 0 || !tok.svLiteral.data()) return tok;
+
+    const char* pEnd = tok.svLiteral.data();
+    if (tok.eType == TOKEN_TYPE::QUOTED_STRING) --pEnd;
+
+    tok.row = 1;
+    tok.column = 1;
+    for (const char* p = m_svJson.data(); p < pEnd; ++p)
+    {
+        if (*p == '\n')
+        {
+            ++tok.row;
+            tok.column = 1;
+        }
+        else
+        {
+            ++tok.column;
+        }
+    }
+
+    return tok;
+}
+
 void
 Lexer::skipWhitespace()
 {
@@ -2,6 +2,7 @@
 
 #include "adt/print.hh"
 #include "adt/enum.hh"
+#include "adt/Span.hh"
 
 namespace json
 {
@@ -37,6 +38,8 @@ class Lexer
     adt::u32 m_pos {};
     adt::u32 m_row = 1;
     adt::u32 m_column = 1;
+    adt::Span<const adt::u32> m_spIndex {}; /* From buildIndex(), empty for the character by character mode. */
+    adt::u32 m_indexI {};
 
     /* */
 
@@ -44,14 +47,21 @@ public:
     Lexer() = default;
     Lexer(adt::StringView sJson) : m_svJson(sJson), m_row(1), m_column(1) {}
 
+    /* Jumps between indexed positions instead of skipping whitespace and string bodies.
+     * Row and column are not tracked here, tokens get them from locate(). */
+    Lexer(adt::StringView sJson, adt::Span<const adt::u32> spIndex) : m_svJson(sJson), m_spIndex(spIndex) {}
+
     /* */
 
     Token next();
     bool done() const { return m_pos >= m_svJson.size(); }
 
+    Token locate(Token tok) const; /* Fills in row and column if the token came from the indexed mode. */
+
     /* */
 
 private:
+    Token nextIndexed();
     void skipWhitespace();
     Token nextChar(TOKEN_TYPE eType);
     Token nextString();
@@ -0,0 +1,131 @@
+#include "ObjectIndex.hh"
+
+#include "adt/Logger.hh"
+
+using namespace adt;
+
+namespace json
+{
+
+ObjectIndex::ObjectIndex(IAllocator* pAlloc, isize minSize)
+    : m_pAlloc(pAlloc), m_minSize(minSize), m_mObjects(pAlloc)
+{
+}
+
+Node*
+ObjectIndex::search(Vec<Node>& aObj, StringView svKey)
+{
+    Entry* pEntry = entry(aObj);
+    if (!pEntry) return searchNode(aObj, svKey);
+
+    for (;;)
+    {
+        auto res = pEntry->mKeys.search(svKey);
+        if (res.eStatus == MAP_RESULT_STATUS::NOT_FOUND) return nullptr;
+
+        Node& node = aObj[res.value()];
+        if (node.svKey == svKey) return &node;
+
+        /* Another object at a reused address. */
+        pEntry = rebuild(pEntry, aObj);
+    }
+}
+
+isize
+ObjectIndex::searchNodes(Vec<Node>& aObj, Span<const StringView> spKeys, Span<Node*> spResults)
+{
+    ADT_ASSERT(spResults.size() >= spKeys.size(), "spResults: {}, spKeys: {}", spResults.size(), spKeys.size());
+
+    Entry* pEntry = entry(aObj);
+    if (!pEntry) return json::searchNodes(aObj, spKeys, spResults);
+
+    /* Map::searchBatch() overlaps the bucket misses of consecutive keys. */
+    MapResult<StringView, u32> aRes[64];
+    isize nFound = 0;
+
+    for (isize off = 0; off < spKeys.size(); )
+    {
+        const isize n = utils::min(utils::size(aRes), spKeys.size() - off);
+        const isize nChunkFound = pEntry->mKeys.searchBatch(Span<const StringView> {spKeys.data() + off, n}, Span {aRes, n});
+
+        bool bStale = false;
+        for (isize i = 0; i < n; ++i)
+        {
+            Node* pNode = aRes[i].eStatus == MAP_RESULT_STATUS::NOT_FOUND ? nullptr : &aObj[aRes[i].value()];
+            if (pNode && pNode->svKey != spKeys[off + i])
+            {
+                bStale = true;
+                break;
+            }
+            spResults[off + i] = pNode;
+        }
+
+        if (bStale)
+        {
+            pEntry = rebuild(pEntry, aObj); /* Redo this chunk. */
+            continue;
+        }
+
+        nFound += nChunkFound;
+        off += n;
+    }
+
+    return nFound;
+}
+
+void
+ObjectIndex::invalidate(const Vec<Node>& aObj)
+{
+    auto res = m_mObjects.search(usize(aObj.data()));
+    if (res.eStatus == MAP_RESULT_STATUS::NOT_FOUND) return;
+
+    res.value().mKeys.destroy(m_pAlloc);
+    m_mObjects.remove(usize(aObj.data()));
+}
+
+void
+ObjectIndex::destroy() noexcept
+{
+    for (auto& kv : m_mObjects) kv.val.mKeys.destroy(m_pAlloc);
+    m_mObjects.destroy(m_pAlloc);
+    *this = {};
+}
+
+ObjectIndex::Entry*
+ObjectIndex::entry(Vec<Node>& aObj)
+{
+    if (aObj.size() < m_minSize) return nullptr;
+
+    const usize key = usize(aObj.data());
+    auto res = m_mObjects.search(key);
+    if (res.eStatus != MAP_RESULT_STATUS::NOT_FOUND)
+    {
+        Entry& e = res.value();
+        if (e.size == aObj.size() && e.pFirstKey == aObj.first().svKey.data() && e.pLastKey == aObj.last().svKey.data())
+            return &e;
+
+        /* Pushed to since the last lookup, or a different object at a reused address. */
+        return rebuild(&e, aObj);
+    }
+
+    res = m_mObjects.insert(m_pAlloc, key, {});
+    return rebuild(&res.value(), aObj);
+}
+
+ObjectIndex::Entry*
+ObjectIndex::rebuild(Entry* pEntry, Vec<Node>& aObj)
+{
+    Entry& e = *pEntry;
+    e.mKeys.destroy(m_pAlloc);
+
+    e.mKeys = {m_pAlloc, aObj.size() * 2};
+    for (isize i = 0; i < aObj.size(); ++i)
+        e.mKeys.tryInsert(m_pAlloc, aObj[i].svKey, u32(i)); /* First of duplicate keys wins. */
+    e.size = aObj.size();
+    e.pFirstKey = aObj.first().svKey.data();
+    e.pLastKey = aObj.last().svKey.data();
+
+    return &e;
+}
+
+} /* namespace json */
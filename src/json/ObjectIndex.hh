@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Parser.hh"
+
+#include "adt/Map.hh"
+
+namespace json
+{
+
+constexpr adt::isize OBJECT_INDEX_MIN_SIZE = 32;
+
+/* Lazily built key -> position maps for large objects, searchNode() replacement for repeated lookups.
+ * An object gets its map on the first lookup if it has at least minSize entries, smaller ones are scanned.
+ * Maps are keyed by the object's storage, call invalidate() after pushing to or reallocating an object
+ * (a size change is caught and rebuilds on its own). Hits are checked against the node's key, a map left over from
+ * another object at the same address (arena reset) is rebuilt instead of returning its positions.
+ * Duplicate keys resolve to the first one, like searchNode(). */
+class ObjectIndex
+{
+    struct Entry
+    {
+        adt::Map<adt::StringView, adt::u32> mKeys {};
+        adt::isize size {};
+        const char* pFirstKey {}; /* Tells apart a different object of the same size at a reused address. */
+        const char* pLastKey {};
+    };
+
+    /* */
+
+    adt::IAllocator* m_pAlloc {};
+    adt::isize m_minSize = OBJECT_INDEX_MIN_SIZE;
+    adt::Map<adt::usize, Entry> m_mObjects {}; /* Object's m_pData -> its keys. */
+
+    /* */
+
+public:
+    ObjectIndex() = default;
+    ObjectIndex(adt::IAllocator* pAlloc, adt::isize minSize = OBJECT_INDEX_MIN_SIZE);
+
+    /* */
+
+    [[nodiscard]] Node* search(adt::Vec<Node>& aObj, adt::StringView svKey);
+    [[nodiscard]] const Node* search(const adt::Vec<Node>& aObj, adt::StringView svKey)
+    { return search(const_cast<adt::Vec<Node>&>(aObj), svKey); }
+
+    /* spResults[i] is the node with spKeys[i] or nullptr. Returns number of found keys. */
+    adt::isize searchNodes(adt::Vec<Node>& aObj, adt::Span<const adt::StringView> spKeys, adt::Span<Node*> spResults);
+
+    void invalidate(const adt::Vec<Node>& aObj);
+    void destroy() noexcept;
+
+    /* */
+
+private:
+    Entry* entry(adt::Vec<Node>& aObj); /* nullptr for objects below m_minSize. */
+    Entry* rebuild(Entry* pEntry, adt::Vec<Node>& aObj);
+};
+
+} /* namespace json */
@@ -0,0 +1,125 @@
+#include "ParallelParser.hh"
+
+#include "adt/IArena.hh"
+#include "adt/ThreadPool.hh"
+#include "adt/Logger.hh"
+#include "adt/atomic.hh"
+#include "adt/defer.hh"
+
+using namespace adt;
+
+namespace json
+{
+
+namespace
+{
+
+struct Batch
+{
+    StringView sv {};
+    isize off {};
+    Parser parser {};
+    bool bOk {};
+};
+
+}
+
+static void
+parseBatch(IThreadPool* pTp, IAllocator* pAlloc, Batch* pBatch)
+{
+    /* Only blank lines after the last split. */
+    isize i = 0;
+    while (i < pBatch->sv.size() && (pBatch->sv[i] == ' ' || pBatch->sv[i] == '\n' || pBatch->sv[i] == '\r' || pBatch->sv[i] == '\t'))
+        ++i;
+    if (i == pBatch->sv.size())
+    {
+        pBatch->bOk = true;
+        return;
+    }
+
+    /* Threads that didn't start() the pool have no arena. */
+    IAllocator* pBatchAlloc = pTp->arena();
+    if (!pBatchAlloc) pBatchAlloc = pAlloc;
+
+    pBatch->bOk = pBatch->parser.parse(pBatchAlloc, pBatch->sv);
+    if (!pBatch->bOk)
+        LogError("json::ParallelParser: failed to parse the batch at offset {} (positions are relative to it)\n", pBatch->off);
+}
+
+bool
+ParallelParser::parse(IAllocator* pAlloc, IThreadPool* pTp, StringView svJson, isize minBatchSize)
+{
+    m_pAlloc = pAlloc;
+
+    /* A few batches per thread evens out uneven records. */
+    const isize nWorkers = pTp->nThreads() + 1;
+    const isize batchSize = utils::max(svJson.size() / (nWorkers * 4), minBatchSize);
+
+    Vec<Batch> vBatches {pAlloc, svJson.size() / batchSize + 1};
+    ADT_DEFER( vBatches.destroy(pAlloc) );
+
+    for (isize off = 0; off < svJson.size(); )
+    {
+        isize end = utils::min(off + batchSize, svJson.size());
+        while (end < svJson.size() && svJson[end - 1] != '\n') ++end;
+
+        vBatches.push(pAlloc, {.sv = {svJson.data() + off, end - off}, .off = off});
+        off = end;
+    }
+
+    if (vBatches.empty()) return true;
+
+    atomic::Int atomNLeft {i32(vBatches.size() - 1)};
+    IThreadPool::Future<void> fut {pTp};
+    if (vBatches.size() == 1) fut.signal();
+
+    for (isize i = 1; i < vBatches.size(); ++i)
+    {
+        Batch* pBatch = &vBatches[i];
+        pTp->addRetry([pTp, pAlloc, pBatch, &atomNLeft, &fut] {
+            parseBatch(pTp, pAlloc, pBatch);
+            if (atomNLeft.fetchSub(1, atomic::ORDER::ACQ_REL) == 1) fut.signal();
+        });
+    }
+
+    parseBatch(pTp, pAlloc, &vBatches[0]);
+    fut.wait();
+
+    isize nRoots = 0;
+    for (const Batch& b : vBatches)
+    {
+        if (!b.bOk) return false;
+        nRoots += b.parser.getRoots().size();
+    }
+
+    m_vRoots.setCap(pAlloc, m_vRoots.size() + nRoots);
+    for (Batch& b : vBatches)
+        for (const Node& node : b.parser.getRoots()) m_vRoots.push(pAlloc, node);
+
+    return true;
+}
+
+bool
+ParallelParser::parseFile(IAllocator* pAlloc, IThreadPool* pTp, const char* ntsPath, isize minBatchSize)
+{
+    ADT_ASSERT(m_mapped.data() == nullptr, "already has a mapped file");
+
+    m_mapped = file::map(ntsPath);
+    if (m_mapped.data() == nullptr)
+    {
+        LogError("json::ParallelParser: failed to map '{}'\n", ntsPath);
+        return false;
+    }
+
+    return parse(pAlloc, pTp, m_mapped, minBatchSize);
+}
+
+void
+ParallelParser::destroy() noexcept
+{
+    m_vRoots.destroy(m_pAlloc);
+    if (m_mapped.data()) m_mapped.unmap();
+    *this = {};
+}
+
+} /* namespace json */
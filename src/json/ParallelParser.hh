@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Parser.hh"
+
+#include "adt/IThreadPool.hh"
+#include "adt/file.hh"
+
+namespace json
+{
+
+constexpr adt::isize PARALLEL_PARSER_MIN_BATCH_SIZE = adt::SIZE_1K * 256;
+
+/* Newline delimited json split into batches at line ends and parsed on the thread pool, one Parser per batch.
+ * Each batch allocates from the arena() of the thread that runs it (the calling thread takes batches too),
+ * so nodes stay valid until those arenas are reset, strings point into the input.
+ * A calling thread without a pool arena (any thread other than the one that called start()) allocates its batches from pAlloc,
+ * pass an arena as pAlloc when calling from such threads, nodes are never freed one by one.
+ * Records are root objects, roots() has them in input order. */
+class ParallelParser
+{
+    adt::IAllocator* m_pAlloc {};
+    adt::file::Mapped m_mapped {}; /* parseFile() keeps the file mapped for the string views. */
+    adt::Vec<Node> m_vRoots {};
+
+    /* */
+
+public:
+    ParallelParser() = default;
+
+    /* */
+
+    bool parse(adt::IAllocator* pAlloc, adt::IThreadPool* pTp, adt::StringView svJson, adt::isize minBatchSize = PARALLEL_PARSER_MIN_BATCH_SIZE);
+    bool parseFile(adt::IAllocator* pAlloc, adt::IThreadPool* pTp, const char* ntsPath, adt::isize minBatchSize = PARALLEL_PARSER_MIN_BATCH_SIZE);
+
+    adt::Vec<Node>& roots() { return m_vRoots; }
+    const adt::Vec<Node>& roots() const { return m_vRoots; }
+
+    void destroy() noexcept; /* Frees roots() and unmaps, nodes are in the thread arenas. */
+};
+
+} /* namespace json */
@@ -1,5 +1,7 @@
 #include "Parser.hh"
+#include "Indexer.hh"
 
+#include "adt/Gpa.hh"
 #include "adt/defer.hh"
 #include "adt/Logger.hh"
 
@@ -14,7 +16,12 @@ bool
 Parser::parse(IAllocator* pAlloc, StringView svJson)
 {
     m_pAlloc = pAlloc;
-    m_lex = Lexer(svJson);
+
+    /* Only needed while parsing, tokens point into svJson.
+     * Scratch from Gpa: arenas don't take frees, the index would stay in pAlloc under the nodes. */
+    Vec<u32> vIndex = buildIndex(Gpa::inst(), svJson);
+    ADT_DEFER( vIndex.destroy(Gpa::inst()) );
+    m_lex = Lexer(svJson, {vIndex.data(), vIndex.size()});
 
     m_token = m_lex.next();
 
@@ -38,7 +45,7 @@ Parser::parse(IAllocator* pAlloc, StringView svJson)
 bool
 Parser::printNodeError()
 {
-    const auto& tok = m_token;
+    const Token tok = m_lex.locate(m_token);
     LogError("json::Parser: ({}, {}): unexpected token: '{}'\n",
         tok.row, tok.column, m_token.eType
     );
@@ -56,8 +63,9 @@ Parser::expect(TOKEN_TYPE t)
     }
     else
     {
+        const Token tokAt = m_lex.locate(tok);
         LogError("json::Parser: ({}, {}): unexpected token: expected: '{}', got '{}' ('{}')\n",
-             tok.row, tok.column, t, m_token.eType, m_token.svLiteral
+             tokAt.row, tokAt.column, t, m_token.eType, m_token.svLiteral
         );
         return false;
     }
@@ -70,8 +78,9 @@ Parser::expectNot(TOKEN_TYPE t)
 
     if (bool(tok.eType & t))
     {
+        const Token tokAt = m_lex.locate(tok);
         LogError("json::Parser: ({}, {}): unexpected token: not expected: '{}', got '{}' ('{}')\n",
-             tok.row, tok.column, t, m_token.eType, m_token.svLiteral
+             tokAt.row, tokAt.column, t, m_token.eType, m_token.svLiteral
         );
         return false;
     }
@@ -130,6 +130,10 @@ public:
     adt::Vec<Node>& getRoot();
     const adt::Vec<Node>& getRoot() const;
 
+    /* every root object, even if there is only one */
+    adt::Vec<Node>& getRoots() { return m_aObjects; }
+    const adt::Vec<Node>& getRoots() const { return m_aObjects; }
+
     /* pfn returns true for early return */
     void traverse(bool (*pfn)(Node* p, void* pFnArgs), void* pArgs, TRAVERSAL_ORDER eOrder);
 
@@ -172,6 +176,31 @@ searchNode(const adt::Vec<Node>& aObj, adt::StringView sKey)
     return nullptr;
 }
 
+/* Resolves every key in one pass over the object: spResults[i] is the node with spKeys[i] or nullptr.
+ * Returns number of found keys. See ObjectIndex for large objects. */
+inline adt::isize
+searchNodes(adt::Vec<Node>& aObj, adt::Span<const adt::StringView> spKeys, adt::Span<Node*> spResults)
+{
+    ADT_ASSERT(spResults.size() >= spKeys.size(), "spResults: {}, spKeys: {}", spResults.size(), spKeys.size());
+
+    for (adt::isize i = 0; i < spKeys.size(); ++i) spResults[i] = nullptr;
+
+    adt::isize nFound = 0;
+    for (Node& node : aObj)
+    {
+        for (adt::isize i = 0; i < spKeys.size(); ++i)
+        {
+            if (!spResults[i] && node.svKey == spKeys[i])
+            {
+                spResults[i] = &node;
+                if (++nFound == spKeys.size()) return nFound;
+            }
+        }
+    }
+
+    return nFound;
+}
+
 [[nodiscard]] inline adt::Vec<Node>&
 getObject(Node* obj)
 {
@@ -0,0 +1,329 @@
+#include "Reader.hh"
+
+#include "adt/Logger.hh"
+
+#if __has_include(<unistd.h>)
+    #include <unistd.h>
+#elif defined _WIN32
+    #include <io.h>
+#endif
+
+using namespace adt;
+
+namespace json
+{
+
+isize
+readFromFd(void* pArg, char* pBuff, isize buffSize)
+{
+    const int fd = int(isize(pArg));
+
+#if __has_include(<unistd.h>)
+    return ::read(fd, pBuff, buffSize);
+#elif defined _WIN32
+    return _read(fd, pBuff, unsigned(utils::min(buffSize, isize(INT32_MAX))));
+#endif
+}
+
+isize
+readFromView(void* pArg, char* pBuff, isize buffSize)
+{
+    auto* pSv = static_cast<StringView*>(pArg);
+    const isize n = utils::min(buffSize, pSv->size());
+    ::memcpy(pBuff, pSv->data(), n);
+    *pSv = {pSv->data() + n, pSv->size() - n};
+    return n;
+}
+
+static bool
+isDelimiter(char c)
+{
+    switch (c)
+    {
+        case ' ': case '\n': case '\r': case '\t':
+        case ',': case ':': case '{': case '}': case '[': case ']': case '"':
+        return true;
+
+        default: return false;
+    }
+}
+
+Reader::Reader(IAllocator* pAlloc, ReadFn pfnRead, void* pReadArg, isize chunkSize)
+    : m_pAlloc(pAlloc), m_pfnRead(pfnRead), m_pReadArg(pReadArg), m_chunkSize(chunkSize),
+      m_vBuff(pAlloc, chunkSize*2 + 1), m_vStack(pAlloc)
+{
+    m_vBuff.data()[0] = '\0';
+}
+
+Event
+Reader::next()
+{
+    if (m_eState == STATE::FAILED) return {.eType = EVENT::ERROR};
+
+    for (;;)
+    {
+        char c;
+        if (!peek(&c))
+        {
+            if (m_vStack.empty() && (m_eState == STATE::VALUE || m_eState == STATE::AFTER_VALUE))
+                return {.eType = EVENT::END};
+
+            return error("unexpected end of input");
+        }
+
+        switch (m_eState)
+        {
+            case STATE::FAILED:
+            return {.eType = EVENT::ERROR};
+
+            case STATE::VALUE_OR_END:
+            if (c == ']') return close(EVENT::ARRAY_BEGIN, EVENT::ARRAY_END);
+            [[fallthrough]];
+
+            case STATE::VALUE:
+            return value(c);
+
+            case STATE::KEY_OR_END:
+            if (c == '}') return close(EVENT::OBJECT_BEGIN, EVENT::OBJECT_END);
+            [[fallthrough]];
+
+            case STATE::KEY:
+            if (c != '"') return error("expected a quoted key");
+            m_eState = STATE::COLON;
+            return string(EVENT::KEY);
+
+            case STATE::COLON:
+            if (c != ':') return error("expected ':'");
+            ++m_pos;
+            m_eState = STATE::VALUE;
+            break;
+
+            case STATE::AFTER_VALUE:
+            if (m_vStack.empty())
+            {
+                /* Next root value. */
+                m_eState = STATE::VALUE;
+            }
+            else if (c == ',')
+            {
+                ++m_pos;
+                m_eState = m_vStack.last() == EVENT::OBJECT_BEGIN ? STATE::KEY : STATE::VALUE;
+            }
+            else if (c == '}')
+            {
+                return close(EVENT::OBJECT_BEGIN, EVENT::OBJECT_END);
+            }
+            else if (c == ']')
+            {
+                return close(EVENT::ARRAY_BEGIN, EVENT::ARRAY_END);
+            }
+            else
+            {
+                return error("expected ',' or the end of a container");
+            }
+            break;
+        }
+    }
+}
+
+bool
+Reader::skip()
+{
+    const isize d = depth();
+    ADT_ASSERT(d > 0, "not inside of a container");
+
+    while (depth() >= d)
+    {
+        const EVENT e = next().eType;
+        if (e == EVENT::END || e == EVENT::ERROR) return false;
+    }
+
+    return true;
+}
+
+void
+Reader::destroy() noexcept
+{
+    m_vBuff.destroy(m_pAlloc);
+    m_vStack.destroy(m_pAlloc);
+    *this = {};
+}
+
+bool
+Reader::refill()
+{
+    if (m_bEof) return false;
+
+    /* Everything before the current token is done with. */
+    if (m_tokStart > 0)
+    {
+        ::memmove(m_vBuff.data(), m_vBuff.data() + m_tokStart, m_vBuff.size() - m_tokStart);
+        m_vBuff.m_size -= m_tokStart;
+        m_pos -= m_tokStart;
+        m_nConsumed += m_tokStart;
+        m_tokStart = 0;
+    }
+
+    /* Grows only when a token doesn't leave room for a chunk. */
+    if (m_vBuff.cap() - m_vBuff.size() - 1 < m_chunkSize)
+        m_vBuff.setCap(m_pAlloc, utils::max(m_vBuff.cap() * 2, m_vBuff.size() + m_chunkSize + 1));
+
+    const isize nRead = m_pfnRead(m_pReadArg, m_vBuff.data() + m_vBuff.size(), m_vBuff.cap() - m_vBuff.size() - 1);
+    if (nRead <= 0)
+    {
+        if (nRead < 0) LogError("json::Reader: read failed at offset {}\n", offset());
+        m_bEof = true;
+        return false;
+    }
+
+    m_vBuff.m_size += nRead;
+    m_vBuff.data()[m_vBuff.size()] = '\0';
+    return true;
+}
+
+bool
+Reader::peek(char* pC)
+{
+    for (;;)
+    {
+        const char* pBuff = m_vBuff.data();
+        const isize size = m_vBuff.size();
+
+        for (; m_pos < size; ++m_pos)
+        {
+            const char c = pBuff[m_pos];
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            {
+                *pC = c;
+                return true;
+            }
+        }
+
+        m_tokStart = m_pos;
+        if (!refill()) return false;
+    }
+}
+
+Event
+Reader::error(StringView svWhat)
+{
+    LogError("json::Reader: offset {}: {}\n", offset(), svWhat);
+    m_eState = STATE::FAILED;
+    return {.eType = EVENT::ERROR};
+}
+
+Event
+Reader::value(char c)
+{
+    switch (c)
+    {
+        case '{':
+        m_vStack.push(m_pAlloc, EVENT::OBJECT_BEGIN);
+        m_eState = STATE::KEY_OR_END;
+        return {.eType = EVENT::OBJECT_BEGIN, .sv = {m_vBuff.data() + m_pos++, 1}};
+
+        case '[':
+        m_vStack.push(m_pAlloc, EVENT::ARRAY_BEGIN);
+        m_eState = STATE::VALUE_OR_END;
+        return {.eType = EVENT::ARRAY_BEGIN, .sv = {m_vBuff.data() + m_pos++, 1}};
+
+        case '"':
+        m_eState = STATE::AFTER_VALUE;
+        return string(EVENT::STRING);
+
+        default:
+        m_eState = STATE::AFTER_VALUE;
+        return scalar();
+    }
+}
+
+Event
+Reader::string(EVENT eType)
+{
+    ADT_ASSERT(m_vBuff[m_pos] == '"', "");
+
+    m_tokStart = m_pos;
+    isize i = m_pos + 1;
+    bool bEsc = false; /* Survives refills, a chunk may end right after a backslash. */
+
+    for (;;)
+    {
+        const char* pBuff = m_vBuff.data();
+        const isize size = m_vBuff.size();
+
+        for (; i < size; ++i)
+        {
+            const char c = pBuff[i];
+            if (bEsc) bEsc = false;
+            else if (c == '\\') bEsc = true;
+            else if (c == '"') goto done;
+        }
+
+        const isize rel = i - m_tokStart;
+        const bool bMore = refill();
+        i = m_tokStart + rel;
+        if (!bMore) return error("unterminated string");
+    }
+
+done:
+    const isize start = m_tokStart + 1;
+    m_pos = i + 1;
+    return {.eType = eType, .sv = {m_vBuff.data() + start, i - start}};
+}
+
+Event
+Reader::scalar()
+{
+    m_tokStart = m_pos;
+    isize i = m_pos;
+
+    for (;;)
+    {
+        const char* pBuff = m_vBuff.data();
+        const isize size = m_vBuff.size();
+
+        while (i < size && !isDelimiter(pBuff[i])) ++i;
+        if (i < size) break;
+
+        /* Ends at the chunk boundary or continues in the next chunk. */
+        const isize rel = i - m_tokStart;
+        const bool bMore = refill();
+        i = m_tokStart + rel;
+        if (!bMore) break;
+    }
+
+    const StringView sv {m_vBuff.data() + m_tokStart, i - m_tokStart};
+    m_pos = i;
+
+    if (sv.empty()) return error("unexpected character");
+
+    const char c = sv[0];
+    if ((c >= '0' && c <= '9') || c == '-')
+    {
+        /* Followed by a delimiter or the 0 terminator, so strto* stop in time. */
+        for (char ch : sv)
+            if (ch == '.' || ch == 'e' || ch == 'E')
+                return {.eType = EVENT::DOUBLE, .sv = sv, .val {.d = sv.toF64()}};
+
+        return {.eType = EVENT::LONG, .sv = sv, .val {.l = sv.toI64()}};
+    }
+
+    if (sv == "true") return {.eType = EVENT::BOOL, .sv = sv, .val {.b = true}};
+    if (sv == "false") return {.eType = EVENT::BOOL, .sv = sv, .val {.b = false}};
+    if (sv == "null") return {.eType = EVENT::NULL_, .sv = sv};
+
+    return error("unknown literal");
+}
+
+Event
+Reader::close(EVENT eOpen, EVENT eClose)
+{
+    if (m_vStack.empty() || m_vStack.last() != eOpen)
+        return error("mismatched closing bracket");
+
+    m_vStack.pop();
+    m_eState = STATE::AFTER_VALUE;
+    return {.eType = eClose, .sv = {m_vBuff.data() + m_pos++, 1}};
+}
+
+} /* namespace json */
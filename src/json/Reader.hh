@@ -0,0 +1,107 @@
+#pragma once
+
+#include "adt/String.hh"
+#include "adt/Vec.hh"
+
+namespace json
+{
+
+enum class EVENT : adt::u8
+{
+    END, /* No more input. */
+    ERROR,
+    OBJECT_BEGIN,
+    OBJECT_END,
+    ARRAY_BEGIN,
+    ARRAY_END,
+    KEY,
+    STRING,
+    LONG,
+    DOUBLE,
+    BOOL,
+    NULL_,
+};
+
+inline adt::StringView
+getEVENTString(EVENT e)
+{
+    constexpr adt::StringView EVENTStrings[] {
+        "END", "ERROR", "OBJECT_BEGIN", "OBJECT_END", "ARRAY_BEGIN", "ARRAY_END", "KEY", "STRING", "LONG", "DOUBLE", "BOOL", "NULL_"
+    };
+
+    return EVENTStrings[static_cast<int>(e)];
+}
+
+struct Event
+{
+    EVENT eType {};
+    adt::StringView sv {}; /* KEY and STRING without quotes (escapes are kept), raw literal otherwise. Valid until the next next() call. */
+    union
+    {
+        adt::i64 l;
+        adt::f64 d;
+        bool b;
+    } val {};
+};
+
+/* Called for more input: fill pBuff with up to buffSize bytes, return 0 at the end of input, negative on error. */
+using ReadFn = adt::isize (*)(void* pArg, char* pBuff, adt::isize buffSize);
+
+adt::isize readFromFd(void* pArg, char* pBuff, adt::isize buffSize); /* pArg: (void*)(adt::isize)fd. */
+adt::isize readFromView(void* pArg, char* pBuff, adt::isize buffSize); /* pArg: adt::StringView* (file::Mapped), consumed from the front. */
+
+/* Pull parser over input that arrives in chunks, emits events without building Nodes.
+ * Only the token being scanned is kept across reads: on a chunk boundary it is moved to the front of the buffer
+ * and scanning resumes where it stopped (with the escape state for strings), the buffer grows only for tokens longer than a chunk.
+ * Multiple root values are read one after another, so newline delimited json is a stream of depth 0 values. */
+class Reader
+{
+    enum class STATE : adt::u8 { VALUE, VALUE_OR_END, KEY, KEY_OR_END, COLON, AFTER_VALUE, FAILED };
+
+    /* */
+
+    adt::IAllocator* m_pAlloc {};
+    ReadFn m_pfnRead {};
+    void* m_pReadArg {};
+    adt::isize m_chunkSize {};
+
+    adt::Vec<char> m_vBuff {}; /* [m_pos, size()) is unread, 0 terminated. */
+    adt::isize m_pos {};
+    adt::isize m_tokStart {}; /* Kept by refill(). */
+    adt::isize m_nConsumed {}; /* Bytes dropped from the front of the buffer, for error offsets. */
+    bool m_bEof {};
+
+    adt::Vec<EVENT> m_vStack {}; /* OBJECT_BEGIN or ARRAY_BEGIN per open container. */
+    STATE m_eState = STATE::VALUE;
+
+    /* */
+
+public:
+    Reader() = default;
+    Reader(adt::IAllocator* pAlloc, ReadFn pfnRead, void* pReadArg, adt::isize chunkSize = adt::SIZE_1K * 64);
+
+    /* */
+
+    [[nodiscard]] Event next();
+
+    /* After OBJECT_BEGIN or ARRAY_BEGIN: reads past the matching end. False on END or ERROR. */
+    bool skip();
+
+    adt::isize depth() const { return m_vStack.size(); } /* Open containers. */
+    adt::isize offset() const { return m_nConsumed + m_pos; } /* Bytes read so far. */
+
+    void destroy() noexcept;
+
+    /* */
+
+private:
+    bool refill();
+    bool peek(char* pC); /* Skips whitespace, false at the end of input. */
+    Event error(adt::StringView svWhat);
+    Event value(char c);
+    Event string(EVENT eType);
+    Event scalar();
+    Event close(EVENT eOpen, EVENT eClose);
+};
+
+} /* namespace json */
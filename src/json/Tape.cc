@@ -0,0 +1,241 @@
+#include "Tape.hh"
+#include "Indexer.hh"
+
+#include "adt/Gpa.hh"
+#include "adt/defer.hh"
+#include "adt/Logger.hh"
+
+using namespace adt;
+
+namespace json
+{
+
+#define OK_OR_RET(RES) if (!RES) return false;
+
+bool
+Tape::parse(IAllocator* pAlloc, StringView svJson)
+{
+    /* Scratch, see Parser::parse(). */
+    Vec<u32> vIndex = buildIndex(Gpa::inst(), svJson);
+    ADT_DEFER( vIndex.destroy(Gpa::inst()) );
+
+    /* Every value is a root, the first child of a container or follows a comma, which bounds the tape size. */
+    u32 nOpen = 0, nCommas = 0;
+    for (u32 pos : vIndex)
+    {
+        const char c = svJson[pos];
+        if (c == '{' || c == '[') ++nOpen;
+        else if (c == ',') ++nCommas;
+    }
+
+    m_cap = nCommas + nOpen*2 + 1;
+    m_pEntries = pAlloc->mallocV<TapeEntry>(m_cap);
+    m_size = 0;
+
+    m_lex = Lexer(svJson, {vIndex.data(), vIndex.size()});
+    next();
+
+    if (!expect(TOKEN_TYPE::L_BRACE | TOKEN_TYPE::L_BRACKET))
+        return false;
+
+    /* Multiple root objects like in Parser::parse(). */
+    while (bool(m_token.eType & (TOKEN_TYPE::L_BRACE | TOKEN_TYPE::L_BRACKET)))
+    {
+        if (!parseValue({}))
+        {
+            LogWarn("parseValue() failed\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+Tape::destroy(IAllocator* pAlloc) noexcept
+{
+    pAlloc->free(m_pEntries, m_cap * sizeof(TapeEntry));
+    *this = {};
+}
+
+bool
+Tape::expect(TOKEN_TYPE t)
+{
+    if (bool(m_token.eType & t)) return true;
+
+    const Token tokAt = m_lex.locate(m_token);
+    LogError("json::Tape: ({}, {}): unexpected token: expected: '{}', got '{}' ('{}')\n",
+         tokAt.row, tokAt.column, t, m_token.eType, m_token.svLiteral
+    );
+    return false;
+}
+
+bool
+Tape::parseValue(StringView svKey)
+{
+    ADT_ASSERT(m_size < m_cap, "size: {}, cap: {}", m_size, m_cap);
+
+    const u32 i = m_size++;
+    TapeEntry& e = m_pEntries[i];
+    e.svKey = svKey;
+
+    switch (m_token.eType)
+    {
+        default:
+        return expect(TOKEN_TYPE::QUOTED_STRING | TOKEN_TYPE::STRING | TOKEN_TYPE::NUMBER |
+            TOKEN_TYPE::FLOAT | TOKEN_TYPE::L_BRACE | TOKEN_TYPE::L_BRACKET
+        );
+
+        case TOKEN_TYPE::QUOTED_STRING:
+        e.eTag = TAG::STRING;
+        e.val.s = m_token.svLiteral;
+        next();
+        break;
+
+        case TOKEN_TYPE::STRING:
+        {
+            const StringView sLit = m_token.svLiteral;
+            if (sLit == "null") e.eTag = TAG::NULL_, e.val.n = nullptr;
+            else if (sLit == "true") e.eTag = TAG::BOOL, e.val.b = true;
+            else if (sLit == "false") e.eTag = TAG::BOOL, e.val.b = false;
+            else e.eTag = TAG::STRING, e.val.s = sLit;
+            next();
+        }
+        break;
+
+        case TOKEN_TYPE::NUMBER:
+        e.eTag = TAG::LONG;
+        e.val.l = m_token.svLiteral.toI64();
+        next();
+        break;
+
+        case TOKEN_TYPE::FLOAT:
+        e.eTag = TAG::DOUBLE;
+        e.val.d = m_token.svLiteral.toF64();
+        next();
+        break;
+
+        case TOKEN_TYPE::L_BRACE:
+        e.eTag = TAG::OBJECT;
+        next(); /* skip brace */
+        OK_OR_RET(parseContainer(i, TOKEN_TYPE::R_BRACE));
+        break;
+
+        case TOKEN_TYPE::L_BRACKET:
+        e.eTag = TAG::ARRAY;
+        next(); /* skip bracket */
+        OK_OR_RET(parseContainer(i, TOKEN_TYPE::R_BRACKET));
+        break;
+    }
+
+    e.next = m_size;
+    return true;
+}
+
+bool
+Tape::parseContainer(u32 i, TOKEN_TYPE eClose)
+{
+    u32 nChildren = 0;
+
+    if (m_token.eType != eClose)
+    {
+        for (;;)
+        {
+            StringView svKey {};
+            if (eClose == TOKEN_TYPE::R_BRACE)
+            {
+                /* make sure key is quoted */
+                OK_OR_RET(expect(TOKEN_TYPE::QUOTED_STRING));
+                svKey = m_token.svLiteral;
+
+                /* skip identifier and ':' */
+                next();
+                OK_OR_RET(expect(TOKEN_TYPE::COLON));
+                next();
+            }
+
+            OK_OR_RET(parseValue(svKey));
+            ++nChildren;
+
+            if (m_token.eType != TOKEN_TYPE::COMMA) break;
+            next();
+        }
+
+        OK_OR_RET(expect(eClose));
+    }
+
+    next(); /* skip closing brace or bracket */
+    m_pEntries[i].val.nChildren = nChildren;
+
+    return true;
+}
+
+void
+Tape::print(IAllocator* pAlloc, FILE* fp) const
+{
+    for (u32 i = 0; i < m_size; i = nextSibling(i))
+    {
+        printEntry(pAlloc, fp, i, "", 0, false); /* skip key for root nodes */
+        fputc('\n', fp);
+    }
+}
+
+void
+Tape::printEntry(IAllocator* pAlloc, FILE* fp, u32 i, StringView svEnd, int depth, bool bPrintKey) const
+{
+    const TapeEntry& e = m_pEntries[i];
+
+    print::toFILE(pAlloc, fp, "{:{}}", depth, "");
+    ADT_DEFER( print::toFILE(pAlloc, fp, "{}", svEnd) );
+
+    if (bPrintKey) print::toFILE(pAlloc, fp, "\"{}\": ", e.svKey);
+
+    switch (e.eTag)
+    {
+        case TAG::OBJECT:
+        case TAG::ARRAY:
+        {
+            const bool bObj = e.eTag == TAG::OBJECT;
+
+            if (e.val.nChildren == 0)
+            {
+                print::toFILE<16>(fp, bObj ? "{}" : "[]");
+                break;
+            }
+
+            print::toFILE<16>(fp, bObj ? "{\n" : "[\n");
+
+            for (u32 childI = i + 1; childI < e.next; childI = nextSibling(childI))
+            {
+                const StringView svE = nextSibling(childI) == e.next ? "\n" : ",\n";
+                printEntry(pAlloc, fp, childI, svE, depth + 2, bObj);
+            }
+
+            if (bObj) print::toFILE(pAlloc, fp, "{:{}}}", depth, "");
+            else print::toFILE(pAlloc, fp, "{:{}}]", depth, "");
+        }
+        break;
+
+        case TAG::DOUBLE:
+        print::toFILE(pAlloc, fp, "{}", e.val.d);
+        break;
+
+        case TAG::LONG:
+        print::toFILE(pAlloc, fp, "{}", e.val.l);
+        break;
+
+        case TAG::NULL_:
+        print::toFILE<16>(fp, "null");
+        break;
+
+        case TAG::STRING:
+        print::toFILE(pAlloc, fp, "\"{}\"", e.val.s);
+        break;
+
+        case TAG::BOOL:
+        print::toFILE<16>(fp, "{}", e.val.b);
+        break;
+    }
+}
+
+} /* namespace json */
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Parser.hh"
+
+namespace json
+{
+
+/* Flat Node: children follow their container on the tape, in order. */
+struct TapeEntry
+{
+    adt::StringView svKey {};
+    union
+    {
+        adt::null n;
+        adt::StringView s;
+        adt::i64 l;
+        adt::f64 d;
+        bool b;
+        adt::u32 nChildren; /* ARRAY and OBJECT. */
+    } val {};
+    TAG eTag {};
+    adt::u32 next {}; /* Index just past this entry's subtree. */
+};
+
+/* Alternative Parser output: the whole document is one TapeEntry array in a single allocation.
+ * Subtrees are skipped in O(1) through TapeEntry::next, siblings are visited without pointer chasing.
+ * Strings point into the source, so with an arena everything goes away with one reset. */
+class Tape
+{
+    TapeEntry* m_pEntries {};
+    adt::u32 m_size {};
+    adt::u32 m_cap {};
+    Lexer m_lex {};
+    Token m_token {};
+
+    /* */
+
+public:
+    Tape() = default;
+
+    /* */
+
+    bool parse(adt::IAllocator* pAlloc, adt::StringView svJson);
+    void destroy(adt::IAllocator* pAlloc) noexcept;
+
+    void print(adt::IAllocator* pAlloc, FILE* fp) const; /* Same output as Parser::print(). */
+
+    TapeEntry& operator[](adt::u32 i)             { ADT_ASSERT(i < m_size, "i: {}, size: {}", i, m_size); return m_pEntries[i]; }
+    const TapeEntry& operator[](adt::u32 i) const { ADT_ASSERT(i < m_size, "i: {}, size: {}", i, m_size); return m_pEntries[i]; }
+
+    adt::u32 size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    adt::Span<TapeEntry> entries() { return {m_pEntries, m_size}; }
+
+    /* Roots are siblings starting at 0, children of i are siblings starting at i + 1. */
+    adt::u32 firstChild(adt::u32 i) const;
+    adt::u32 nextSibling(adt::u32 i) const { return m_pEntries[i].next; }
+    adt::u32 childrenEnd(adt::u32 i) const { return m_pEntries[i].next; }
+
+    /* cl(u32 childI) for every direct child of container i. */
+    template<typename CL>
+    void forEachChild(adt::u32 i, CL cl) const;
+
+    /* Linear search over the direct children of object i, skipping their subtrees. Returns NPOS32 if not found. */
+    [[nodiscard]] adt::u32 search(adt::u32 objI, adt::StringView svKey) const;
+
+    /* */
+
+private:
+    bool parseValue(adt::StringView svKey);
+    bool parseContainer(adt::u32 i, TOKEN_TYPE eClose);
+    bool expect(TOKEN_TYPE t);
+    void next() { m_token = m_lex.next(); }
+    void printEntry(adt::IAllocator* pAlloc, FILE* fp, adt::u32 i, adt::StringView svEnd, int depth, bool bPrintKey) const;
+};
+
+inline adt::u32
+Tape::firstChild(adt::u32 i) const
+{
+    ADT_ASSERT(m_pEntries[i].eTag == TAG::ARRAY || m_pEntries[i].eTag == TAG::OBJECT, "tag: {}", getTAGString(m_pEntries[i].eTag));
+    return i + 1;
+}
+
+template<typename CL>
+inline void
+Tape::forEachChild(adt::u32 i, CL cl) const
+{
+    const adt::u32 end = childrenEnd(i);
+    for (adt::u32 childI = firstChild(i); childI < end; childI = nextSibling(childI))
+        cl(childI);
+}
+
+inline adt::u32
+Tape::search(adt::u32 objI, adt::StringView svKey) const
+{
+    ADT_ASSERT(m_pEntries[objI].eTag == TAG::OBJECT, "tag: {}", getTAGString(m_pEntries[objI].eTag));
+
+    const adt::u32 end = childrenEnd(objI);
+    for (adt::u32 childI = objI + 1; childI < end; childI = nextSibling(childI))
+        if (m_pEntries[childI].svKey == svKey)
+            return childI;
+
+    return adt::NPOS32;
+}
+
+} /* namespace json */
@@ -45,6 +45,61 @@ main()
         defer( thrd2.join() );
     }
 
+    {
+        /* Ping-pong through futures, then a producer/consumer over an EventCount. */
+        constexpr int N = 10000;
+
+        Future<int> futPing {INIT};
+        Future<int> futPong {INIT};
+
+        auto clPong = [&] {
+            for (int i = 0; i < N; ++i)
+            {
+                const int x = futPing.waitData();
+                futPing.reset();
+                futPong.signalData(x + 1);
+            }
+        };
+        Thread thrdPong(clPong);
+
+        for (int i = 0; i < N; ++i)
+        {
+            futPing.signalData(i);
+            ADT_ASSERT_ALWAYS(futPong.waitData() == i + 1, "got: {}", futPong.data());
+            futPong.reset();
+        }
+        thrdPong.join();
+
+        EventCount ec {};
+        atomic::Int atomNProduced {};
+        int nConsumed = 0;
+
+        auto clConsume = [&] {
+            while (nConsumed < N)
+            {
+                const i32 key = ec.prepareWait();
+                if (atomNProduced.load(atomic::ORDER::ACQUIRE) > nConsumed)
+                {
+                    ec.cancelWait();
+                    ++nConsumed;
+                    continue;
+                }
+                ec.wait(key);
+            }
+        };
+        Thread thrdConsumer(clConsume);
+
+        for (int i = 0; i < N; ++i)
+        {
+            atomNProduced.fetchAdd(1, atomic::ORDER::RELEASE);
+            ec.notifyOne();
+        }
+        thrdConsumer.join();
+
+        ADT_ASSERT_ALWAYS(nConsumed == N, "nConsumed: {}", nConsumed);
+        LogDebug("Future/EventCount: ok\n");
+    }
+
     Thread thrd(what, Thread::ATTR::DETACHED);
     // auto err = thrd.detach();
     // LogDebug("err: {}\n", err);